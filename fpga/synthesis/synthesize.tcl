@@ -12,8 +12,17 @@ set RTL_FILES {
     "../rtl/mac_array/mac_array.v"
     "../rtl/scratchpad/scratchpad_sram.v"
     "../rtl/dma/dma_engine.v"
+    "../rtl/dma/axi_latency_monitor.v"
+    "../rtl/dma/store_coalescer.v"
+    "../rtl/dma/dma_mmu.v"
+    "../rtl/dma/axi_width_converter.v"
     "../rtl/interface/riscv_interface.v"
+    "../rtl/top/clock_crossing.v"
+    "../rtl/top/abft_checker.v"
+    "../rtl/top/softmax_unit.v"
     "../rtl/top/gemm_accelerator_top.v"
+    "../rtl/top/cluster_interconnect.v"
+    "../rtl/top/gemm_cluster.v"
 }
 
 # Testbench files
@@ -60,6 +69,16 @@ if {[string match "*vivado*" [file tail [info nameofexecutable]]]} {
     open_run impl_1
     report_utilization -file utilization_report.txt
     report_timing -file timing_report.txt
+    
+    # Activity-based power when simulation switching activity is provided
+    # (testbench: make power_activity); otherwise report_power is vectorless
+    if {[info exists env(GEMM_SAIF)] && [file exists $env(GEMM_SAIF)]} {
+        if {[info exists env(GEMM_SAIF_STRIP)]} {
+            read_saif -strip_path $env(GEMM_SAIF_STRIP) $env(GEMM_SAIF)
+        } else {
+            read_saif $env(GEMM_SAIF)
+        }
+    }
     report_power -file power_report.txt
     
 } elseif {[string match "*quartus*" [file tail [info nameofexecutable]]]} {
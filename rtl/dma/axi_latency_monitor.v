@@ -0,0 +1,188 @@
+// AXI Latency Monitor
+// Passive bus monitor measuring AR->first-R and AW->B latency per transaction
+// into log-scale histogram bins
+
+module axi_latency_monitor #(
+    parameter NUM_BINS = 16,           // Histogram bins per channel
+    parameter BIN_INDEX_WIDTH = 4,     // log2(NUM_BINS)
+    parameter LAT_WIDTH = 16,          // Latency counter width (cycles)
+    parameter COUNT_WIDTH = 32,        // Per-bin counter width
+    parameter MAX_OUTSTANDING = 4      // Outstanding transactions tracked per channel
+)(
+    input wire clk,
+    input wire rst_n,
+
+    // Configuration
+    input wire enable,
+    input wire clear,                  // Clear histograms and maxima
+    input wire [3:0] bin_shift,        // Bin k covers [2^(k-1), 2^k) << bin_shift cycles
+
+    // Read channel taps
+    input wire ar_valid,
+    input wire ar_ready,
+    input wire r_valid,
+    input wire r_ready,
+    input wire r_last,
+
+    // Write channel taps
+    input wire aw_valid,
+    input wire aw_ready,
+    input wire b_valid,
+    input wire b_ready,
+
+    // Histogram readback
+    input wire sel_channel,            // 0=read, 1=write
+    input wire [BIN_INDEX_WIDTH-1:0] sel_bin,
+    output wire [COUNT_WIDTH-1:0] sel_count,
+    output wire [LAT_WIDTH-1:0] sel_max_latency
+);
+
+    localparam PTR_WIDTH = (MAX_OUTSTANDING > 1) ? $clog2(MAX_OUTSTANDING) : 1;
+
+    // Free-running timestamp
+    reg [LAT_WIDTH-1:0] timestamp;
+
+    // Issue timestamp FIFOs (AXI returns responses in order for a single ID)
+    reg [LAT_WIDTH-1:0] rd_issue_ts [0:MAX_OUTSTANDING-1];
+    reg [LAT_WIDTH-1:0] wr_issue_ts [0:MAX_OUTSTANDING-1];
+    reg [PTR_WIDTH-1:0] rd_wr_ptr, rd_rd_ptr;
+    reg [PTR_WIDTH-1:0] wr_wr_ptr, wr_rd_ptr;
+    reg [PTR_WIDTH:0] rd_pending, wr_pending;
+    reg rd_in_burst;                   // First beat seen, waiting for RLAST
+
+    // Transactions accepted while the FIFO was full. They are not timed, and
+    // every later one joins them until they drain, so responses (in order)
+    // always pop the FIFO first and never take a younger timestamp
+    reg [LAT_WIDTH-1:0] rd_untracked, wr_untracked;
+
+    // Histograms
+    reg [COUNT_WIDTH-1:0] rd_hist [0:NUM_BINS-1];
+    reg [COUNT_WIDTH-1:0] wr_hist [0:NUM_BINS-1];
+    reg [LAT_WIDTH-1:0] rd_max_latency, wr_max_latency;
+
+    // Transaction events
+    wire ar_fire = ar_valid && ar_ready;
+    wire aw_fire = aw_valid && aw_ready;
+    wire ar_track = ar_fire && rd_untracked == 0 && rd_pending < MAX_OUTSTANDING;
+    wire aw_track = aw_fire && wr_untracked == 0 && wr_pending < MAX_OUTSTANDING;
+    wire r_head = r_valid && r_ready && !rd_in_burst;
+    wire r_first = r_head && (rd_pending != 0);
+    wire r_skip = r_head && (rd_pending == 0) && (rd_untracked != 0);
+    wire b_any = b_valid && b_ready;
+    wire b_fire = b_any && (wr_pending != 0);
+    wire b_skip = b_any && (wr_pending == 0) && (wr_untracked != 0);
+
+    wire [LAT_WIDTH-1:0] rd_latency = timestamp - rd_issue_ts[rd_rd_ptr];
+    wire [LAT_WIDTH-1:0] wr_latency = timestamp - wr_issue_ts[wr_rd_ptr];
+
+    // Log-scale bin index: 0 for zero, else MSB position + 1, clamped to last bin
+    function [BIN_INDEX_WIDTH-1:0] log_bin;
+        input [LAT_WIDTH-1:0] latency;
+        input [3:0] shift;
+        reg [LAT_WIDTH-1:0] scaled;
+        integer b;
+        integer msb;
+        begin
+            scaled = latency >> shift;
+            msb = 0;
+            for (b = 0; b < LAT_WIDTH; b = b + 1) begin
+                if (scaled[b]) msb = b + 1;
+            end
+            if (msb > NUM_BINS - 1) begin
+                log_bin = NUM_BINS - 1;
+            end else begin
+                log_bin = msb;
+            end
+        end
+    endfunction
+
+    wire [BIN_INDEX_WIDTH-1:0] rd_bin = log_bin(rd_latency, bin_shift);
+    wire [BIN_INDEX_WIDTH-1:0] wr_bin = log_bin(wr_latency, bin_shift);
+
+    // Outstanding transaction tracking
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            timestamp <= 0;
+            rd_wr_ptr <= 0;
+            rd_rd_ptr <= 0;
+            wr_wr_ptr <= 0;
+            wr_rd_ptr <= 0;
+            rd_pending <= 0;
+            wr_pending <= 0;
+            rd_in_burst <= 0;
+            rd_untracked <= 0;
+            wr_untracked <= 0;
+        end else begin
+            timestamp <= timestamp + 1;
+
+            // Read channel
+            if (ar_track) begin
+                rd_issue_ts[rd_wr_ptr] <= timestamp;
+                rd_wr_ptr <= rd_wr_ptr + 1;
+            end
+            if (r_first) begin
+                rd_rd_ptr <= rd_rd_ptr + 1;
+            end
+            if (r_valid && r_ready) begin
+                rd_in_burst <= !r_last;
+            end
+            rd_pending <= rd_pending + ar_track - r_first;
+            rd_untracked <= rd_untracked + (ar_fire && !ar_track) - r_skip;
+
+            // Write channel
+            if (aw_track) begin
+                wr_issue_ts[wr_wr_ptr] <= timestamp;
+                wr_wr_ptr <= wr_wr_ptr + 1;
+            end
+            if (b_fire) begin
+                wr_rd_ptr <= wr_rd_ptr + 1;
+            end
+            wr_pending <= wr_pending + aw_track - b_fire;
+            wr_untracked <= wr_untracked + (aw_fire && !aw_track) - b_skip;
+        end
+    end
+
+    // Histogram update
+    integer n;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            for (n = 0; n < NUM_BINS; n = n + 1) begin
+                rd_hist[n] <= 0;
+                wr_hist[n] <= 0;
+            end
+            rd_max_latency <= 0;
+            wr_max_latency <= 0;
+        end else if (clear) begin
+            for (n = 0; n < NUM_BINS; n = n + 1) begin
+                rd_hist[n] <= 0;
+                wr_hist[n] <= 0;
+            end
+            rd_max_latency <= 0;
+            wr_max_latency <= 0;
+        end else if (enable) begin
+            if (r_first) begin
+                // Saturate instead of wrapping on long runs
+                if (~&rd_hist[rd_bin]) begin
+                    rd_hist[rd_bin] <= rd_hist[rd_bin] + 1;
+                end
+                if (rd_latency > rd_max_latency) begin
+                    rd_max_latency <= rd_latency;
+                end
+            end
+
+            if (b_fire) begin
+                if (~&wr_hist[wr_bin]) begin
+                    wr_hist[wr_bin] <= wr_hist[wr_bin] + 1;
+                end
+                if (wr_latency > wr_max_latency) begin
+                    wr_max_latency <= wr_latency;
+                end
+            end
+        end
+    end
+
+    // Readback multiplexing
+    assign sel_count = sel_channel ? wr_hist[sel_bin] : rd_hist[sel_bin];
+    assign sel_max_latency = sel_channel ? wr_max_latency : rd_max_latency;
+
+endmodule
@@ -0,0 +1,200 @@
+// AXI Width Converter
+// Packs narrow memory read beats into full DMA lines and unpacks DMA write
+// lines into narrow beats, so the DMA can sit on a 64- or 128-bit port
+//
+// Each line burst of N beats becomes one narrow burst of N*RATIO beats at
+// the line-aligned address (RATIO = LINE_WIDTH/AXI_DATA_WIDTH); bursts are
+// never split, so MAX_BURST_LEN*RATIO must not exceed 256. The packer and
+// unpacker are double-registered so a narrow beat can move every cycle.
+
+module axi_width_converter #(
+    parameter LINE_WIDTH = 256,        // DMA/scratchpad line width
+    parameter AXI_DATA_WIDTH = 256,    // Memory port width (64, 128 or 256)
+    parameter ADDR_WIDTH = 32
+)(
+    input wire clk,
+    input wire rst_n,
+
+    // Line side (from the DMA/MMU)
+    input wire s_arvalid,
+    input wire [ADDR_WIDTH-1:0] s_araddr,
+    input wire [7:0] s_arlen,
+    input wire [2:0] s_arsize,
+    output wire s_arready,
+
+    input wire s_rready,
+    output wire s_rvalid,
+    output wire [LINE_WIDTH-1:0] s_rdata,
+    output wire s_rlast,
+
+    input wire s_awvalid,
+    input wire [ADDR_WIDTH-1:0] s_awaddr,
+    input wire [7:0] s_awlen,
+    input wire [2:0] s_awsize,
+    output wire s_awready,
+
+    input wire s_wvalid,
+    input wire [LINE_WIDTH-1:0] s_wdata,
+    input wire [LINE_WIDTH/8-1:0] s_wstrb,
+    input wire s_wlast,
+    output wire s_wready,
+
+    output wire s_bvalid,
+    input wire s_bready,
+
+    // Memory side
+    output wire m_arvalid,
+    output wire [ADDR_WIDTH-1:0] m_araddr,
+    output wire [7:0] m_arlen,
+    output wire [2:0] m_arsize,
+    input wire m_arready,
+
+    output wire m_rready,
+    input wire m_rvalid,
+    input wire [AXI_DATA_WIDTH-1:0] m_rdata,
+    input wire m_rlast,
+
+    output wire m_awvalid,
+    output wire [ADDR_WIDTH-1:0] m_awaddr,
+    output wire [7:0] m_awlen,
+    output wire [2:0] m_awsize,
+    input wire m_awready,
+
+    output wire m_wvalid,
+    output wire [AXI_DATA_WIDTH-1:0] m_wdata,
+    output wire [AXI_DATA_WIDTH/8-1:0] m_wstrb,
+    output wire m_wlast,
+    input wire m_wready,
+
+    input wire m_bvalid,
+    output wire m_bready
+);
+
+    localparam RATIO = LINE_WIDTH / AXI_DATA_WIDTH;
+    localparam BEAT_BYTES = AXI_DATA_WIDTH / 8;
+    localparam LINE_OFFSET = $clog2(LINE_WIDTH / 8);
+    localparam COUNT_BITS = (RATIO > 1) ? $clog2(RATIO) : 1;
+
+    // Write responses are per burst and need no conversion
+    assign s_bvalid = m_bvalid;
+    assign m_bready = s_bready;
+
+    generate
+        if (RATIO == 1) begin : gen_passthrough
+            assign m_arvalid = s_arvalid;
+            assign m_araddr = s_araddr;
+            assign m_arlen = s_arlen;
+            assign m_arsize = s_arsize;
+            assign s_arready = m_arready;
+            assign m_rready = s_rready;
+            assign s_rvalid = m_rvalid;
+            assign s_rdata = m_rdata;
+            assign s_rlast = m_rlast;
+            assign m_awvalid = s_awvalid;
+            assign m_awaddr = s_awaddr;
+            assign m_awlen = s_awlen;
+            assign m_awsize = s_awsize;
+            assign s_awready = m_awready;
+            assign m_wvalid = s_wvalid;
+            assign m_wdata = s_wdata;
+            assign m_wstrb = s_wstrb;
+            assign m_wlast = s_wlast;
+            assign s_wready = m_wready;
+        end else begin : gen_convert
+            // Address channels: same burst, RATIO times the beats
+            assign m_arvalid = s_arvalid;
+            assign m_araddr = {s_araddr[ADDR_WIDTH-1:LINE_OFFSET], {LINE_OFFSET{1'b0}}};
+            assign m_arlen = (s_arlen + 1) * RATIO - 1;
+            assign m_arsize = $clog2(BEAT_BYTES);
+            assign s_arready = m_arready;
+            
+            assign m_awvalid = s_awvalid;
+            assign m_awaddr = {s_awaddr[ADDR_WIDTH-1:LINE_OFFSET], {LINE_OFFSET{1'b0}}};
+            assign m_awlen = (s_awlen + 1) * RATIO - 1;
+            assign m_awsize = $clog2(BEAT_BYTES);
+            assign s_awready = m_awready;
+            
+            // Read packer: the first RATIO-1 beats of a line collect in r_acc,
+            // the last one completes r_line, which is held until the DMA takes it
+            reg [LINE_WIDTH-AXI_DATA_WIDTH-1:0] r_acc;
+            reg [COUNT_BITS-1:0] r_count;
+            reg [LINE_WIDTH-1:0] r_line;
+            reg r_line_valid;
+            reg r_line_last;
+            
+            wire r_last_beat = (r_count == RATIO - 1);
+            assign m_rready = !r_last_beat || !r_line_valid || s_rready;
+            
+            always @(posedge clk or negedge rst_n) begin
+                if (!rst_n) begin
+                    r_acc <= 0;
+                    r_count <= 0;
+                    r_line <= 0;
+                    r_line_valid <= 0;
+                    r_line_last <= 0;
+                end else begin
+                    if (r_line_valid && s_rready) begin
+                        r_line_valid <= 0;
+                    end
+                    if (m_rvalid && m_rready) begin
+                        if (r_last_beat) begin
+                            r_line <= {m_rdata, r_acc};
+                            r_line_valid <= 1;
+                            r_line_last <= m_rlast;
+                            r_count <= 0;
+                        end else begin
+                            r_acc[r_count*AXI_DATA_WIDTH +: AXI_DATA_WIDTH] <= m_rdata;
+                            r_count <= r_count + 1;
+                        end
+                    end
+                end
+            end
+            
+            assign s_rvalid = r_line_valid;
+            assign s_rdata = r_line;
+            assign s_rlast = r_line_last;
+            
+            // Write unpacker: a line is sent low beat first; the next line is
+            // accepted while the last beat of the current one goes out
+            reg [LINE_WIDTH-1:0] w_line;
+            reg [LINE_WIDTH/8-1:0] w_strb;
+            reg w_line_valid;
+            reg w_line_last;
+            reg [COUNT_BITS-1:0] w_count;
+            
+            wire w_last_beat = (w_count == RATIO - 1);
+            assign s_wready = !w_line_valid || (w_last_beat && m_wready);
+            
+            always @(posedge clk or negedge rst_n) begin
+                if (!rst_n) begin
+                    w_line <= 0;
+                    w_strb <= 0;
+                    w_line_valid <= 0;
+                    w_line_last <= 0;
+                    w_count <= 0;
+                end else begin
+                    if (m_wvalid && m_wready) begin
+                        if (w_last_beat) begin
+                            w_line_valid <= 0;
+                            w_count <= 0;
+                        end else begin
+                            w_count <= w_count + 1;
+                        end
+                    end
+                    if (s_wvalid && s_wready) begin
+                        w_line <= s_wdata;
+                        w_strb <= s_wstrb;
+                        w_line_last <= s_wlast;
+                        w_line_valid <= 1;
+                    end
+                end
+            end
+            
+            assign m_wvalid = w_line_valid;
+            assign m_wdata = w_line[w_count*AXI_DATA_WIDTH +: AXI_DATA_WIDTH];
+            assign m_wstrb = w_strb[w_count*BEAT_BYTES +: BEAT_BYTES];
+            assign m_wlast = w_line_last && w_last_beat;
+        end
+    endgenerate
+
+endmodule
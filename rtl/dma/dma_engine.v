@@ -15,8 +15,43 @@ module dma_engine #(
     input wire dma_dir,                // 0=mem_to_scratchpad, 1=scratchpad_to_mem
     input wire [ADDR_WIDTH-1:0] mem_addr,
     input wire [SCRATCHPAD_ADDR_WIDTH-1:0] scratchpad_addr,
-    input wire [15:0] transfer_len,    // Number of 256-bit words
-    input wire [15:0] stride,         // Stride for non-contiguous access
+    input wire [15:0] transfer_len,    // Number of 256-bit words (rows when row_bytes is set)
+    input wire [15:0] stride,         // Byte stride between rows (0=contiguous)
+    input wire [15:0] row_bytes,       // Bytes per row (0=full lines); stored rows may span lines
+    input wire [3:0] pad_top,          // Zero lines before the first loaded row
+    input wire [3:0] pad_bottom,       // Zero lines after the last loaded row
+    input wire [$clog2(DATA_WIDTH/8):0] pad_left, // Zero bytes before each loaded row
+    input wire [$clog2(DATA_WIDTH/8):0] pad_right, // Zero bytes after each loaded row
+    
+    // Indexed gather: loaded row m is row index[m] of the table at mem_addr
+    input wire gather_en,
+    input wire [ADDR_WIDTH-1:0] index_addr, // uint32 index array
+    input wire [31:0] table_rows,      // Indices at or above this load a zero row
+    
+    // Accumulating store: each stored line is added (as int32 lanes) to the
+    // line at the same offset from acc_scratchpad_addr. Gathered stores go
+    // to row index[m] and skip out-of-range rows.
+    input wire accumulate,
+    input wire [SCRATCHPAD_ADDR_WIDTH-1:0] acc_scratchpad_addr,
+    output reg gather_error,           // Out-of-range index seen in this transfer
+    
+    // Output stage on stored int32 lanes (see dma_output_stage): bias adds
+    // the acc_scratchpad_addr row to every row, requant narrows to int8 so
+    // each line stores LINE_BYTES/4 bytes and stride counts output bytes
+    input wire out_bias,
+    input wire out_relu,
+    input wire out_requant,
+    input wire [5:0] out_shift,
+    input wire [31:0] out_multiplier,
+    input wire [7:0] out_zero_point,
+    input wire [7:0] out_min,
+    input wire [7:0] out_max,
+    
+    // Bandwidth regulation (see dma_token_bucket)
+    input wire [15:0] bw_window,       // Refill period in cycles (0=unregulated)
+    input wire [15:0] bw_rd_bytes,     // Read bytes per window
+    input wire [15:0] bw_wr_bytes,     // Write bytes per window
+    input wire mcast,                  // Data reads of this transfer may be shared
     output reg dma_done,
     output reg dma_busy,
     
@@ -25,6 +60,7 @@ module dma_engine #(
     output reg [ADDR_WIDTH-1:0] mem_araddr,
     output reg [7:0] mem_arlen,
     output reg [2:0] mem_arsize,
+    output reg mem_armcast,            // AR sideband: read may be shared
     input wire mem_arready,
     
     output reg mem_rready,
@@ -32,19 +68,20 @@ module dma_engine #(
     input wire [DATA_WIDTH-1:0] mem_rdata,
     input wire mem_rlast,
     
-    output reg mem_awvalid,
-    output reg [ADDR_WIDTH-1:0] mem_awaddr,
-    output reg [7:0] mem_awlen,
-    output reg [2:0] mem_awsize,
+    output wire mem_awvalid,
+    output wire [ADDR_WIDTH-1:0] mem_awaddr,
+    output wire [7:0] mem_awlen,
+    output wire [2:0] mem_awsize,
     input wire mem_awready,
     
-    output reg mem_wvalid,
-    output reg [DATA_WIDTH-1:0] mem_wdata,
-    output reg mem_wlast,
+    output wire mem_wvalid,
+    output wire [DATA_WIDTH-1:0] mem_wdata,
+    output wire [DATA_WIDTH/8-1:0] mem_wstrb,
+    output wire mem_wlast,
     input wire mem_wready,
     
     input wire mem_bvalid,
-    output reg mem_bready,
+    output wire mem_bready,
     
     // Scratchpad interface
     output reg scratchpad_wr_en,
@@ -58,28 +95,205 @@ module dma_engine #(
     input wire scratchpad_rd_valid
 );
 
+    localparam LINE_BYTES = DATA_WIDTH/8;
+    
     // State machine
-    localparam IDLE = 3'b000;
-    localparam READ_REQ = 3'b001;
-    localparam READ_DATA = 3'b010;
-    localparam WRITE_REQ = 3'b011;
-    localparam WRITE_DATA = 3'b100;
-    localparam DONE = 3'b101;
+    localparam IDLE = 4'b0000;
+    localparam READ_REQ = 4'b0001;
+    localparam READ_DATA = 4'b0010;
+    localparam WRITE_REQ = 4'b0011;
+    localparam WRITE_DATA = 4'b0100;
+    localparam DONE = 4'b0101;
+    localparam WRITE_FLUSH = 4'b0110;
+    localparam READ_PAD = 4'b0111;
+    localparam READ_ROW = 4'b1000;
+    localparam ROW_START = 4'b1001;
+    localparam ROW_DONE = 4'b1010;
+    localparam INDEX_LOOKUP = 4'b1011;
+    localparam INDEX_REQ = 4'b1100;
+    localparam INDEX_DATA = 4'b1101;
     
     // Internal signals
-    reg [2:0] state;
+    reg [3:0] state;
     reg [15:0] transfer_count;
     reg [ADDR_WIDTH-1:0] current_mem_addr;
     reg [SCRATCHPAD_ADDR_WIDTH-1:0] current_scratchpad_addr;
     reg [7:0] burst_len;
     
+    // Store path: scratchpad lines become row segments for the coalescer
+    reg seg_valid;
+    reg [ADDR_WIDTH-1:0] seg_addr;
+    reg [DATA_WIDTH-1:0] seg_data;
+    reg wr_flush;
+    wire seg_ready;
+    wire wr_idle;
+    wire [$clog2(LINE_BYTES):0] seg_bytes;
+    wire [$clog2(LINE_BYTES):0] seg_line_bytes;
+    wire row_mode = (row_bytes != 0);
+    wire [ADDR_WIDTH-1:0] out_line_bytes = out_requant ? LINE_BYTES/4 : LINE_BYTES;
+    wire [ADDR_WIDTH-1:0] out_row_bytes = out_requant ? row_bytes/4 : row_bytes;
+    wire [ADDR_WIDTH-1:0] row_stride = (stride != 0) ? stride : ((row_bytes != 0) ? out_row_bytes : out_line_bytes);
+    
+    // A stored row occupies consecutive scratchpad lines; the last line of a
+    // row holds the remainder, then the next row starts at row_start + stride
+    reg [15:0] row_remaining;
+    reg [ADDR_WIDTH-1:0] row_start_addr;
+    assign seg_line_bytes = !row_mode ? LINE_BYTES :
+                            (row_remaining > LINE_BYTES) ? LINE_BYTES : row_remaining;
+    assign seg_bytes = out_requant ? seg_line_bytes / 4 : seg_line_bytes;
+    
+    // Load path row mode: each row is realigned from its source lines into
+    // row_lines scratchpad lines, behind pad_left zero bytes and followed by
+    // zeros. pad_top/pad_bottom rows are zero lines generated without reads.
+    // The row is treated as a virtual span starting pad_left bytes before its
+    // address; a first source line holding only padding is never fetched.
+    localparam OFFSET_BITS = $clog2(LINE_BYTES);
+    reg [15:0] pad_remaining;
+    reg zero_row;
+    reg [ADDR_WIDTH-1:0] row_src_addr;
+    reg [15:0] row_src_left;
+    reg [15:0] row_out_idx;
+    reg row_have_prev;
+    reg [DATA_WIDTH-1:0] row_prev;
+    reg [DATA_WIDTH-1:0] row_line;
+    wire [15:0] row_span = pad_left + row_bytes;
+    wire [15:0] row_lines = (row_span + pad_right + LINE_BYTES - 1) / LINE_BYTES;
+    wire [ADDR_WIDTH-1:0] row_virt_addr = current_mem_addr - pad_left;
+    wire [OFFSET_BITS-1:0] row_offset = row_virt_addr[OFFSET_BITS-1:0];
+    wire [15:0] row_src_lines = (row_offset + row_span + LINE_BYTES - 1) / LINE_BYTES;
+    wire row_first_pad = (row_virt_addr[ADDR_WIDTH-1:OFFSET_BITS] != current_mem_addr[ADDR_WIDTH-1:OFFSET_BITS]);
+    wire [DATA_WIDTH-1:0] row_next = (state == READ_ROW) ? {DATA_WIDTH{1'b0}} : mem_rdata;
+    wire [2*DATA_WIDTH-1:0] row_window = {row_next, row_prev} >> {row_offset, 3'b000};
+    
+    // Keep only the row bytes of this output line
+    integer i;
+    always @(*) begin
+        row_line = 0;
+        for (i = 0; i < LINE_BYTES; i = i + 1) begin
+            if (row_out_idx * LINE_BYTES + i >= pad_left && row_out_idx * LINE_BYTES + i < row_span) begin
+                row_line[8*i +: 8] = row_window[8*i +: 8];
+            end
+        end
+    end
+    
+    // Accumulating or biased store: result line held while the previous C
+    // line (or the bias line) is read
+    wire add_line = accumulate || out_bias;
+    reg acc_have;
+    reg [DATA_WIDTH-1:0] acc_line;
+    reg [SCRATCHPAD_ADDR_WIDTH-1:0] acc_rd_addr;
+    reg [DATA_WIDTH-1:0] acc_sum;
+    wire [15:0] store_row_lines = row_mode ? (row_bytes + LINE_BYTES - 1) / LINE_BYTES : 16'd1;
+    
+    integer j;
+    always @(*) begin
+        for (j = 0; j < DATA_WIDTH/32; j = j + 1) begin
+            acc_sum[32*j +: 32] = acc_line[32*j +: 32] + scratchpad_rd_data[32*j +: 32];
+        end
+    end
+    
+    wire [DATA_WIDTH-1:0] out_line;
+    
+    dma_output_stage #(
+        .DATA_WIDTH(DATA_WIDTH)
+    ) output_stage_inst (
+        .line_in(add_line ? acc_sum : scratchpad_rd_data),
+        .relu(out_relu),
+        .requant(out_requant),
+        .shift(out_shift),
+        .multiplier(out_multiplier),
+        .zero_point(out_zero_point),
+        .min_value(out_min),
+        .max_value(out_max),
+        .line_out(out_line)
+    );
+    
+    // Gather index fetch, with the last index line cached
+    reg index_valid;
+    reg [ADDR_WIDTH-1:0] index_line_addr;
+    reg [DATA_WIDTH-1:0] index_line;
+    wire [ADDR_WIDTH-1:0] index_elem_addr = index_addr + {transfer_count, 2'b00};
+    wire [ADDR_WIDTH-1:0] index_elem_line = {index_elem_addr[ADDR_WIDTH-1:OFFSET_BITS], {OFFSET_BITS{1'b0}}};
+    wire [31:0] index_value = index_line[32*index_elem_addr[OFFSET_BITS-1:2] +: 32];
+    
+    // Token buckets hold back new bursts once the window's budget is spent;
+    // allow is checked before ARVALID/AWVALID rises, which then holds until
+    // the address is accepted and the burst is charged
+    wire rd_allow, wr_allow;
+    
+    dma_token_bucket rd_bucket_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+        .window(bw_window),
+        .budget(bw_rd_bytes),
+        .charge(mem_arvalid && mem_arready),
+        .charge_bytes((mem_arlen + 16'd1) * LINE_BYTES),
+        .allow(rd_allow)
+    );
+    
+    dma_token_bucket wr_bucket_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+        .window(bw_window),
+        .budget(bw_wr_bytes),
+        .charge(mem_awvalid && mem_awready),
+        .charge_bytes((mem_awlen + 16'd1) * LINE_BYTES),
+        .allow(wr_allow)
+    );
+    
+    // Write-combining buffer owns the AXI write channel
+    store_coalescer #(
+        .DATA_WIDTH(DATA_WIDTH),
+        .ADDR_WIDTH(ADDR_WIDTH),
+        .BURST_LINES(MAX_BURST_LEN)
+    ) store_coalescer_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+        .seg_valid(seg_valid),
+        .seg_ready(seg_ready),
+        .seg_addr(seg_addr),
+        .seg_data(seg_data),
+        .seg_bytes(seg_bytes),
+        .flush(wr_flush),
+        .idle(wr_idle),
+        .issue_allow(wr_allow),
+        .mem_awvalid(mem_awvalid),
+        .mem_awaddr(mem_awaddr),
+        .mem_awlen(mem_awlen),
+        .mem_awsize(mem_awsize),
+        .mem_awready(mem_awready),
+        .mem_wvalid(mem_wvalid),
+        .mem_wdata(mem_wdata),
+        .mem_wstrb(mem_wstrb),
+        .mem_wlast(mem_wlast),
+        .mem_wready(mem_wready),
+        .mem_bvalid(mem_bvalid),
+        .mem_bready(mem_bready)
+    );
+    
+    // Lines left before the next 4KB boundary; bursts never cross a page so
+    // the address translation unit can map each burst with one lookup
+    wire [15:0] lines_to_page = (16'h1000 - current_mem_addr[11:0]) / LINE_BYTES;
+    wire [15:0] row_lines_to_page = (16'h1000 - row_src_addr[11:0]) / LINE_BYTES;
+    reg [7:0] row_burst_len;
+    
     // Burst length calculation
     always @(*) begin
-        if (transfer_len - transfer_count >= MAX_BURST_LEN) begin
+        if (transfer_len - transfer_count >= MAX_BURST_LEN && lines_to_page >= MAX_BURST_LEN) begin
             burst_len = MAX_BURST_LEN - 1; // AXI uses len-1
+        end else if (transfer_len - transfer_count > lines_to_page) begin
+            burst_len = lines_to_page - 1;
         end else begin
             burst_len = (transfer_len - transfer_count) - 1;
         end
+        
+        if (row_src_left >= MAX_BURST_LEN && row_lines_to_page >= MAX_BURST_LEN) begin
+            row_burst_len = MAX_BURST_LEN - 1;
+        end else if (row_src_left > row_lines_to_page) begin
+            row_burst_len = row_lines_to_page - 1;
+        end else begin
+            row_burst_len = row_src_left - 1;
+        end
     end
     
     // Main state machine
@@ -97,15 +311,32 @@ module dma_engine #(
             mem_araddr <= 0;
             mem_arlen <= 0;
             mem_arsize <= 3'b101; // 256-bit = 32 bytes
+            mem_armcast <= 0;
             mem_rready <= 0;
-            mem_awvalid <= 0;
-            mem_awaddr <= 0;
-            mem_awlen <= 0;
-            mem_awsize <= 3'b101;
-            mem_wvalid <= 0;
-            mem_wdata <= 0;
-            mem_wlast <= 0;
-            mem_bready <= 0;
+            
+            // Load row mode
+            pad_remaining <= 0;
+            zero_row <= 0;
+            row_src_addr <= 0;
+            row_src_left <= 0;
+            row_out_idx <= 0;
+            row_have_prev <= 0;
+            row_prev <= 0;
+            index_valid <= 0;
+            index_line_addr <= 0;
+            index_line <= 0;
+            gather_error <= 0;
+            
+            // Store path
+            row_remaining <= 0;
+            row_start_addr <= 0;
+            acc_have <= 0;
+            acc_line <= 0;
+            acc_rd_addr <= 0;
+            seg_valid <= 0;
+            seg_addr <= 0;
+            seg_data <= 0;
+            wr_flush <= 0;
             
             // Scratchpad interface
             scratchpad_wr_en <= 0;
@@ -114,6 +345,8 @@ module dma_engine #(
             scratchpad_rd_en <= 0;
             scratchpad_rd_addr <= 0;
         end else begin
+            scratchpad_wr_en <= 0;
+            
             case (state)
                 IDLE: begin
                     dma_done <= 0;
@@ -121,19 +354,43 @@ module dma_engine #(
                     transfer_count <= 0;
                     
                     if (dma_start) begin
-                        state <= dma_dir ? WRITE_REQ : READ_REQ;
+                        if (dma_dir) begin
+                            state <= gather_en ? INDEX_LOOKUP : WRITE_REQ;
+                        end else if (!row_mode) begin
+                            state <= READ_REQ;
+                        end else if (pad_top != 0) begin
+                            state <= READ_PAD;
+                        end else begin
+                            state <= gather_en ? INDEX_LOOKUP : ROW_START;
+                        end
+                        pad_remaining <= pad_top * row_lines;
+                        zero_row <= 0;
+                        index_valid <= 0;
+                        gather_error <= 0;
+                        row_remaining <= row_bytes;
+                        row_start_addr <= mem_addr;
                         current_mem_addr <= mem_addr;
                         current_scratchpad_addr <= scratchpad_addr;
+                        acc_have <= 0;
+                        acc_rd_addr <= acc_scratchpad_addr;
                         dma_busy <= 1;
                     end
                 end
                 
                 READ_REQ: begin
-                    mem_arvalid <= 1;
-                    mem_araddr <= current_mem_addr;
-                    mem_arlen <= burst_len;
+                    scratchpad_wr_en <= 0;
                     
-                    if (mem_arready) begin
+                    if (!mem_arvalid) begin
+                        mem_arvalid <= rd_allow;
+                        mem_armcast <= mcast;
+                        if (row_mode) begin
+                            mem_araddr <= row_src_addr;
+                            mem_arlen <= row_burst_len;
+                        end else begin
+                            mem_araddr <= current_mem_addr;
+                            mem_arlen <= burst_len;
+                        end
+                    end else if (mem_arready) begin
                         mem_arvalid <= 0;
                         state <= READ_DATA;
                         mem_rready <= 1;
@@ -141,68 +398,228 @@ module dma_engine #(
                 end
                 
                 READ_DATA: begin
-                    if (mem_rvalid && mem_rready) begin
+                    if (row_mode) begin
+                        if (mem_rvalid && mem_rready) begin
+                            // Each new source line completes the previous output line
+                            if (row_have_prev) begin
+                                scratchpad_wr_en <= 1;
+                                scratchpad_wr_addr <= current_scratchpad_addr;
+                                scratchpad_wr_data <= row_line;
+                                current_scratchpad_addr <= current_scratchpad_addr + 1;
+                                row_out_idx <= row_out_idx + 1;
+                            end
+                            row_prev <= mem_rdata;
+                            row_have_prev <= 1;
+                            row_src_addr <= row_src_addr + LINE_BYTES;
+                            row_src_left <= row_src_left - 1;
+                            
+                            if (row_src_left == 1) begin
+                                mem_rready <= 0;
+                                state <= (row_out_idx + row_have_prev < row_lines) ? READ_ROW : ROW_DONE;
+                            end else if (mem_rlast) begin
+                                mem_rready <= 0;
+                                state <= READ_REQ;
+                            end
+                        end
+                    end else if (mem_rvalid && mem_rready) begin
                         // Write to scratchpad
                         scratchpad_wr_en <= 1;
                         scratchpad_wr_addr <= current_scratchpad_addr;
                         scratchpad_wr_data <= mem_rdata;
                         
                         // Update addresses
-                        current_mem_addr <= current_mem_addr + 32; // 256-bit = 32 bytes
+                        current_mem_addr <= current_mem_addr + LINE_BYTES;
                         current_scratchpad_addr <= current_scratchpad_addr + 1;
                         transfer_count <= transfer_count + 1;
                         
-                        if (mem_rlast || transfer_count == transfer_len - 1) begin
+                        if (transfer_count == transfer_len - 1) begin
                             mem_rready <= 0;
-                            scratchpad_wr_en <= 0;
                             state <= DONE;
+                        end else if (mem_rlast) begin
+                            // Next burst
+                            mem_rready <= 0;
+                            state <= READ_REQ;
                         end
+                    end else begin
+                        scratchpad_wr_en <= 0;
                     end
                 end
                 
-                WRITE_REQ: begin
-                    mem_awvalid <= 1;
-                    mem_awaddr <= current_mem_addr;
-                    mem_awlen <= burst_len;
+                ROW_START: begin
+                    // Source lines of the row at current_mem_addr
+                    row_src_addr <= {row_virt_addr[ADDR_WIDTH-1:OFFSET_BITS], {OFFSET_BITS{1'b0}}} +
+                                    (row_first_pad ? LINE_BYTES : 0);
+                    row_src_left <= row_first_pad ? row_src_lines - 1 : row_src_lines;
+                    row_prev <= 0;
+                    row_have_prev <= row_first_pad;
+                    row_out_idx <= 0;
+                    state <= READ_REQ;
+                end
+                
+                READ_ROW: begin
+                    // Output lines past the last source line
+                    scratchpad_wr_en <= 1;
+                    scratchpad_wr_addr <= current_scratchpad_addr;
+                    scratchpad_wr_data <= row_line;
+                    current_scratchpad_addr <= current_scratchpad_addr + 1;
+                    row_out_idx <= row_out_idx + 1;
+                    row_prev <= 0;
                     
-                    if (mem_awready) begin
-                        mem_awvalid <= 0;
-                        state <= WRITE_DATA;
-                        mem_wvalid <= 1;
-                        mem_bready <= 1;
+                    if (row_out_idx + 1 == row_lines) begin
+                        state <= ROW_DONE;
                     end
                 end
                 
+                ROW_DONE: begin
+                    if (!gather_en) begin
+                        current_mem_addr <= current_mem_addr + row_stride;
+                    end
+                    transfer_count <= transfer_count + 1;
+                    
+                    if (transfer_count == transfer_len - 1) begin
+                        pad_remaining <= pad_bottom * row_lines;
+                        state <= (pad_bottom != 0) ? READ_PAD : DONE;
+                    end else begin
+                        state <= gather_en ? INDEX_LOOKUP : ROW_START;
+                    end
+                end
+                
+                READ_PAD: begin
+                    // Zero line of a border row or an out-of-range gather row
+                    scratchpad_wr_en <= 1;
+                    scratchpad_wr_addr <= current_scratchpad_addr;
+                    scratchpad_wr_data <= 0;
+                    current_scratchpad_addr <= current_scratchpad_addr + 1;
+                    pad_remaining <= pad_remaining - 1;
+                    
+                    if (pad_remaining == 1) begin
+                        if (zero_row) begin
+                            zero_row <= 0;
+                            state <= ROW_DONE;
+                        end else if (transfer_count == transfer_len) begin
+                            state <= DONE;
+                        end else begin
+                            state <= gather_en ? INDEX_LOOKUP : ROW_START;
+                        end
+                    end
+                end
+                
+                INDEX_LOOKUP: begin
+                    if (!index_valid || index_line_addr != index_elem_line) begin
+                        state <= INDEX_REQ;
+                    end else if (dma_dir) begin
+                        // Scattered store: out-of-range rows are not written
+                        if (index_value >= table_rows) begin
+                            gather_error <= 1;
+                            current_scratchpad_addr <= current_scratchpad_addr + store_row_lines;
+                            acc_rd_addr <= acc_rd_addr + store_row_lines;
+                            transfer_count <= transfer_count + 1;
+                            state <= (transfer_count == transfer_len - 1) ? WRITE_FLUSH : INDEX_LOOKUP;
+                        end else begin
+                            row_start_addr <= mem_addr + index_value * row_stride;
+                            current_mem_addr <= mem_addr + index_value * row_stride;
+                            state <= WRITE_REQ;
+                        end
+                    end else if (index_value >= table_rows) begin
+                        gather_error <= 1;
+                        zero_row <= 1;
+                        pad_remaining <= row_lines;
+                        state <= READ_PAD;
+                    end else begin
+                        current_mem_addr <= mem_addr + index_value * row_stride;
+                        state <= ROW_START;
+                    end
+                end
+                
+                INDEX_REQ: begin
+                    if (!mem_arvalid) begin
+                        mem_arvalid <= rd_allow;
+                        mem_armcast <= 0;
+                        mem_araddr <= index_elem_line;
+                        mem_arlen <= 0;
+                    end else if (mem_arready) begin
+                        mem_arvalid <= 0;
+                        mem_rready <= 1;
+                        state <= INDEX_DATA;
+                    end
+                end
+                
+                INDEX_DATA: begin
+                    if (mem_rvalid && mem_rready) begin
+                        mem_rready <= 0;
+                        index_line <= mem_rdata;
+                        index_line_addr <= index_elem_line;
+                        index_valid <= 1;
+                        state <= INDEX_LOOKUP;
+                    end
+                end
+                
+                WRITE_REQ: begin
+                    // Fetch next row from scratchpad
+                    scratchpad_rd_en <= 1;
+                    scratchpad_rd_addr <= current_scratchpad_addr;
+                    state <= WRITE_DATA;
+                end
+                
                 WRITE_DATA: begin
-                    if (mem_wready) begin
-                        // Read from scratchpad
-                        scratchpad_rd_en <= 1;
-                        scratchpad_rd_addr <= current_scratchpad_addr;
-                        mem_wdata <= scratchpad_rd_data;
-                        
-                        // Update addresses
-                        current_mem_addr <= current_mem_addr + 32;
-                        current_scratchpad_addr <= current_scratchpad_addr + 1;
-                        transfer_count <= transfer_count + 1;
-                        
-                        if (transfer_count == transfer_len - 1) begin
-                            mem_wlast <= 1;
+                    scratchpad_rd_en <= 0;
+                    
+                    if (scratchpad_rd_valid && !seg_valid) begin
+                        if (add_line && !acc_have) begin
+                            // Result line in hand; fetch the previous C or bias line
+                            acc_have <= 1;
+                            acc_line <= scratchpad_rd_data;
+                            scratchpad_rd_en <= 1;
+                            scratchpad_rd_addr <= acc_rd_addr;
+                        end else begin
+                            acc_have <= 0;
+                            seg_valid <= 1;
+                            seg_addr <= current_mem_addr;
+                            seg_data <= out_line;
                         end
+                    end
+                    
+                    if (seg_valid && seg_ready) begin
+                        seg_valid <= 0;
+                        current_scratchpad_addr <= current_scratchpad_addr + 1;
+                        acc_rd_addr <= acc_rd_addr + 1;
                         
-                        if (mem_wlast) begin
-                            mem_wvalid <= 0;
-                            mem_wlast <= 0;
-                            scratchpad_rd_en <= 0;
+                        if (row_mode && row_remaining > LINE_BYTES) begin
+                            // More lines in this row
+                            row_remaining <= row_remaining - LINE_BYTES;
+                            current_mem_addr <= current_mem_addr + out_line_bytes;
+                            state <= WRITE_REQ;
+                        end else begin
+                            // Next row; the bias row restarts
+                            row_remaining <= row_bytes;
+                            if (out_bias) begin
+                                acc_rd_addr <= acc_scratchpad_addr;
+                            end
+                            row_start_addr <= row_start_addr + row_stride;
+                            current_mem_addr <= row_start_addr + row_stride;
+                            transfer_count <= transfer_count + 1;
                             
-                            if (mem_bvalid) begin
-                                mem_bready <= 0;
-                                state <= DONE;
+                            if (transfer_count == transfer_len - 1) begin
+                                state <= WRITE_FLUSH;
+                            end else begin
+                                state <= gather_en ? INDEX_LOOKUP : WRITE_REQ;
                             end
                         end
                     end
                 end
                 
+                WRITE_FLUSH: begin
+                    // Drain partially filled bursts and wait for write responses
+                    if (!wr_flush) begin
+                        wr_flush <= 1;
+                    end else if (wr_idle) begin
+                        wr_flush <= 0;
+                        state <= DONE;
+                    end
+                end
+                
                 DONE: begin
+                    scratchpad_wr_en <= 0;
                     dma_done <= 1;
                     dma_busy <= 0;
                     state <= IDLE;
@@ -213,6 +630,117 @@ module dma_engine #(
 
 endmodule
 
+// Token bucket bandwidth regulator
+// Refills budget bytes every window cycles and holds at most one window's
+// worth. A burst may start while the balance is positive and is charged in
+// full, so bursts larger than the budget still pass and the debt is paid
+// off by later refills. With window == 0 bursts are not charged and the
+// balance sits at budget; a new window or budget restarts it from a full
+// window, so no debt carries over from an earlier class.
+module dma_token_bucket (
+    input wire clk,
+    input wire rst_n,
+    input wire [15:0] window,          // Refill period in cycles
+    input wire [15:0] budget,          // Bytes added per refill
+    input wire charge,                 // Burst accepted this cycle
+    input wire [15:0] charge_bytes,
+    output wire allow
+);
+
+    reg [15:0] timer;
+    reg signed [17:0] tokens;
+    reg [15:0] last_window, last_budget;
+    
+    wire reload = (window == 0) || (window != last_window) || (budget != last_budget);
+    wire refill = (timer == 0);
+    wire signed [17:0] budget_s = {2'b00, budget};
+    wire signed [17:0] refilled = !refill ? tokens :
+                                  (tokens > 0) ? budget_s : tokens + budget_s;
+    
+    assign allow = (window == 0) || (tokens > 0);
+    
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            timer <= 0;
+            tokens <= 0;
+            last_window <= 0;
+            last_budget <= 0;
+        end else begin
+            last_window <= window;
+            last_budget <= budget;
+            // Reload also when the window is shortened below the count
+            if (window == 0) begin
+                timer <= 0;
+            end else if (reload || timer == 0 || timer >= window) begin
+                timer <= window - 16'd1;
+            end else begin
+                timer <= timer - 16'd1;
+            end
+            if (reload) begin
+                tokens <= budget_s;
+            end else begin
+                tokens <= refilled - (charge ? $signed({2'b00, charge_bytes}) : 18'sd0);
+            end
+        end
+    end
+
+endmodule
+
+// DMA output stage
+// Elementwise epilogue on a stored line of int32 lanes, after any bias or
+// accumulate add: optional ReLU, then optional requantization
+//   y = clamp(((x * multiplier + round) >>> shift) + zero_point, min, max)
+// with round = 2^(shift-1) (0 for shift 0), packed as int8 in the low
+// DATA_WIDTH/32 bytes. Without requant the lanes pass through as int32.
+module dma_output_stage #(
+    parameter DATA_WIDTH = 256
+)(
+    input wire [DATA_WIDTH-1:0] line_in,
+    input wire relu,
+    input wire requant,
+    input wire [5:0] shift,
+    input wire [31:0] multiplier,
+    input wire [7:0] zero_point,
+    input wire [7:0] min_value,
+    input wire [7:0] max_value,
+    output reg [DATA_WIDTH-1:0] line_out
+);
+
+    localparam LANES = DATA_WIDTH / 32;
+    
+    reg signed [31:0] x;
+    reg signed [63:0] scaled;
+    reg signed [63:0] y;
+    
+    integer i;
+    always @(*) begin
+        line_out = 0;
+        for (i = 0; i < LANES; i = i + 1) begin
+            x = line_in[32*i +: 32];
+            if (relu && x < 0) begin
+                x = 0;
+            end
+            scaled = x * $signed(multiplier);
+            if (shift != 0) begin
+                scaled = scaled + (64'sd1 <<< (shift - 1));
+            end
+            y = (scaled >>> shift) + $signed(zero_point);
+            if (y < $signed(min_value)) begin
+                y = $signed(min_value);
+            end
+            if (y > $signed(max_value)) begin
+                y = $signed(max_value);
+            end
+            if (requant) begin
+                line_out[8*i +: 8] = y[7:0];
+            end else begin
+                line_out[32*i +: 32] = x;
+            end
+        end
+    end
+
+endmodule
+
 // DMA Controller - manages multiple DMA operations
 module dma_controller #(
     parameter NUM_CHANNELS = 4,
@@ -238,6 +766,7 @@ module dma_controller #(
     output reg [ADDR_WIDTH-1:0] mem_araddr,
     output reg [7:0] mem_arlen,
     output reg [2:0] mem_arsize,
+    output reg mem_armcast,            // AR sideband: read may be shared
     input wire mem_arready,
     
     output reg mem_rready,
@@ -253,6 +782,7 @@ module dma_controller #(
     
     output reg mem_wvalid,
     output reg [DATA_WIDTH-1:0] mem_wdata,
+    output wire [DATA_WIDTH/8-1:0] mem_wstrb,
     output reg mem_wlast,
     input wire mem_wready,
     
@@ -310,12 +840,36 @@ module dma_controller #(
         .scratchpad_addr(selected_scratchpad_addr),
         .transfer_len(selected_transfer_len),
         .stride(selected_stride),
+        .row_bytes(0), // Channels move full lines
+        .pad_top(4'd0),
+        .pad_bottom(4'd0),
+        .pad_left(0),
+        .pad_right(0),
+        .gather_en(1'b0),
+        .index_addr(0),
+        .table_rows(0),
+        .accumulate(1'b0),
+        .acc_scratchpad_addr({SCRATCHPAD_ADDR_WIDTH{1'b0}}),
+        .out_bias(1'b0),
+        .out_relu(1'b0),
+        .out_requant(1'b0),
+        .out_shift(6'd0),
+        .out_multiplier(32'd0),
+        .out_zero_point(8'd0),
+        .out_min(8'd0),
+        .out_max(8'd0),
+        .gather_error(),
+        .bw_window(16'd0), // Unregulated
+        .bw_rd_bytes(16'd0),
+        .bw_wr_bytes(16'd0),
+        .mcast(1'b0),
         .dma_done(channel_done[active_channel]),
         .dma_busy(channel_busy[active_channel]),
         .mem_arvalid(mem_arvalid),
         .mem_araddr(mem_araddr),
         .mem_arlen(mem_arlen),
         .mem_arsize(mem_arsize),
+        .mem_armcast(),
         .mem_arready(mem_arready),
         .mem_rready(mem_rready),
         .mem_rvalid(mem_rvalid),
@@ -328,6 +882,7 @@ module dma_controller #(
         .mem_awready(mem_awready),
         .mem_wvalid(mem_wvalid),
         .mem_wdata(mem_wdata),
+        .mem_wstrb(mem_wstrb),
         .mem_wlast(mem_wlast),
         .mem_wready(mem_wready),
         .mem_bvalid(mem_bvalid),
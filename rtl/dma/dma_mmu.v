@@ -0,0 +1,356 @@
+// DMA Address Translation Unit (IOMMU-lite)
+// Translates DMA AXI addresses through a small TLB backed by a hardware
+// walker over a driver-maintained two-level page table (4KB pages)
+//
+// Page table format (32-bit PTEs, Sv32-like):
+//   L1 entry at PTBR + VA[31:22]*4: [31:12]=L0 table page, [0]=valid
+//   L0 entry at L1[31:12] + VA[21:12]*4: [31:12]=physical page, [1]=writable, [0]=valid
+
+module dma_mmu #(
+    parameter DATA_WIDTH = 256,
+    parameter ADDR_WIDTH = 32,
+    parameter TLB_ENTRIES = 8
+)(
+    input wire clk,
+    input wire rst_n,
+
+    // Configuration
+    input wire enable,                 // 0=bypass (physical addresses)
+    input wire tlb_flush,
+    input wire fault_clear,
+    input wire [ADDR_WIDTH-1:0] ptbr,  // L1 table base (4KB aligned)
+    output reg fault,                  // Sticky translation fault
+    output reg [ADDR_WIDTH-1:0] fault_addr,
+
+    // DMA side (virtual addresses)
+    input wire s_arvalid,
+    input wire [ADDR_WIDTH-1:0] s_araddr,
+    input wire [7:0] s_arlen,
+    input wire [2:0] s_arsize,
+    input wire s_armcast,
+    output wire s_arready,
+
+    input wire s_rready,
+    output wire s_rvalid,
+    output wire [DATA_WIDTH-1:0] s_rdata,
+    output wire s_rlast,
+
+    input wire s_awvalid,
+    input wire [ADDR_WIDTH-1:0] s_awaddr,
+    input wire [7:0] s_awlen,
+    input wire [2:0] s_awsize,
+    output wire s_awready,
+
+    input wire s_wvalid,
+    input wire [DATA_WIDTH-1:0] s_wdata,
+    input wire [DATA_WIDTH/8-1:0] s_wstrb,
+    input wire s_wlast,
+    output wire s_wready,
+
+    output wire s_bvalid,
+    input wire s_bready,
+
+    // Memory side (physical addresses)
+    output reg m_arvalid,
+    output reg [ADDR_WIDTH-1:0] m_araddr,
+    output reg [7:0] m_arlen,
+    output reg [2:0] m_arsize,
+    output reg m_armcast,              // DMA reads keep their flag; walks are unicast
+    input wire m_arready,
+
+    output wire m_rready,
+    input wire m_rvalid,
+    input wire [DATA_WIDTH-1:0] m_rdata,
+    input wire m_rlast,
+
+    output reg m_awvalid,
+    output reg [ADDR_WIDTH-1:0] m_awaddr,
+    output reg [7:0] m_awlen,
+    output reg [2:0] m_awsize,
+    input wire m_awready,
+
+    output wire m_wvalid,
+    output wire [DATA_WIDTH/8-1:0] m_wstrb,
+    output wire [DATA_WIDTH-1:0] m_wdata,
+    output wire m_wlast,
+    input wire m_wready,
+
+    input wire m_bvalid,
+    output wire m_bready
+);
+
+    localparam PAGE_BITS = 12;
+    localparam VPN_WIDTH = ADDR_WIDTH - PAGE_BITS;
+    localparam TLB_IDX_WIDTH = (TLB_ENTRIES > 1) ? $clog2(TLB_ENTRIES) : 1;
+    localparam LINE_OFFSET = $clog2(DATA_WIDTH/8);
+
+    // PTE bits
+    localparam PTE_VALID = 0;
+    localparam PTE_WRITABLE = 1;
+
+    // State machine
+    localparam IDLE = 3'b000;
+    localparam WALK_L1 = 3'b001;
+    localparam WALK_L0 = 3'b010;
+    localparam WALK_RESP = 3'b011;
+    localparam FORWARD = 3'b100;
+    localparam FAULT_READ = 3'b101;
+    localparam FAULT_WRITE = 3'b110;
+    localparam FAULT_RESP = 3'b111;
+
+    reg [2:0] state;
+
+    // Captured request
+    reg req_write;
+    reg [ADDR_WIDTH-1:0] req_addr;
+    reg [7:0] req_len;
+    reg [2:0] req_size;
+    reg walk_level;                    // 1=L1 lookup, 0=L0 lookup
+    reg [ADDR_WIDTH-1:0] pte_addr;
+    reg [7:0] fault_beat;
+    reg fault_ack;                     // Completes the faulted address handshake
+
+    // TLB (fully associative, round-robin replacement)
+    reg tlb_valid [0:TLB_ENTRIES-1];
+    reg [VPN_WIDTH-1:0] tlb_vpn [0:TLB_ENTRIES-1];
+    reg [VPN_WIDTH-1:0] tlb_ppn [0:TLB_ENTRIES-1];
+    reg tlb_writable [0:TLB_ENTRIES-1];
+    reg [TLB_IDX_WIDTH-1:0] tlb_next;
+
+    // Reads forwarded but not yet completed; the walker only uses the
+    // read channel once it is quiet
+    reg [3:0] rd_outstanding;
+
+    // Incoming request selection (reads first)
+    wire req_pending = s_arvalid || s_awvalid;
+    wire sel_write = !s_arvalid;
+    wire [ADDR_WIDTH-1:0] sel_addr = sel_write ? s_awaddr : s_araddr;
+    wire [VPN_WIDTH-1:0] sel_vpn = sel_addr[ADDR_WIDTH-1:PAGE_BITS];
+
+    // TLB lookup
+    reg tlb_hit;
+    reg [VPN_WIDTH-1:0] tlb_hit_ppn;
+    reg tlb_hit_writable;
+    integer t;
+    always @(*) begin
+        tlb_hit = 0;
+        tlb_hit_ppn = 0;
+        tlb_hit_writable = 0;
+        for (t = 0; t < TLB_ENTRIES; t = t + 1) begin
+            if (tlb_valid[t] && tlb_vpn[t] == sel_vpn) begin
+                tlb_hit = 1;
+                tlb_hit_ppn = tlb_ppn[t];
+                tlb_hit_writable = tlb_writable[t];
+            end
+        end
+    end
+
+    // PTE extraction from the returned line
+    wire [ADDR_WIDTH-1:0] l1_pte_addr = ptbr + {req_addr[ADDR_WIDTH-1:22], 2'b00};
+    wire [31:0] walk_pte = m_rdata[pte_addr[LINE_OFFSET-1:2]*32 +: 32];
+    wire walking = (state == WALK_L1) || (state == WALK_L0) || (state == WALK_RESP);
+
+    // Read data channel: walker, fault responder, or pass-through
+    assign m_rready = walking ? 1'b1 : s_rready;
+    assign s_rvalid = (state == FAULT_READ) ? 1'b1 : (!walking && m_rvalid);
+    assign s_rdata = (state == FAULT_READ) ? {DATA_WIDTH{1'b0}} : m_rdata;
+    assign s_rlast = (state == FAULT_READ) ? (fault_beat == req_len) : m_rlast;
+
+    // Write data/response channels: faulted bursts are drained locally
+    assign m_wvalid = s_wvalid && (state != FAULT_WRITE);
+    assign m_wdata = s_wdata;
+    assign m_wstrb = s_wstrb;
+    assign m_wlast = s_wlast;
+    assign s_wready = (state == FAULT_WRITE) ? 1'b1 : m_wready;
+    assign s_bvalid = (state == FAULT_RESP) ? 1'b1 : m_bvalid;
+    assign m_bready = s_bready;
+
+    // Address handshakes complete when the translated request is accepted
+    assign s_arready = ((state == FORWARD) && m_arready || fault_ack) && !req_write;
+    assign s_awready = ((state == FORWARD) && m_awready || fault_ack) && req_write;
+
+    integer n;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            state <= IDLE;
+            req_write <= 0;
+            req_addr <= 0;
+            req_len <= 0;
+            req_size <= 0;
+            walk_level <= 0;
+            pte_addr <= 0;
+            fault_beat <= 0;
+            fault_ack <= 0;
+            fault <= 0;
+            fault_addr <= 0;
+            tlb_next <= 0;
+            rd_outstanding <= 0;
+            m_arvalid <= 0;
+            m_araddr <= 0;
+            m_arlen <= 0;
+            m_arsize <= 0;
+            m_armcast <= 0;
+            m_awvalid <= 0;
+            m_awaddr <= 0;
+            m_awlen <= 0;
+            m_awsize <= 0;
+            for (n = 0; n < TLB_ENTRIES; n = n + 1) begin
+                tlb_valid[n] <= 0;
+            end
+        end else begin
+            fault_ack <= 0;
+            
+            if (fault_clear) begin
+                fault <= 0;
+            end
+
+            if (tlb_flush) begin
+                for (n = 0; n < TLB_ENTRIES; n = n + 1) begin
+                    tlb_valid[n] <= 0;
+                end
+            end
+
+            // Track DMA reads in flight
+            if (state == FORWARD && !req_write && m_arready) begin
+                if (!(m_rvalid && m_rready && m_rlast)) rd_outstanding <= rd_outstanding + 1;
+            end else if (!walking && m_rvalid && m_rready && m_rlast) begin
+                rd_outstanding <= rd_outstanding - 1;
+            end
+
+            case (state)
+                IDLE: begin
+                    if (req_pending) begin
+                        req_write <= sel_write;
+                        req_addr <= sel_addr;
+                        req_len <= sel_write ? s_awlen : s_arlen;
+                        req_size <= sel_write ? s_awsize : s_arsize;
+
+                        if (!enable) begin
+                            // Bypass: forward untranslated
+                            state <= FORWARD;
+                            if (sel_write) begin
+                                m_awvalid <= 1;
+                                m_awaddr <= sel_addr;
+                                m_awlen <= s_awlen;
+                                m_awsize <= s_awsize;
+                            end else begin
+                                m_arvalid <= 1;
+                                m_araddr <= sel_addr;
+                                m_arlen <= s_arlen;
+                                m_arsize <= s_arsize;
+                                m_armcast <= s_armcast;
+                            end
+                        end else if (tlb_hit && !(sel_write && !tlb_hit_writable)) begin
+                            state <= FORWARD;
+                            if (sel_write) begin
+                                m_awvalid <= 1;
+                                m_awaddr <= {tlb_hit_ppn, sel_addr[PAGE_BITS-1:0]};
+                                m_awlen <= s_awlen;
+                                m_awsize <= s_awsize;
+                            end else begin
+                                m_arvalid <= 1;
+                                m_araddr <= {tlb_hit_ppn, sel_addr[PAGE_BITS-1:0]};
+                                m_arlen <= s_arlen;
+                                m_arsize <= s_arsize;
+                                m_armcast <= s_armcast;
+                            end
+                        end else if (tlb_hit) begin
+                            // Write to a read-only page
+                            fault <= 1;
+                            fault_addr <= sel_addr;
+                            fault_beat <= 0;
+                            fault_ack <= 1;
+                            state <= FAULT_WRITE;
+                        end else if (rd_outstanding == 0) begin
+                            walk_level <= 1;
+                            state <= WALK_L1;
+                        end
+                    end
+                end
+
+                WALK_L1: begin
+                    // Fetch the line holding the L1 entry
+                    pte_addr <= l1_pte_addr;
+                    m_arvalid <= 1;
+                    m_araddr <= {l1_pte_addr[ADDR_WIDTH-1:LINE_OFFSET], {LINE_OFFSET{1'b0}}};
+                    m_arlen <= 0;
+                    m_arsize <= LINE_OFFSET;
+                    m_armcast <= 0;
+                    state <= WALK_RESP;
+                end
+
+                WALK_L0: begin
+                    m_arvalid <= 1;
+                    m_araddr <= {pte_addr[ADDR_WIDTH-1:LINE_OFFSET], {LINE_OFFSET{1'b0}}};
+                    m_arlen <= 0;
+                    m_arsize <= LINE_OFFSET;
+                    m_armcast <= 0;
+                    state <= WALK_RESP;
+                end
+
+                WALK_RESP: begin
+                    if (m_arvalid && m_arready) begin
+                        m_arvalid <= 0;
+                    end
+
+                    if (m_rvalid) begin
+                        if (!walk_pte[PTE_VALID] ||
+                            (!walk_level && req_write && !walk_pte[PTE_WRITABLE])) begin
+                            fault <= 1;
+                            fault_addr <= req_addr;
+                            fault_beat <= 0;
+                            fault_ack <= 1;
+                            state <= req_write ? FAULT_WRITE : FAULT_READ;
+                        end else if (walk_level) begin
+                            walk_level <= 0;
+                            pte_addr <= {walk_pte[31:PAGE_BITS], req_addr[21:PAGE_BITS], 2'b00};
+                            state <= WALK_L0;
+                        end else begin
+                            // Refill and replay the request from IDLE
+                            tlb_valid[tlb_next] <= 1;
+                            tlb_vpn[tlb_next] <= req_addr[ADDR_WIDTH-1:PAGE_BITS];
+                            tlb_ppn[tlb_next] <= walk_pte[31:PAGE_BITS];
+                            tlb_writable[tlb_next] <= walk_pte[PTE_WRITABLE];
+                            tlb_next <= tlb_next + 1;
+                            state <= IDLE;
+                        end
+                    end
+                end
+
+                FORWARD: begin
+                    if (req_write && m_awready) begin
+                        m_awvalid <= 0;
+                        state <= IDLE;
+                    end else if (!req_write && m_arready) begin
+                        m_arvalid <= 0;
+                        state <= IDLE;
+                    end
+                end
+
+                FAULT_READ: begin
+                    // Return zero beats so the DMA engine completes the burst
+                    if (s_rready) begin
+                        fault_beat <= fault_beat + 1;
+                        if (fault_beat == req_len) begin
+                            state <= IDLE;
+                        end
+                    end
+                end
+
+                FAULT_WRITE: begin
+                    // Swallow the burst and answer with a local response
+                    if (s_wvalid && s_wlast) begin
+                        state <= FAULT_RESP;
+                    end
+                end
+
+                FAULT_RESP: begin
+                    if (s_bready) begin
+                        state <= IDLE;
+                    end
+                end
+            endcase
+        end
+    end
+
+endmodule
@@ -0,0 +1,217 @@
+// Store Coalescing Buffer
+// Write-combining buffer in front of the AXI write channel. Gathers row
+// segments destined for contiguous addresses into aligned bursts of full
+// lines, using byte strobes only for genuinely partial lines.
+
+module store_coalescer #(
+    parameter DATA_WIDTH = 256,        // 256-bit line width
+    parameter ADDR_WIDTH = 32,         // 32-bit address space
+    parameter BURST_LINES = 16         // Lines per aligned burst window (power of 2)
+)(
+    input wire clk,
+    input wire rst_n,
+
+    // Row segment input
+    input wire seg_valid,
+    output wire seg_ready,
+    input wire [ADDR_WIDTH-1:0] seg_addr,              // Byte address of first byte
+    input wire [DATA_WIDTH-1:0] seg_data,              // Segment bytes, LSB-aligned
+    input wire [$clog2(DATA_WIDTH/8):0] seg_bytes,     // 1..DATA_WIDTH/8
+
+    // Flush control
+    input wire flush,                  // Drain buffered lines
+    output wire idle,                  // Nothing buffered or in flight
+    input wire issue_allow,            // Bandwidth budget left for the next burst
+
+    // Memory write interface (AXI4-like)
+    output reg mem_awvalid,
+    output reg [ADDR_WIDTH-1:0] mem_awaddr,
+    output reg [7:0] mem_awlen,
+    output wire [2:0] mem_awsize,
+    input wire mem_awready,
+
+    output reg mem_wvalid,
+    output wire [DATA_WIDTH-1:0] mem_wdata,
+    output wire [DATA_WIDTH/8-1:0] mem_wstrb,
+    output wire mem_wlast,
+    input wire mem_wready,
+
+    input wire mem_bvalid,
+    output reg mem_bready
+);
+
+    localparam STRB_WIDTH = DATA_WIDTH/8;
+    localparam OFFSET_WIDTH = $clog2(STRB_WIDTH);
+    localparam LINE_ADDR_WIDTH = ADDR_WIDTH - OFFSET_WIDTH;
+    localparam IDX_WIDTH = $clog2(BURST_LINES);
+    localparam TAG_WIDTH = LINE_ADDR_WIDTH - IDX_WIDTH;
+
+    // State machine
+    localparam ACCEPT = 2'b00;
+    localparam BURST_REQ = 2'b01;
+    localparam BURST_DATA = 2'b10;
+    localparam BURST_RESP = 2'b11;
+
+    reg [1:0] state;
+
+    // Burst window: BURST_LINES aligned lines with per-byte valid strobes
+    reg [DATA_WIDTH-1:0] line_data [0:BURST_LINES-1];
+    reg [STRB_WIDTH-1:0] line_strb [0:BURST_LINES-1];
+    reg window_valid;
+    reg [TAG_WIDTH-1:0] window_tag;
+
+    // Upper part of a segment that spilled past the window
+    reg pend_valid;
+    reg [LINE_ADDR_WIDTH-1:0] pend_line;
+    reg [DATA_WIDTH-1:0] pend_data;
+    reg [STRB_WIDTH-1:0] pend_strb;
+
+    // Burst issue
+    reg [IDX_WIDTH-1:0] beat_idx;
+    reg [IDX_WIDTH-1:0] last_idx;
+
+    // Segment alignment into a two-line window
+    wire [OFFSET_WIDTH-1:0] seg_offset = seg_addr[OFFSET_WIDTH-1:0];
+    wire [LINE_ADDR_WIDTH-1:0] seg_line = seg_addr[ADDR_WIDTH-1:OFFSET_WIDTH];
+    wire [LINE_ADDR_WIDTH-1:0] seg_next_line = seg_line + 1;
+    wire [2*DATA_WIDTH-1:0] seg_shifted = {{DATA_WIDTH{1'b0}}, seg_data} << {seg_offset, 3'b000};
+    wire [2*STRB_WIDTH-1:0] seg_mask =
+        ({{STRB_WIDTH{1'b0}}, {STRB_WIDTH{1'b1}}} >> (STRB_WIDTH - seg_bytes)) << seg_offset;
+    wire seg_spans = |seg_mask[2*STRB_WIDTH-1:STRB_WIDTH];
+
+    wire [TAG_WIDTH-1:0] seg_tag = seg_line[LINE_ADDR_WIDTH-1:IDX_WIDTH];
+    wire [IDX_WIDTH-1:0] seg_idx = seg_line[IDX_WIDTH-1:0];
+    wire seg_hits = !window_valid || (seg_tag == window_tag);
+    wire seg_spills = seg_spans && (&seg_idx);   // Upper part lands in the next window
+
+    // Occupied line range and full-window detection
+    reg [IDX_WIDTH-1:0] first_used, last_used;
+    reg window_full;
+    integer i;
+    always @(*) begin
+        first_used = 0;
+        last_used = 0;
+        window_full = window_valid;
+        for (i = BURST_LINES-1; i >= 0; i = i - 1) begin
+            if (|line_strb[i]) first_used = i;
+        end
+        for (i = 0; i < BURST_LINES; i = i + 1) begin
+            if (|line_strb[i]) last_used = i;
+            if (~&line_strb[i]) window_full = 0;
+        end
+    end
+
+    // A pending flush waits for budget before AWVALID rises; seg_ready stays
+    // low meanwhile, so the window is not disturbed
+    wire start_flush = (state == ACCEPT) && window_valid && issue_allow &&
+                       (pend_valid || window_full || flush || (seg_valid && !seg_hits));
+
+    assign seg_ready = (state == ACCEPT) && !pend_valid && !window_full && !flush && seg_hits;
+    assign idle = (state == ACCEPT) && !window_valid && !pend_valid;
+
+    assign mem_awsize = OFFSET_WIDTH;
+    assign mem_wdata = line_data[beat_idx];
+    assign mem_wstrb = line_strb[beat_idx];
+    assign mem_wlast = (beat_idx == last_idx);
+
+    integer b, n;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            state <= ACCEPT;
+            window_valid <= 0;
+            window_tag <= 0;
+            pend_valid <= 0;
+            pend_line <= 0;
+            pend_data <= 0;
+            pend_strb <= 0;
+            beat_idx <= 0;
+            last_idx <= 0;
+            mem_awvalid <= 0;
+            mem_awaddr <= 0;
+            mem_awlen <= 0;
+            mem_wvalid <= 0;
+            mem_bready <= 0;
+            for (n = 0; n < BURST_LINES; n = n + 1) begin
+                line_strb[n] <= 0;
+            end
+        end else begin
+            case (state)
+                ACCEPT: begin
+                    if (start_flush) begin
+                        // Burst covers the occupied range; holes carry zero strobes
+                        mem_awvalid <= 1;
+                        mem_awaddr <= {window_tag, first_used, {OFFSET_WIDTH{1'b0}}};
+                        mem_awlen <= last_used - first_used;
+                        beat_idx <= first_used;
+                        last_idx <= last_used;
+                        state <= BURST_REQ;
+                    end else if (seg_valid && seg_ready) begin
+                        // Merge lower part into its line
+                        for (b = 0; b < STRB_WIDTH; b = b + 1) begin
+                            if (seg_mask[b]) begin
+                                line_data[seg_idx][8*b +: 8] <= seg_shifted[8*b +: 8];
+                            end
+                        end
+                        line_strb[seg_idx] <= line_strb[seg_idx] | seg_mask[STRB_WIDTH-1:0];
+                        window_valid <= 1;
+                        window_tag <= seg_tag;
+
+                        // Upper part goes to the next line, or waits for the next window
+                        if (seg_spans && !seg_spills) begin
+                            for (b = 0; b < STRB_WIDTH; b = b + 1) begin
+                                if (seg_mask[STRB_WIDTH + b]) begin
+                                    line_data[seg_idx + 1][8*b +: 8] <= seg_shifted[DATA_WIDTH + 8*b +: 8];
+                                end
+                            end
+                            line_strb[seg_idx + 1] <= line_strb[seg_idx + 1] | seg_mask[2*STRB_WIDTH-1:STRB_WIDTH];
+                        end else if (seg_spills) begin
+                            pend_valid <= 1;
+                            pend_line <= seg_next_line;
+                            pend_data <= seg_shifted[2*DATA_WIDTH-1:DATA_WIDTH];
+                            pend_strb <= seg_mask[2*STRB_WIDTH-1:STRB_WIDTH];
+                        end
+                    end else if (pend_valid && !window_valid) begin
+                        // Window drained - open the next one with the spilled part
+                        line_data[pend_line[IDX_WIDTH-1:0]] <= pend_data;
+                        line_strb[pend_line[IDX_WIDTH-1:0]] <= pend_strb;
+                        window_valid <= 1;
+                        window_tag <= pend_line[LINE_ADDR_WIDTH-1:IDX_WIDTH];
+                        pend_valid <= 0;
+                    end
+                end
+
+                BURST_REQ: begin
+                    if (mem_awready) begin
+                        mem_awvalid <= 0;
+                        mem_wvalid <= 1;
+                        state <= BURST_DATA;
+                    end
+                end
+
+                BURST_DATA: begin
+                    if (mem_wready) begin
+                        if (mem_wlast) begin
+                            mem_wvalid <= 0;
+                            mem_bready <= 1;
+                            state <= BURST_RESP;
+                        end else begin
+                            beat_idx <= beat_idx + 1;
+                        end
+                    end
+                end
+
+                BURST_RESP: begin
+                    if (mem_bvalid) begin
+                        mem_bready <= 0;
+                        window_valid <= 0;
+                        for (n = 0; n < BURST_LINES; n = n + 1) begin
+                            line_strb[n] <= 0;
+                        end
+                        state <= ACCEPT;
+                    end
+                end
+            endcase
+        end
+    end
+
+endmodule
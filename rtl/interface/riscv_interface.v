@@ -39,9 +39,74 @@ module riscv_interface #(
     output reg [15:0] k_dim,
     output reg [15:0] n_dim,
     output reg [7:0] data_type,
+    output wire [3:0] weight_bits,
     output reg [15:0] stride_a,
     output reg [15:0] stride_b,
     output reg [15:0] stride_c,
+    output wire [3:0] pad_top,
+    output wire [3:0] pad_bottom,
+    output wire [3:0] pad_left,
+    output wire [3:0] pad_right,
+    output wire gather_en,
+    output wire [31:0] gather_index_addr,
+    output wire [31:0] gather_table_rows,
+    input wire gather_error,
+    
+    // Output checksums and per-job error code
+    output wire abft_en,
+    input wire abft_checked,
+    input wire abft_error,
+    input wire [3:0] job_error_code,
+    
+    // Accumulate into C (C += A*B)
+    output wire accum_en,
+    
+    // Fused attention: softmax(A*B) * V
+    output wire attn_en,
+    output wire [3:0] attn_shift,
+    output wire [15:0] attn_seq_len,
+    output wire [31:0] attn_v_addr,
+    output wire [15:0] attn_v_stride,
+    output reg softmax_lut_wr,
+    output reg [7:0] softmax_lut_index,
+    output reg [7:0] softmax_lut_data,
+    
+    // Output stage applied as C is stored
+    output wire out_bias_en,
+    output wire out_relu_en,
+    output wire out_requant_en,
+    output wire [5:0] out_shift,
+    output wire [7:0] out_zero_point,
+    output wire [31:0] out_bias_addr,
+    output wire [31:0] out_multiplier,
+    output wire [7:0] out_min,
+    output wire [7:0] out_max,
+    
+    // AXI latency monitor
+    output wire lat_mon_enable,
+    output reg lat_mon_clear,
+    output wire [3:0] lat_mon_bin_shift,
+    output wire lat_mon_sel_channel,
+    output wire [3:0] lat_mon_sel_bin,
+    input wire [31:0] lat_mon_sel_count,
+    input wire [15:0] lat_mon_sel_max_latency,
+    
+    // DMA address translation
+    output wire mmu_enable,
+    output reg mmu_tlb_flush,
+    output reg mmu_fault_clear,
+    output wire [31:0] mmu_ptbr,
+    input wire mmu_fault,
+    input wire [31:0] mmu_fault_addr,
+    
+    // Cluster weight multicast
+    output wire mcast_en,
+    
+    // DMA bandwidth regulation and AXI QoS
+    output wire [15:0] bw_window,
+    output wire [15:0] bw_rd_bytes,
+    output wire [15:0] bw_wr_bytes,
+    output wire [3:0] axi_qos,
     
     // Interrupt output
     output reg irq_out
@@ -60,6 +125,31 @@ module riscv_interface #(
     localparam REG_STRIDE_A = 8'h24;
     localparam REG_STRIDE_B = 8'h28;
     localparam REG_STRIDE_C = 8'h2C;
+    localparam REG_LAT_CTRL = 8'h30;
+    localparam REG_LAT_SEL = 8'h34;
+    localparam REG_LAT_BIN = 8'h38;
+    localparam REG_LAT_MAX = 8'h3C;
+    localparam REG_MMU_CTRL = 8'h40;
+    localparam REG_MMU_PTBR = 8'h44;
+    localparam REG_MMU_FAULT_ADDR = 8'h48;
+    localparam REG_PAD = 8'h4C;
+    localparam REG_GATHER_CTRL = 8'h50;
+    localparam REG_GATHER_INDEX_ADDR = 8'h54;
+    localparam REG_GATHER_NUM_ROWS = 8'h58;
+    localparam REG_MCAST_CTRL = 8'h5C;
+    localparam REG_BW_CTRL = 8'h60;
+    localparam REG_BW_BUDGET = 8'h64;
+    localparam REG_ABFT_CTRL = 8'h68;
+    localparam REG_ERROR_CODE = 8'h6C;
+    localparam REG_ACCUM_CTRL = 8'h70;
+    localparam REG_ATTN_CTRL = 8'h74;
+    localparam REG_ATTN_V_ADDR = 8'h78;
+    localparam REG_ATTN_V_STRIDE = 8'h7C;
+    localparam REG_SOFTMAX_LUT = 8'h80;
+    localparam REG_OUTPUT_CTRL = 8'h84;
+    localparam REG_OUTPUT_BIAS_ADDR = 8'h88;
+    localparam REG_OUTPUT_MULT = 8'h8C;
+    localparam REG_OUTPUT_CLAMP = 8'h90;
     
     // Control register bits
     localparam CTRL_START = 0;
@@ -70,6 +160,18 @@ module riscv_interface #(
     localparam STATUS_BUSY = 0;
     localparam STATUS_DONE = 1;
     localparam STATUS_ERROR = 2;
+    localparam STATUS_MMU_FAULT = 3;
+    localparam STATUS_INDEX_ERROR = 4;
+    localparam STATUS_ABFT_ERROR = 5;
+    
+    // Latency monitor control bits
+    localparam LAT_CTRL_ENABLE = 0;
+    localparam LAT_CTRL_CLEAR = 1;
+    
+    // MMU control bits
+    localparam MMU_CTRL_ENABLE = 0;
+    localparam MMU_CTRL_TLB_FLUSH = 1;
+    localparam MMU_CTRL_FAULT_CLEAR = 2;
     
     // Internal registers
     reg [31:0] ctrl_reg;
@@ -81,9 +183,30 @@ module riscv_interface #(
     reg [15:0] k_dim_reg;
     reg [15:0] n_dim_reg;
     reg [7:0] data_type_reg;
+    reg [3:0] weight_bits_reg;         // 0 = full precision, 2-8 = bit-serial B
     reg [15:0] stride_a_reg;
     reg [15:0] stride_b_reg;
     reg [15:0] stride_c_reg;
+    reg [15:0] pad_reg;                // [3:0]=top, [7:4]=bottom, [11:8]=left, [15:12]=right
+    reg gather_en_reg;
+    reg [31:0] gather_index_addr_reg;
+    reg [31:0] gather_table_rows_reg;
+    reg [7:0] lat_ctrl_reg;            // [0]=enable, [7:4]=bin_shift
+    reg [8:0] lat_sel_reg;             // [3:0]=bin, [8]=channel
+    reg mmu_enable_reg;
+    reg [31:0] mmu_ptbr_reg;
+    reg mcast_en_reg;                  // Share matrix B reads with other cores
+    reg [19:0] bw_ctrl_reg;            // [15:0]=window cycles, [19:16]=AXI QoS
+    reg [31:0] bw_budget_reg;          // [15:0]=read bytes, [31:16]=write bytes per window
+    reg abft_en_reg;                   // Verify C against A/B checksums
+    reg accum_en_reg;                  // Add the result to the existing C
+    reg [31:0] attn_ctrl_reg;          // [0]=enable, [7:4]=score shift, [31:16]=sequence length
+    reg [31:0] attn_v_addr_reg;
+    reg [15:0] attn_v_stride_reg;
+    reg [23:0] out_ctrl_reg;           // [0]=bias, [1]=relu, [2]=requant, [13:8]=shift, [23:16]=zero point
+    reg [31:0] out_bias_addr_reg;
+    reg [31:0] out_mult_reg;
+    reg [15:0] out_clamp_reg;          // [7:0]=min, [15:8]=max (int8)
     
     // Custom instruction detection
     wire is_matmul_inst;
@@ -133,12 +256,44 @@ module riscv_interface #(
             k_dim_reg <= 0;
             n_dim_reg <= 0;
             data_type_reg <= 0;
+            weight_bits_reg <= 0;
             stride_a_reg <= 0;
             stride_b_reg <= 0;
             stride_c_reg <= 0;
+            pad_reg <= 0;
+            gather_en_reg <= 0;
+            gather_index_addr_reg <= 0;
+            gather_table_rows_reg <= 0;
+            lat_ctrl_reg <= 0;
+            lat_sel_reg <= 0;
+            lat_mon_clear <= 0;
+            mmu_enable_reg <= 0;
+            mmu_ptbr_reg <= 0;
+            mcast_en_reg <= 0;
+            bw_ctrl_reg <= 0;
+            bw_budget_reg <= 0;
+            abft_en_reg <= 0;
+            accum_en_reg <= 0;
+            attn_ctrl_reg <= 0;
+            attn_v_addr_reg <= 0;
+            attn_v_stride_reg <= 0;
+            out_ctrl_reg <= 0;
+            out_bias_addr_reg <= 0;
+            out_mult_reg <= 0;
+            out_clamp_reg <= 0;
+            softmax_lut_wr <= 0;
+            softmax_lut_index <= 0;
+            softmax_lut_data <= 0;
+            mmu_tlb_flush <= 0;
+            mmu_fault_clear <= 0;
             reg_rd_data <= 0;
             reg_rd_valid <= 0;
         end else begin
+            lat_mon_clear <= 0;
+            mmu_tlb_flush <= 0;
+            mmu_fault_clear <= 0;
+            softmax_lut_wr <= 0;
+            
             // Write operations
             if (reg_wr_en) begin
                 case (reg_addr)
@@ -155,10 +310,46 @@ module riscv_interface #(
                     REG_M_DIM: m_dim_reg <= reg_wr_data[15:0];
                     REG_K_DIM: k_dim_reg <= reg_wr_data[15:0];
                     REG_N_DIM: n_dim_reg <= reg_wr_data[15:0];
-                    REG_DATA_TYPE: data_type_reg <= reg_wr_data[7:0];
+                    REG_DATA_TYPE: begin
+                        data_type_reg <= reg_wr_data[7:0];
+                        weight_bits_reg <= reg_wr_data[11:8];
+                    end
                     REG_STRIDE_A: stride_a_reg <= reg_wr_data[15:0];
                     REG_STRIDE_B: stride_b_reg <= reg_wr_data[15:0];
                     REG_STRIDE_C: stride_c_reg <= reg_wr_data[15:0];
+                    REG_PAD: pad_reg <= reg_wr_data[15:0];
+                    REG_GATHER_CTRL: gather_en_reg <= reg_wr_data[0];
+                    REG_GATHER_INDEX_ADDR: gather_index_addr_reg <= {reg_wr_data[31:2], 2'b00};
+                    REG_GATHER_NUM_ROWS: gather_table_rows_reg <= reg_wr_data;
+                    REG_LAT_CTRL: begin
+                        lat_ctrl_reg <= {reg_wr_data[7:4], 3'b000, reg_wr_data[LAT_CTRL_ENABLE]};
+                        lat_mon_clear <= reg_wr_data[LAT_CTRL_CLEAR]; // Self-clearing
+                    end
+                    REG_LAT_SEL: lat_sel_reg <= {reg_wr_data[8], reg_wr_data[3:0]};
+                    REG_MMU_CTRL: begin
+                        mmu_enable_reg <= reg_wr_data[MMU_CTRL_ENABLE];
+                        mmu_tlb_flush <= reg_wr_data[MMU_CTRL_TLB_FLUSH];     // Self-clearing
+                        mmu_fault_clear <= reg_wr_data[MMU_CTRL_FAULT_CLEAR]; // Self-clearing
+                    end
+                    REG_MMU_PTBR: mmu_ptbr_reg <= {reg_wr_data[31:12], 12'h000};
+                    REG_MCAST_CTRL: mcast_en_reg <= reg_wr_data[0];
+                    REG_BW_CTRL: bw_ctrl_reg <= reg_wr_data[19:0];
+                    REG_BW_BUDGET: bw_budget_reg <= reg_wr_data;
+                    REG_ABFT_CTRL: abft_en_reg <= reg_wr_data[0];
+                    REG_ACCUM_CTRL: accum_en_reg <= reg_wr_data[0];
+                    REG_ATTN_CTRL: attn_ctrl_reg <= {reg_wr_data[31:16], 8'h0, reg_wr_data[7:4], 3'b000, reg_wr_data[0]};
+                    REG_ATTN_V_ADDR: attn_v_addr_reg <= reg_wr_data;
+                    REG_ATTN_V_STRIDE: attn_v_stride_reg <= reg_wr_data[15:0];
+                    REG_SOFTMAX_LUT: begin
+                        // [7:0]=entry, [15:8]=value; write-only
+                        softmax_lut_wr <= 1;
+                        softmax_lut_index <= reg_wr_data[7:0];
+                        softmax_lut_data <= reg_wr_data[15:8];
+                    end
+                    REG_OUTPUT_CTRL: out_ctrl_reg <= {reg_wr_data[23:16], 2'b00, reg_wr_data[13:8], 5'h0, reg_wr_data[2:0]};
+                    REG_OUTPUT_BIAS_ADDR: out_bias_addr_reg <= reg_wr_data;
+                    REG_OUTPUT_MULT: out_mult_reg <= reg_wr_data;
+                    REG_OUTPUT_CLAMP: out_clamp_reg <= reg_wr_data[15:0];
                 endcase
             end
             
@@ -174,10 +365,34 @@ module riscv_interface #(
                     REG_M_DIM: reg_rd_data <= {16'h0, m_dim_reg};
                     REG_K_DIM: reg_rd_data <= {16'h0, k_dim_reg};
                     REG_N_DIM: reg_rd_data <= {16'h0, n_dim_reg};
-                    REG_DATA_TYPE: reg_rd_data <= {24'h0, data_type_reg};
+                    REG_DATA_TYPE: reg_rd_data <= {20'h0, weight_bits_reg, data_type_reg};
                     REG_STRIDE_A: reg_rd_data <= {16'h0, stride_a_reg};
                     REG_STRIDE_B: reg_rd_data <= {16'h0, stride_b_reg};
                     REG_STRIDE_C: reg_rd_data <= {16'h0, stride_c_reg};
+                    REG_LAT_CTRL: reg_rd_data <= {24'h0, lat_ctrl_reg};
+                    REG_LAT_SEL: reg_rd_data <= {23'h0, lat_sel_reg};
+                    REG_LAT_BIN: reg_rd_data <= lat_mon_sel_count;
+                    REG_LAT_MAX: reg_rd_data <= {16'h0, lat_mon_sel_max_latency};
+                    REG_MMU_CTRL: reg_rd_data <= {31'h0, mmu_enable_reg};
+                    REG_MMU_PTBR: reg_rd_data <= mmu_ptbr_reg;
+                    REG_MMU_FAULT_ADDR: reg_rd_data <= mmu_fault_addr;
+                    REG_PAD: reg_rd_data <= {16'h0, pad_reg};
+                    REG_GATHER_CTRL: reg_rd_data <= {31'h0, gather_en_reg};
+                    REG_GATHER_INDEX_ADDR: reg_rd_data <= gather_index_addr_reg;
+                    REG_GATHER_NUM_ROWS: reg_rd_data <= gather_table_rows_reg;
+                    REG_MCAST_CTRL: reg_rd_data <= {31'h0, mcast_en_reg};
+                    REG_BW_CTRL: reg_rd_data <= {12'h0, bw_ctrl_reg};
+                    REG_BW_BUDGET: reg_rd_data <= bw_budget_reg;
+                    REG_ABFT_CTRL: reg_rd_data <= {31'h0, abft_en_reg};
+                    REG_ERROR_CODE: reg_rd_data <= {23'h0, abft_checked, 4'h0, job_error_code};
+                    REG_ACCUM_CTRL: reg_rd_data <= {31'h0, accum_en_reg};
+                    REG_ATTN_CTRL: reg_rd_data <= attn_ctrl_reg;
+                    REG_ATTN_V_ADDR: reg_rd_data <= attn_v_addr_reg;
+                    REG_ATTN_V_STRIDE: reg_rd_data <= {16'h0, attn_v_stride_reg};
+                    REG_OUTPUT_CTRL: reg_rd_data <= {8'h0, out_ctrl_reg};
+                    REG_OUTPUT_BIAS_ADDR: reg_rd_data <= out_bias_addr_reg;
+                    REG_OUTPUT_MULT: reg_rd_data <= out_mult_reg;
+                    REG_OUTPUT_CLAMP: reg_rd_data <= {16'h0, out_clamp_reg};
                     default: reg_rd_data <= 32'h0;
                 endcase
             end else begin
@@ -188,7 +403,7 @@ module riscv_interface #(
     
     // Status register update
     always @(*) begin
-        status_reg = {29'h0, accel_error, accel_done, accel_busy};
+        status_reg = {26'h0, abft_error, gather_error, mmu_fault, accel_error, accel_done, accel_busy};
     end
     
     // Output assignments
@@ -199,10 +414,45 @@ module riscv_interface #(
     assign k_dim = k_dim_reg;
     assign n_dim = n_dim_reg;
     assign data_type = data_type_reg;
+    assign weight_bits = weight_bits_reg;
     assign stride_a = stride_a_reg;
     assign stride_b = stride_b_reg;
     assign stride_c = stride_c_reg;
+    assign pad_top = pad_reg[3:0];
+    assign pad_bottom = pad_reg[7:4];
+    assign pad_left = pad_reg[11:8];
+    assign pad_right = pad_reg[15:12];
+    assign gather_en = gather_en_reg;
+    assign gather_index_addr = gather_index_addr_reg;
+    assign gather_table_rows = gather_table_rows_reg;
     assign accel_irq_en = ctrl_reg[CTRL_IRQ_EN];
+    assign lat_mon_enable = lat_ctrl_reg[LAT_CTRL_ENABLE];
+    assign lat_mon_bin_shift = lat_ctrl_reg[7:4];
+    assign lat_mon_sel_bin = lat_sel_reg[3:0];
+    assign lat_mon_sel_channel = lat_sel_reg[8];
+    assign mmu_enable = mmu_enable_reg;
+    assign mmu_ptbr = mmu_ptbr_reg;
+    assign mcast_en = mcast_en_reg;
+    assign bw_window = bw_ctrl_reg[15:0];
+    assign axi_qos = bw_ctrl_reg[19:16];
+    assign bw_rd_bytes = bw_budget_reg[15:0];
+    assign bw_wr_bytes = bw_budget_reg[31:16];
+    assign abft_en = abft_en_reg;
+    assign accum_en = accum_en_reg;
+    assign attn_en = attn_ctrl_reg[0];
+    assign attn_shift = attn_ctrl_reg[7:4];
+    assign attn_seq_len = attn_ctrl_reg[31:16];
+    assign attn_v_addr = attn_v_addr_reg;
+    assign attn_v_stride = attn_v_stride_reg;
+    assign out_bias_en = out_ctrl_reg[0];
+    assign out_relu_en = out_ctrl_reg[1];
+    assign out_requant_en = out_ctrl_reg[2];
+    assign out_shift = out_ctrl_reg[13:8];
+    assign out_zero_point = out_ctrl_reg[23:16];
+    assign out_bias_addr = out_bias_addr_reg;
+    assign out_multiplier = out_mult_reg;
+    assign out_min = out_clamp_reg[7:0];
+    assign out_max = out_clamp_reg[15:8];
     
     // Interrupt generation
     always @(posedge clk or negedge rst_n) begin
@@ -244,9 +494,11 @@ module config_loader #(
     output reg [15:0] k_dim,
     output reg [15:0] n_dim,
     output reg [7:0] data_type,
+    output reg [3:0] weight_bits,
     output reg [15:0] stride_a,
     output reg [15:0] stride_b,
     output reg [15:0] stride_c,
+    output reg [15:0] pad,
     output reg config_valid
 );
 
@@ -263,9 +515,9 @@ module config_loader #(
     // Word 1: matrix_b_addr  
     // Word 2: matrix_c_addr
     // Word 3: m_dim, k_dim
-    // Word 4: n_dim, data_type
+    // Word 4: n_dim, data_type, weight_bits (per-layer B precision)
     // Word 5: stride_a, stride_b
-    // Word 6: stride_c, reserved
+    // Word 6: stride_c, pad (top/bottom/left/right nibbles)
     // Word 7: reserved
     
     always @(posedge clk or negedge rst_n) begin
@@ -282,9 +534,11 @@ module config_loader #(
             k_dim <= 0;
             n_dim <= 0;
             data_type <= 0;
+            weight_bits <= 0;
             stride_a <= 0;
             stride_b <= 0;
             stride_c <= 0;
+            pad <= 0;
         end else begin
             case (state)
                 IDLE: begin
@@ -311,12 +565,16 @@ module config_loader #(
                             3'd4: begin
                                 n_dim <= mem_rd_data[15:0];
                                 data_type <= mem_rd_data[23:16];
+                                weight_bits <= mem_rd_data[27:24];
                             end
                             3'd5: begin
                                 stride_a <= mem_rd_data[15:0];
                                 stride_b <= mem_rd_data[31:16];
                             end
-                            3'd6: stride_c <= mem_rd_data[15:0];
+                            3'd6: begin
+                                stride_c <= mem_rd_data[15:0];
+                                pad <= mem_rd_data[31:16];
+                            end
                         endcase
                         
                         config_count <= config_count + 1;
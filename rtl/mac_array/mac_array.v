@@ -5,7 +5,8 @@ module mac_array #(
     parameter MAC_WIDTH = 8,           // 8x8 MAC array
     parameter DATA_WIDTH = 8,          // Input data width (8 or 16)
     parameter ACC_WIDTH = 32,         // Accumulator width
-    parameter PIPELINE_DEPTH = 3      // Pipeline stages
+    parameter PIPELINE_DEPTH = 3,     // Pipeline stages
+    parameter CLOCK_GATING = 0        // 1 = latch-based clock gate per row (ASIC)
 )(
     input wire clk,
     input wire rst_n,
@@ -15,10 +16,31 @@ module mac_array #(
     input wire data_type,             // 0=int8, 1=int16
     input wire clear_acc,             // Clear accumulators
     
+    // Lane masks for edge tiles: masked rows/columns keep their accumulators,
+    // see no operand toggles and are not clocked
+    input wire [MAC_WIDTH-1:0] row_mask,
+    input wire [MAC_WIDTH-1:0] col_mask,
+    
     // Data inputs
     input wire [MAC_WIDTH*DATA_WIDTH-1:0] matrix_a_row,
     input wire [MAC_WIDTH*DATA_WIDTH-1:0] matrix_b_col,
     
+    // Bit-serial weights (int8 activations, 2-8 bit weights): each cycle a
+    // cell sums the activations of its row's k-group (k = 8g..8g+7) whose
+    // bit weight_plane is set in its B lane, so a k-group takes weight_bits
+    // cycles instead of eight
+    input wire bit_serial,
+    input wire [3:0] weight_bits,
+    input wire [2:0] weight_plane,
+    input wire [MAC_WIDTH*8*DATA_WIDTH-1:0] a_groups,
+    
+    // Binary/ternary (XNOR-popcount): a_groups row i and b_groups column j
+    // hold 64 packed one-bit values (binary) or 32 sign bits in [31:0] and
+    // 32 nonzero bits in [63:32] (ternary); bnn_count products are valid
+    input wire [1:0] bnn_mode,         // 0=off, 1=binary, 2=ternary
+    input wire [6:0] bnn_count,
+    input wire [MAC_WIDTH*8*DATA_WIDTH-1:0] b_groups,
+    
     // Accumulator outputs
     output reg [MAC_WIDTH*MAC_WIDTH*ACC_WIDTH-1:0] accumulators,
     
@@ -30,30 +52,89 @@ module mac_array #(
     // Internal signals
     wire [MAC_WIDTH*MAC_WIDTH*DATA_WIDTH-1:0] mult_results;
     wire [MAC_WIDTH*MAC_WIDTH*ACC_WIDTH-1:0] add_results;
-    reg [MAC_WIDTH*MAC_WIDTH*ACC_WIDTH-1:0] accum_regs;
     
     // Pipeline registers
     reg [PIPELINE_DEPTH-1:0] valid_pipe;
     reg [MAC_WIDTH*MAC_WIDTH*ACC_WIDTH-1:0] accum_pipe [PIPELINE_DEPTH-1:0];
     
+    // Per-cell enables after lane masking
+    wire [MAC_WIDTH*MAC_WIDTH-1:0] cell_enable;
+    
+    // The top bit-plane of a two's complement weight counts negative
+    wire plane_neg = (weight_plane == weight_bits - 1);
+    
+    // Row/column activity for operand isolation and clock gating
+    wire [MAC_WIDTH-1:0] row_active, col_active, row_clocked;
+    
+    // Accumulators changed on the last edge; the output pipeline only loads
+    // then, so it holds still while the array is idle
+    reg acc_changed;
+    reg [PIPELINE_DEPTH-1:0] pipe_load;
+    
     // Generate MAC units
     genvar i, j;
     generate
+        for (i = 0; i < MAC_WIDTH; i = i + 1) begin : gen_row_clk
+            assign row_active[i] = |cell_enable[i*MAC_WIDTH +: MAC_WIDTH];
+            assign row_clocked[i] = row_active[i] || clear_acc;
+            
+            // Per-row clock: gated on ASIC builds; FPGA builds keep one clock
+            // and rely on the cell enables mapping to flop clock enables
+            wire row_clk;
+            if (CLOCK_GATING) begin : gen_icg
+                clock_gate row_icg (
+                    .clk(clk),
+                    .enable(row_clocked[i]),
+                    .test_en(1'b0),
+                    .gclk(row_clk)
+                );
+            end else begin : gen_no_icg
+                assign row_clk = clk;
+            end
+        end
+        
+        for (j = 0; j < MAC_WIDTH; j = j + 1) begin : gen_col_active
+            wire [MAC_WIDTH-1:0] col_cells;
+            for (i = 0; i < MAC_WIDTH; i = i + 1) begin : gen_col_cell
+                assign col_cells[i] = cell_enable[i*MAC_WIDTH+j];
+            end
+            assign col_active[j] = |col_cells;
+        end
+        
         for (i = 0; i < MAC_WIDTH; i = i + 1) begin : gen_mac_row
             for (j = 0; j < MAC_WIDTH; j = j + 1) begin : gen_mac_col
+                assign cell_enable[i*MAC_WIDTH+j] = enable && row_mask[i] && col_mask[j];
+                
+                // Operand isolation: idle rows/columns present constant zeros
+                wire [DATA_WIDTH-1:0] a_iso = row_active[i] ?
+                    matrix_a_row[i*DATA_WIDTH +: DATA_WIDTH] : {DATA_WIDTH{1'b0}};
+                wire [DATA_WIDTH-1:0] b_iso = col_active[j] ?
+                    matrix_b_col[j*DATA_WIDTH +: DATA_WIDTH] : {DATA_WIDTH{1'b0}};
+                wire [8*DATA_WIDTH-1:0] a_group_iso = row_active[i] ?
+                    a_groups[i*8*DATA_WIDTH +: 8*DATA_WIDTH] : {(8*DATA_WIDTH){1'b0}};
+                wire [8*DATA_WIDTH-1:0] b_group_iso = col_active[j] ?
+                    b_groups[j*8*DATA_WIDTH +: 8*DATA_WIDTH] : {(8*DATA_WIDTH){1'b0}};
+                
                 // Instantiate MAC unit
                 mac_unit #(
                     .DATA_WIDTH(DATA_WIDTH),
                     .ACC_WIDTH(ACC_WIDTH)
                 ) mac_inst (
-                    .clk(clk),
+                    .clk(gen_row_clk[i].row_clk),
                     .rst_n(rst_n),
-                    .enable(enable),
+                    .enable(cell_enable[i*MAC_WIDTH+j]),
                     .data_type(data_type),
                     .clear_acc(clear_acc),
-                    .a(matrix_a_row[i*DATA_WIDTH +: DATA_WIDTH]),
-                    .b(matrix_b_col[j*DATA_WIDTH +: DATA_WIDTH]),
-                    .accum_in(accum_regs[(i*MAC_WIDTH+j)*ACC_WIDTH +: ACC_WIDTH]),
+                    .a(a_iso),
+                    .b(b_iso),
+                    .bit_serial(bit_serial),
+                    .a_group(a_group_iso),
+                    .plane(weight_plane),
+                    .plane_neg(plane_neg),
+                    .bnn_mode(bnn_mode),
+                    .bnn_count(bnn_count),
+                    .b_group(b_group_iso),
+                    .accum_in(add_results[(i*MAC_WIDTH+j)*ACC_WIDTH +: ACC_WIDTH]), // Own output: back-to-back steps accumulate
                     .accum_out(add_results[(i*MAC_WIDTH+j)*ACC_WIDTH +: ACC_WIDTH])
                 );
             end
@@ -64,28 +145,28 @@ module mac_array #(
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             valid_pipe <= 0;
-            accum_regs <= 0;
             valid_out <= 0;
             pipeline_stage <= 0;
+            accumulators <= 0;
+            acc_changed <= 0;
+            pipe_load <= 0;
             for (int k = 0; k < PIPELINE_DEPTH; k++) begin
                 accum_pipe[k] <= 0;
             end
         end else begin
-            // Pipeline shift
+            // Pipeline shift; stage k only loads when stage k-1 changed, which
+            // leaves every stage with the same value an always-loading pipe has
             valid_pipe <= {valid_pipe[PIPELINE_DEPTH-2:0], enable};
-            accum_pipe[0] <= add_results;
+            acc_changed <= |row_clocked;
+            pipe_load <= {pipe_load[PIPELINE_DEPTH-2:0], acc_changed};
+            if (acc_changed) accum_pipe[0] <= add_results;
             for (int k = 1; k < PIPELINE_DEPTH; k++) begin
-                accum_pipe[k] <= accum_pipe[k-1];
-            end
-            
-            // Update accumulators
-            if (enable) begin
-                accum_regs <= add_results;
+                if (pipe_load[k-1]) accum_pipe[k] <= accum_pipe[k-1];
             end
             
             // Output signals
             valid_out <= valid_pipe[PIPELINE_DEPTH-1];
-            accumulators <= accum_pipe[PIPELINE_DEPTH-1];
+            if (pipe_load[PIPELINE_DEPTH-1]) accumulators <= accum_pipe[PIPELINE_DEPTH-1];
             pipeline_stage <= valid_pipe;
         end
     end
@@ -104,6 +185,13 @@ module mac_unit #(
     input wire clear_acc,
     input wire [DATA_WIDTH-1:0] a,
     input wire [DATA_WIDTH-1:0] b,
+    input wire bit_serial,    // b holds one bit-plane of 8 weights
+    input wire [8*DATA_WIDTH-1:0] a_group,
+    input wire [2:0] plane,
+    input wire plane_neg,
+    input wire [1:0] bnn_mode,    // 0=off, 1=binary, 2=ternary
+    input wire [6:0] bnn_count,
+    input wire [8*DATA_WIDTH-1:0] b_group,
     input wire [ACC_WIDTH-1:0] accum_in,
     output reg [ACC_WIDTH-1:0] accum_out
 );
@@ -117,8 +205,40 @@ module mac_unit #(
     // Multiplication
     assign mult_result = $signed(a) * $signed(b);
     
+    // Bit-serial: activations selected by the weight bits, scaled by 2^plane
+    reg signed [DATA_WIDTH+3:0] plane_sum;
+    always @(*) begin
+        plane_sum = 0;
+        for (int j = 0; j < 8; j++) begin
+            if (b[j]) plane_sum = plane_sum + $signed(a_group[j*DATA_WIDTH +: DATA_WIDTH]);
+        end
+    end
+    wire signed [ACC_WIDTH-1:0] plane_term = $signed(plane_sum) <<< plane;
+    
+    // Binary: +1/-1 per bit, product +1 where the bits agree (XNOR).
+    // Ternary: product is nonzero where both masks are set, -1 where the
+    // signs differ. Bits at or above bnn_count are ignored.
+    wire [63:0] bnn_mask = bnn_count[6] ? {64{1'b1}} : ((64'd1 << bnn_count) - 1);
+    wire [63:0] xnor_bits = ~(a_group[63:0] ^ b_group[63:0]) & bnn_mask;
+    wire [31:0] tern_nz = a_group[63:32] & b_group[63:32] & bnn_mask[31:0];
+    wire [31:0] tern_neg = (a_group[31:0] ^ b_group[31:0]) & tern_nz;
+    
+    function [6:0] popcount;
+        input [63:0] bits;
+        begin
+            popcount = 0;
+            for (int i = 0; i < 64; i++) popcount = popcount + bits[i];
+        end
+    endfunction
+    
+    wire signed [ACC_WIDTH-1:0] bnn_term = (bnn_mode == 2'd2) ?
+        $signed({1'b0, popcount({32'h0, tern_nz})}) - $signed({1'b0, popcount({32'h0, tern_neg}), 1'b0}) :
+        $signed({1'b0, popcount(xnor_bits), 1'b0}) - $signed({1'b0, bnn_count});
+    
     // Sign extension based on data type
-    assign mult_extended = data_type ? 
+    assign mult_extended = (bnn_mode != 0) ? bnn_term :
+        bit_serial ? (plane_neg ? -plane_term : plane_term) :
+        data_type ? 
         {{(ACC_WIDTH-32){mult_result[31]}}, mult_result} :  // int16
         {{(ACC_WIDTH-16){mult_result[15]}}, mult_result};   // int8
     
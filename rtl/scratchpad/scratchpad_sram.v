@@ -1,124 +1,224 @@
 // Scratchpad SRAM with Double Buffering
-// 32KB total (16KB per buffer) with configurable access patterns
+// 32KB total (16KB per buffer) coded for block RAM inference
+//
+// Bank layout (defaults):
+//   bank 0 = buffer0, bank 1 = buffer1
+//   each bank is BUFFER_SIZE*8/DATA_WIDTH = 512 lines x 256 bits
+//   line l of a bank holds bytes [32*l, 32*l+31] of that buffer, byte b of
+//   the line in data bits [8*b+7:8*b] with its own write enable
+//   addresses are line indices; only the low $clog2(LINES) bits are decoded
+//
+// Each bank is a true dual-port RAM with registered read data and byte
+// write enables. Port A belongs to the DMA on clk and port B to the compute
+// side on compute_clk, so DMA and compute never contend and the bank itself
+// carries data between the two clock domains. Within a port a write wins over a read
+// in the same cycle: the read is not accepted (rd_ready/dma_rd_ready low)
+// and the requester holds it. Read data and rd_valid follow one cycle after
+// an accepted read.
 
 module scratchpad_sram #(
     parameter BUFFER_SIZE = 16384,    // 16KB per buffer
     parameter DATA_WIDTH = 256,        // 256-bit data width
-    parameter ADDR_WIDTH = 14,         // 14 bits for 16KB
-    parameter NUM_BUFFERS = 2          // Double buffering
+    parameter ADDR_WIDTH = 14,         // Line address width at the ports
+    parameter NUM_BUFFERS = 2,         // Double buffering
+    parameter CLOCK_GATING = 0         // 1 = gate each bank port clock (ASIC)
 )(
-    input wire clk,
+    input wire clk,                    // DMA port clock
     input wire rst_n,
+    input wire compute_clk,            // Compute port clock
+    input wire compute_rst_n,          // Synchronized to compute_clk
     
-    // Buffer control
+    // Buffer control (clk domain, static while a job runs)
     input wire buffer_select,          // 0=buffer0, 1=buffer1
     input wire buffer_swap,            // Swap active buffer
     
     // Read interface
     input wire rd_en,
     input wire [ADDR_WIDTH-1:0] rd_addr,
-    output reg [DATA_WIDTH-1:0] rd_data,
+    output wire [DATA_WIDTH-1:0] rd_data,
     output reg rd_valid,
+    output wire rd_ready,              // Read accepted this cycle
     
     // Write interface
     input wire wr_en,
     input wire [ADDR_WIDTH-1:0] wr_addr,
     input wire [DATA_WIDTH-1:0] wr_data,
-    output reg wr_ready,
+    input wire [DATA_WIDTH/8-1:0] wr_be, // Byte write enables
+    output wire wr_ready,
     
     // DMA interface
     input wire dma_rd_en,
     input wire [ADDR_WIDTH-1:0] dma_rd_addr,
-    output reg [DATA_WIDTH-1:0] dma_rd_data,
+    output wire [DATA_WIDTH-1:0] dma_rd_data,
     output reg dma_rd_valid,
+    output wire dma_rd_ready,
     
     input wire dma_wr_en,
     input wire [ADDR_WIDTH-1:0] dma_wr_addr,
     input wire [DATA_WIDTH-1:0] dma_wr_data,
-    output reg dma_wr_ready
+    input wire [DATA_WIDTH/8-1:0] dma_wr_be,
+    output wire dma_wr_ready
 );
 
-    // Memory arrays for both buffers
-    reg [DATA_WIDTH-1:0] buffer0 [0:BUFFER_SIZE-1];
-    reg [DATA_WIDTH-1:0] buffer1 [0:BUFFER_SIZE-1];
+    localparam LINES = BUFFER_SIZE * 8 / DATA_WIDTH;
+    localparam LINE_BITS = $clog2(LINES);
+    localparam BYTES = DATA_WIDTH / 8;
     
-    // Buffer selection logic
-    wire [DATA_WIDTH-1:0] buffer0_rd_data, buffer1_rd_data;
-    wire [DATA_WIDTH-1:0] buffer0_wr_data, buffer1_wr_data;
+    // buffer_swap flips which bank buffer_select refers to
+    reg swapped;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            swapped <= 0;
+        end else if (buffer_swap) begin
+            swapped <= ~swapped;
+        end
+    end
     
-    // Read data multiplexing
-    assign buffer0_rd_data = buffer0[rd_addr];
-    assign buffer1_rd_data = buffer1[rd_addr];
+    wire active_bank = buffer_select ^ swapped;
     
-    // Write data demultiplexing
-    assign buffer0_wr_data = wr_data;
-    assign buffer1_wr_data = wr_data;
+    wire compute_bank;
+    cdc_sync_bit bank_sync (
+        .clk(compute_clk),
+        .rst_n(compute_rst_n),
+        .d(active_bank),
+        .q(compute_bank)
+    );
     
-    // Read operations
-    always @(posedge clk or negedge rst_n) begin
-        if (!rst_n) begin
-            rd_data <= 0;
-            rd_valid <= 0;
-            dma_rd_data <= 0;
-            dma_rd_valid <= 0;
-        end else begin
-            // Regular read
-            if (rd_en) begin
-                rd_data <= buffer_select ? buffer1_rd_data : buffer0_rd_data;
-                rd_valid <= 1;
-            end else begin
-                rd_valid <= 0;
+    // Port arbitration: writes always win, a colliding read waits
+    assign wr_ready = 1'b1;
+    assign dma_wr_ready = 1'b1;
+    assign rd_ready = !wr_en;
+    assign dma_rd_ready = !dma_wr_en;
+    
+    wire cpu_rd_go = rd_en && rd_ready;
+    wire dma_rd_go = dma_rd_en && dma_rd_ready;
+    
+    // Port B (compute) and port A (DMA) requests
+    wire                  b_en   = wr_en || cpu_rd_go;
+    wire [BYTES-1:0]      b_we   = wr_en ? wr_be : {BYTES{1'b0}};
+    wire [LINE_BITS-1:0]  b_addr = wr_en ? wr_addr[LINE_BITS-1:0] : rd_addr[LINE_BITS-1:0];
+    wire                  a_en   = dma_wr_en || dma_rd_go;
+    wire [BYTES-1:0]      a_we   = dma_wr_en ? dma_wr_be : {BYTES{1'b0}};
+    wire [LINE_BITS-1:0]  a_addr = dma_wr_en ? dma_wr_addr[LINE_BITS-1:0] : dma_rd_addr[LINE_BITS-1:0];
+    
+    wire [DATA_WIDTH-1:0] bank_a_dout [0:NUM_BUFFERS-1];
+    wire [DATA_WIDTH-1:0] bank_b_dout [0:NUM_BUFFERS-1];
+    
+    genvar g;
+    generate
+        for (g = 0; g < NUM_BUFFERS; g = g + 1) begin : banks
+            // An idle bank port sees no enable; with CLOCK_GATING its clock
+            // stops as well, otherwise the enable maps to the RAM port enable
+            wire bank_a_en = a_en && active_bank == g;
+            wire bank_b_en = b_en && compute_bank == g;
+            wire bank_clk_a, bank_clk_b;
+            if (CLOCK_GATING) begin : gen_icg
+                clock_gate icg_a (
+                    .clk(clk),
+                    .enable(bank_a_en),
+                    .test_en(1'b0),
+                    .gclk(bank_clk_a)
+                );
+                clock_gate icg_b (
+                    .clk(compute_clk),
+                    .enable(bank_b_en),
+                    .test_en(1'b0),
+                    .gclk(bank_clk_b)
+                );
+            end else begin : gen_no_icg
+                assign bank_clk_a = clk;
+                assign bank_clk_b = compute_clk;
             end
             
-            // DMA read
-            if (dma_rd_en) begin
-                dma_rd_data <= buffer_select ? buffer1[dma_rd_addr] : buffer0[dma_rd_addr];
-                dma_rd_valid <= 1;
-            end else begin
-                dma_rd_valid <= 0;
-            end
+            scratchpad_bank #(
+                .DEPTH(LINES),
+                .DATA_WIDTH(DATA_WIDTH)
+            ) bank (
+                .clk_a(bank_clk_a),
+                .a_en(bank_a_en),
+                .a_we(a_we),
+                .a_addr(a_addr),
+                .a_din(dma_wr_data),
+                .a_dout(bank_a_dout[g]),
+                .clk_b(bank_clk_b),
+                .b_en(bank_b_en),
+                .b_we(b_we),
+                .b_addr(b_addr),
+                .b_din(wr_data),
+                .b_dout(bank_b_dout[g])
+            );
+        end
+    endgenerate
+    
+    // Bank that produced the data now on the read outputs
+    reg rd_bank, dma_rd_bank;
+    always @(posedge compute_clk or negedge compute_rst_n) begin
+        if (!compute_rst_n) begin
+            rd_valid <= 0;
+            rd_bank <= 0;
+        end else begin
+            rd_valid <= cpu_rd_go;
+            if (cpu_rd_go) rd_bank <= compute_bank;
         end
     end
     
-    // Write operations
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
-            wr_ready <= 1;
-            dma_wr_ready <= 1;
+            dma_rd_valid <= 0;
+            dma_rd_bank <= 0;
         end else begin
-            // Regular write
-            if (wr_en) begin
-                if (buffer_select) begin
-                    buffer1[wr_addr] <= wr_data;
-                end else begin
-                    buffer0[wr_addr] <= wr_data;
-                end
-                wr_ready <= 1;
-            end else begin
-                wr_ready <= 1;
-            end
-            
-            // DMA write
-            if (dma_wr_en) begin
-                if (buffer_select) begin
-                    buffer1[dma_wr_addr] <= dma_wr_data;
-                end else begin
-                    buffer0[dma_wr_addr] <= dma_wr_data;
-                end
-                dma_wr_ready <= 1;
-            end else begin
-                dma_wr_ready <= 1;
+            dma_rd_valid <= dma_rd_go;
+            if (dma_rd_go) dma_rd_bank <= active_bank;
+        end
+    end
+    
+    assign rd_data = bank_b_dout[rd_bank];
+    assign dma_rd_data = bank_a_dout[dma_rd_bank];
+
+endmodule
+
+// Scratchpad Bank
+// True dual-port RAM with byte write enables and registered read-first outputs,
+// one clock per port
+
+module scratchpad_bank #(
+    parameter DEPTH = 512,             // Lines per bank
+    parameter DATA_WIDTH = 256
+)(
+    input wire clk_a,
+    input wire a_en,
+    input wire [DATA_WIDTH/8-1:0] a_we,
+    input wire [$clog2(DEPTH)-1:0] a_addr,
+    input wire [DATA_WIDTH-1:0] a_din,
+    output reg [DATA_WIDTH-1:0] a_dout,
+    
+    input wire clk_b,
+    input wire b_en,
+    input wire [DATA_WIDTH/8-1:0] b_we,
+    input wire [$clog2(DEPTH)-1:0] b_addr,
+    input wire [DATA_WIDTH-1:0] b_din,
+    output reg [DATA_WIDTH-1:0] b_dout
+);
+
+    // No reset on the array or the output registers so the tools can map
+    // them onto block RAM and its output latches
+    reg [DATA_WIDTH-1:0] mem [0:DEPTH-1];
+    
+    always @(posedge clk_a) begin
+        if (a_en) begin
+            for (int i = 0; i < DATA_WIDTH/8; i++) begin
+                if (a_we[i]) mem[a_addr][i*8 +: 8] <= a_din[i*8 +: 8];
             end
+            a_dout <= mem[a_addr];
         end
     end
     
-    // Buffer swap logic
-    reg [1:0] swap_state;
-    always @(posedge clk or negedge rst_n) begin
-        if (!rst_n) begin
-            swap_state <= 0;
-        end else if (buffer_swap) begin
-            swap_state <= swap_state + 1;
+    always @(posedge clk_b) begin
+        if (b_en) begin
+            for (int i = 0; i < DATA_WIDTH/8; i++) begin
+                if (b_we[i]) mem[b_addr][i*8 +: 8] <= b_din[i*8 +: 8];
+            end
+            b_dout <= mem[b_addr];
         end
     end
 
@@ -139,6 +239,8 @@ module matrix_access_controller #(
     input wire start,
     input wire [15:0] m_dim, k_dim, n_dim,
     input wire [15:0] stride_a, stride_b, stride_c,
+    input wire [3:0] weight_bits,      // 0 = full precision, else bit-serial B
+    input wire [1:0] bnn_mode,         // 0 = off, 1 = binary, 2 = ternary
     
     // Matrix pointers
     input wire [31:0] matrix_a_base,
@@ -160,6 +262,12 @@ module matrix_access_controller #(
     output reg mac_enable,
     output reg [TILE_SIZE*DATA_WIDTH-1:0] mac_a_row,
     output reg [TILE_SIZE*DATA_WIDTH-1:0] mac_b_col,
+    output reg [2:0] mac_weight_plane,
+    output reg [TILE_SIZE*8*DATA_WIDTH-1:0] mac_a_groups,
+    output reg [TILE_SIZE*8*DATA_WIDTH-1:0] mac_b_groups,
+    output reg [6:0] mac_bnn_count,
+    output wire [TILE_SIZE-1:0] mac_row_mask,
+    output wire [TILE_SIZE-1:0] mac_col_mask,
     
     // Status
     output reg done,
@@ -179,6 +287,23 @@ module matrix_access_controller #(
     reg [15:0] elem_i, elem_j, elem_k;
     reg [31:0] addr_a, addr_b, addr_c;
     
+    // MAC steps per tile: TILE_SIZE k-steps, or one bit-plane per step
+    // when weights are bit-serial (TILE_SIZE = one k-group of eight)
+    wire [15:0] compute_steps = (bnn_mode != 0) ? 1 :
+                                (weight_bits != 0) ? weight_bits : TILE_SIZE;
+    
+    // Binary/ternary: one packed 64-bit word per lane covers 64 (binary)
+    // or 32 (ternary) k steps
+    wire [6:0] bnn_lanes = (bnn_mode == 2'd2) ? 7'd32 : 7'd64;
+    
+    // Edge tiles: only the rows/columns inside m_dim x n_dim are enabled
+    wire [15:0] rows_left = m_dim - tile_m * TILE_SIZE;
+    wire [15:0] cols_left = n_dim - tile_n * TILE_SIZE;
+    assign mac_row_mask = (rows_left >= TILE_SIZE) ? {TILE_SIZE{1'b1}} :
+                          ((1 << rows_left) - 1);
+    assign mac_col_mask = (cols_left >= TILE_SIZE) ? {TILE_SIZE{1'b1}} :
+                          ((1 << cols_left) - 1);
+    
     // Tile addressing
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
@@ -195,8 +320,18 @@ module matrix_access_controller #(
             scratchpad_wr_en <= 0;
             scratchpad_rd_en <= 0;
             mac_enable <= 0;
+            mac_weight_plane <= 0;
+            mac_a_groups <= 0;
+            mac_b_groups <= 0;
+            mac_bnn_count <= 0;
             done <= 0;
         end else begin
+            // Enables are asserted only by the state that needs them, so the
+            // MAC array and scratchpad ports idle between phases
+            scratchpad_wr_en <= 0;
+            scratchpad_rd_en <= 0;
+            mac_enable <= 0;
+            
             case (state)
                 IDLE: begin
                     if (start) begin
@@ -247,9 +382,19 @@ module matrix_access_controller #(
                     scratchpad_rd_addr <= TILE_SIZE + elem_j;
                     mac_b_col <= scratchpad_rd_data[TILE_SIZE*DATA_WIDTH-1:0];
                     
+                    // Bit-serial: the A k-group stays put while B planes stream
+                    mac_weight_plane <= elem_k[2:0];
+                    if (elem_k == 0) begin
+                        mac_a_groups <= scratchpad_rd_data;
+                    end
+                    
+                    // Binary/ternary: packed A and B words, one step per word
+                    mac_b_groups <= scratchpad_rd_data;
+                    mac_bnn_count <= (k_dim < bnn_lanes) ? k_dim[6:0] : bnn_lanes;
+                    
                     mac_enable <= 1;
                     
-                    if (elem_k == TILE_SIZE - 1) begin
+                    if (elem_k == compute_steps - 1) begin
                         state <= STORE_C;
                         elem_k <= 0;
                     end else begin
@@ -0,0 +1,149 @@
+// ABFT Checker
+// Algorithm-based fault tolerance for the output stage: checksums of A and B
+// taken while their lines are loaded predict the sum of all C elements,
+// which is compared with the sum of C as it is stored
+//
+// sum(C) = sum_k colsum_A[k] * rowsum_B[k], evaluated modulo 2^32 like the
+// wrapping accumulators. colsum_A is kept per A row line position and lane;
+// each B line lies inside one row k and adds colsum_A[k] times its element
+// sum. Rows of A and B must therefore be whole lines, and a row of A at most
+// MAX_ROW_LINES lines; the top only enables the check for such jobs.
+
+module abft_checker #(
+    parameter LINE_WIDTH = 256,
+    parameter ELEM_WIDTH = 8,          // Operand element width
+    parameter MAX_ROW_LINES = 32       // Longest A row (k_dim * ELEM_WIDTH / LINE_WIDTH)
+)(
+    input wire clk,
+    input wire rst_n,
+
+    // Job geometry, sampled while start is high
+    input wire start,                  // Clears the checksums
+    input wire [15:0] a_row_lines,     // Lines per row of A
+    input wire [15:0] b_row_lines,     // Lines per row of B
+    input wire [15:0] n_dim,           // int32 elements per row of C
+
+    // DMA scratchpad traffic
+    input wire load_a,
+    input wire load_b,
+    input wire store_c,
+    input wire wr_valid,               // Line loaded into the scratchpad
+    input wire [LINE_WIDTH-1:0] wr_data,
+    input wire rd_valid,               // Line read out for storing
+    input wire [LINE_WIDTH-1:0] rd_data,
+
+    output reg [31:0] expected,        // Settles two cycles after the last B line
+    output reg [31:0] observed
+);
+
+    localparam LANES = LINE_WIDTH / ELEM_WIDTH;
+    localparam C_LANES = LINE_WIDTH / 32;
+    localparam LANE_BITS = $clog2(LANES);
+    localparam LINE_BITS = $clog2(MAX_ROW_LINES);
+
+    // Column sums of A, LANES per row line position; the first row of A
+    // overwrites, so no clearing pass is needed
+    reg [32*LANES-1:0] col_sum [0:MAX_ROW_LINES-1];
+    reg [15:0] a_line;
+    reg a_first_row;
+
+    // Position in B (k = b_row) and in the current C row
+    reg [15:0] b_line;
+    reg [15:0] b_row;
+    reg [15:0] c_left;
+
+    // B products are formed one cycle after the line arrives
+    reg b_valid_q;
+    reg [31:0] b_sum_q;
+    reg [31:0] b_coef_q;
+
+    wire [32*LANES-1:0] a_word = col_sum[a_line[LINE_BITS-1:0]];
+    wire [32*LANES-1:0] k_word = col_sum[b_row[LANE_BITS +: LINE_BITS]];
+    wire [31:0] k_coef = k_word[32*b_row[LANE_BITS-1:0] +: 32];
+
+    reg [32*LANES-1:0] a_next;
+    reg [31:0] elem;
+    reg [31:0] b_sum;
+    reg [31:0] c_sum;
+
+    integer i;
+    always @(*) begin
+        b_sum = 0;
+        for (i = 0; i < LANES; i = i + 1) begin
+            elem = {{(32-ELEM_WIDTH){wr_data[ELEM_WIDTH*i + ELEM_WIDTH-1]}}, wr_data[ELEM_WIDTH*i +: ELEM_WIDTH]};
+            a_next[32*i +: 32] = (a_first_row ? 32'd0 : a_word[32*i +: 32]) + elem;
+            b_sum = b_sum + elem;
+        end
+
+        // Lanes past the end of a C row are not stored
+        c_sum = 0;
+        for (i = 0; i < C_LANES; i = i + 1) begin
+            if (i < c_left) begin
+                c_sum = c_sum + rd_data[32*i +: 32];
+            end
+        end
+    end
+
+    always @(posedge clk) begin
+        if (!start && load_a && wr_valid) begin
+            col_sum[a_line[LINE_BITS-1:0]] <= a_next;
+        end
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            a_line <= 0;
+            a_first_row <= 1;
+            b_line <= 0;
+            b_row <= 0;
+            c_left <= 0;
+            b_valid_q <= 0;
+            b_sum_q <= 0;
+            b_coef_q <= 0;
+            expected <= 0;
+            observed <= 0;
+        end else if (start) begin
+            a_line <= 0;
+            a_first_row <= 1;
+            b_line <= 0;
+            b_row <= 0;
+            c_left <= n_dim;
+            b_valid_q <= 0;
+            expected <= 0;
+            observed <= 0;
+        end else begin
+            b_valid_q <= 0;
+
+            if (load_a && wr_valid) begin
+                if (a_line == a_row_lines - 1) begin
+                    a_line <= 0;
+                    a_first_row <= 0;
+                end else begin
+                    a_line <= a_line + 1;
+                end
+            end
+
+            if (load_b && wr_valid) begin
+                b_valid_q <= 1;
+                b_sum_q <= b_sum;
+                b_coef_q <= k_coef;
+                if (b_line == b_row_lines - 1) begin
+                    b_line <= 0;
+                    b_row <= b_row + 1;
+                end else begin
+                    b_line <= b_line + 1;
+                end
+            end
+
+            if (b_valid_q) begin
+                expected <= expected + b_coef_q * b_sum_q;
+            end
+
+            if (store_c && rd_valid) begin
+                observed <= observed + c_sum;
+                c_left <= (c_left > C_LANES) ? c_left - C_LANES : n_dim;
+            end
+        end
+    end
+
+endmodule
@@ -0,0 +1,182 @@
+// Clock Domain Crossing Primitives
+// Bit synchronizer, toggle pulse synchronizer, gray-coded async FIFO and
+// clock gate
+
+// Two-flop synchronizer for a level that is stable for several cycles
+module cdc_sync_bit #(
+    parameter STAGES = 2
+)(
+    input wire clk,                    // Destination clock
+    input wire rst_n,                  // Destination reset
+    input wire d,
+    output wire q
+);
+
+    (* ASYNC_REG = "TRUE" *) reg [STAGES-1:0] sync;
+    
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            sync <= 0;
+        end else begin
+            sync <= {sync[STAGES-2:0], d};
+        end
+    end
+    
+    assign q = sync[STAGES-1];
+
+endmodule
+
+// Reset synchronizer: asynchronous assert, synchronous release
+module cdc_reset_sync (
+    input wire clk,
+    input wire rst_n_in,
+    output wire rst_n_out
+);
+
+    (* ASYNC_REG = "TRUE" *) reg [1:0] sync;
+    
+    always @(posedge clk or negedge rst_n_in) begin
+        if (!rst_n_in) begin
+            sync <= 2'b00;
+        end else begin
+            sync <= {sync[0], 1'b1};
+        end
+    end
+    
+    assign rst_n_out = sync[1];
+
+endmodule
+
+// Single-cycle pulse crossing: the source toggles a level, the destination
+// detects the edge. Pulses must be at least three destination cycles apart.
+module cdc_pulse (
+    input wire src_clk,
+    input wire src_rst_n,
+    input wire src_pulse,
+    input wire dst_clk,
+    input wire dst_rst_n,
+    output wire dst_pulse
+);
+
+    reg src_toggle;
+    always @(posedge src_clk or negedge src_rst_n) begin
+        if (!src_rst_n) begin
+            src_toggle <= 0;
+        end else if (src_pulse) begin
+            src_toggle <= ~src_toggle;
+        end
+    end
+    
+    wire dst_toggle;
+    cdc_sync_bit sync_inst (
+        .clk(dst_clk),
+        .rst_n(dst_rst_n),
+        .d(src_toggle),
+        .q(dst_toggle)
+    );
+    
+    reg dst_toggle_d;
+    always @(posedge dst_clk or negedge dst_rst_n) begin
+        if (!dst_rst_n) begin
+            dst_toggle_d <= 0;
+        end else begin
+            dst_toggle_d <= dst_toggle;
+        end
+    end
+    
+    assign dst_pulse = dst_toggle ^ dst_toggle_d;
+
+endmodule
+
+// Asynchronous FIFO with gray-coded pointers (show-ahead read)
+module async_fifo #(
+    parameter WIDTH = 32,
+    parameter DEPTH = 4                // Power of two, at least 4
+)(
+    input wire wr_clk,
+    input wire wr_rst_n,
+    input wire wr_en,
+    input wire [WIDTH-1:0] wr_data,
+    output wire full,
+    
+    input wire rd_clk,
+    input wire rd_rst_n,
+    input wire rd_en,
+    output wire [WIDTH-1:0] rd_data,
+    output wire empty
+);
+
+    localparam PTR_BITS = $clog2(DEPTH);
+    
+    reg [WIDTH-1:0] mem [0:DEPTH-1];
+    
+    // Binary and gray pointers carry one extra wrap bit
+    reg [PTR_BITS:0] wr_bin, wr_gray;
+    reg [PTR_BITS:0] rd_bin, rd_gray;
+    (* ASYNC_REG = "TRUE" *) reg [PTR_BITS:0] rd_gray_w1, rd_gray_w2;
+    (* ASYNC_REG = "TRUE" *) reg [PTR_BITS:0] wr_gray_r1, wr_gray_r2;
+    
+    wire [PTR_BITS:0] wr_bin_next = wr_bin + (wr_en && !full);
+    wire [PTR_BITS:0] rd_bin_next = rd_bin + (rd_en && !empty);
+    
+    // Write domain
+    always @(posedge wr_clk or negedge wr_rst_n) begin
+        if (!wr_rst_n) begin
+            wr_bin <= 0;
+            wr_gray <= 0;
+            rd_gray_w1 <= 0;
+            rd_gray_w2 <= 0;
+        end else begin
+            wr_bin <= wr_bin_next;
+            wr_gray <= wr_bin_next ^ (wr_bin_next >> 1);
+            rd_gray_w1 <= rd_gray;
+            rd_gray_w2 <= rd_gray_w1;
+        end
+    end
+    
+    always @(posedge wr_clk) begin
+        if (wr_en && !full) begin
+            mem[wr_bin[PTR_BITS-1:0]] <= wr_data;
+        end
+    end
+    
+    // Full when the write pointer is one lap ahead of the read pointer
+    assign full = (wr_gray == {~rd_gray_w2[PTR_BITS:PTR_BITS-1], rd_gray_w2[PTR_BITS-2:0]});
+    
+    // Read domain
+    always @(posedge rd_clk or negedge rd_rst_n) begin
+        if (!rd_rst_n) begin
+            rd_bin <= 0;
+            rd_gray <= 0;
+            wr_gray_r1 <= 0;
+            wr_gray_r2 <= 0;
+        end else begin
+            rd_bin <= rd_bin_next;
+            rd_gray <= rd_bin_next ^ (rd_bin_next >> 1);
+            wr_gray_r1 <= wr_gray;
+            wr_gray_r2 <= wr_gray_r1;
+        end
+    end
+    
+    assign empty = (rd_gray == wr_gray_r2);
+    assign rd_data = mem[rd_bin[PTR_BITS-1:0]];
+
+endmodule
+
+// Integrated clock gate: enable is latched while clk is low so the gated
+// clock never glitches; test_en forces the clock on for scan
+module clock_gate (
+    input wire clk,
+    input wire enable,
+    input wire test_en,
+    output wire gclk
+);
+
+    reg en_latch;
+    always @(*) begin
+        if (!clk) en_latch = enable || test_en;
+    end
+    
+    assign gclk = clk & en_latch;
+
+endmodule
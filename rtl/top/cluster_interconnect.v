@@ -0,0 +1,299 @@
+// Cluster Memory Interconnect
+// Shares one AXI memory port between NUM_CORES accelerator cores, with
+// multicast reads so one weight fetch fills the scratchpads of all cores
+//
+// Multicast: a core is a member while it has multicast weights still to load
+// (mcast_member) and flags its weight reads with s_armcast. Flagged reads wait
+// until every member presents one; members whose address and length match
+// the round-robin leader's are then served by a single memory read whose R
+// beats go to all of them. Each receiver takes a beat once, when it is
+// ready; the beat is accepted from memory after every receiver has it.
+// Members that disagree are served in later rounds, so mismatched jobs only
+// lose the sharing, never progress. Unflagged reads and all writes are
+// arbitrated round-robin, one burst at a time per channel, with responses
+// returned in issue order.
+
+module cluster_interconnect #(
+    parameter NUM_CORES = 4,
+    parameter DATA_WIDTH = 256,        // Memory port width
+    parameter ADDR_WIDTH = 32,
+    parameter MAX_OUTSTANDING = 4      // Read/write bursts in flight (power of 2)
+)(
+    input wire clk,
+    input wire rst_n,
+
+    // Core side (flattened per core)
+    input wire [NUM_CORES-1:0] mcast_member,
+    input wire [NUM_CORES-1:0] s_arvalid,
+    input wire [NUM_CORES*ADDR_WIDTH-1:0] s_araddr,
+    input wire [NUM_CORES*8-1:0] s_arlen,
+    input wire [NUM_CORES*3-1:0] s_arsize,
+    input wire [NUM_CORES-1:0] s_armcast,
+    output wire [NUM_CORES-1:0] s_arready,
+
+    input wire [NUM_CORES-1:0] s_rready,
+    output wire [NUM_CORES-1:0] s_rvalid,
+    output wire [DATA_WIDTH-1:0] s_rdata,          // Shared by all cores
+    output wire s_rlast,
+
+    input wire [NUM_CORES-1:0] s_awvalid,
+    input wire [NUM_CORES*ADDR_WIDTH-1:0] s_awaddr,
+    input wire [NUM_CORES*8-1:0] s_awlen,
+    input wire [NUM_CORES*3-1:0] s_awsize,
+    output wire [NUM_CORES-1:0] s_awready,
+
+    input wire [NUM_CORES-1:0] s_wvalid,
+    input wire [NUM_CORES*DATA_WIDTH-1:0] s_wdata,
+    input wire [NUM_CORES*DATA_WIDTH/8-1:0] s_wstrb,
+    input wire [NUM_CORES-1:0] s_wlast,
+    output wire [NUM_CORES-1:0] s_wready,
+
+    output wire [NUM_CORES-1:0] s_bvalid,
+    input wire [NUM_CORES-1:0] s_bready,
+
+    // Memory side
+    output reg m_arvalid,
+    output reg [ADDR_WIDTH-1:0] m_araddr,
+    output reg [7:0] m_arlen,
+    output reg [2:0] m_arsize,
+    input wire m_arready,
+
+    output wire m_rready,
+    input wire m_rvalid,
+    input wire [DATA_WIDTH-1:0] m_rdata,
+    input wire m_rlast,
+
+    output reg m_awvalid,
+    output reg [ADDR_WIDTH-1:0] m_awaddr,
+    output reg [7:0] m_awlen,
+    output reg [2:0] m_awsize,
+    input wire m_awready,
+
+    output wire m_wvalid,
+    output wire [DATA_WIDTH-1:0] m_wdata,
+    output wire [DATA_WIDTH/8-1:0] m_wstrb,
+    output wire m_wlast,
+    input wire m_wready,
+
+    input wire m_bvalid,
+    output wire m_bready,
+
+    // Statistics
+    output reg [31:0] mcast_reads,     // Memory reads shared by two or more cores
+    output reg [31:0] mcast_beats_saved // R beats not fetched thanks to sharing
+);
+
+    localparam CORE_BITS = (NUM_CORES > 1) ? $clog2(NUM_CORES) : 1;
+    localparam Q_BITS = $clog2(MAX_OUTSTANDING);
+
+    // ------------------------------------------------------------------
+    // Read address arbitration
+    // ------------------------------------------------------------------
+    reg [CORE_BITS-1:0] rd_rr;
+    
+    // Read owner queue: receivers of each outstanding read, in issue order
+    reg [NUM_CORES-1:0] rq_owner [0:MAX_OUTSTANDING-1];
+    reg [Q_BITS:0] rq_count;
+    reg [Q_BITS-1:0] rq_head, rq_tail;
+    
+    wire [NUM_CORES-1:0] mc_req = s_arvalid & s_armcast & mcast_member;
+    wire [NUM_CORES-1:0] uc_req = s_arvalid & ~(s_armcast & mcast_member);
+    wire mc_all = (mc_req != 0) && (mc_req == mcast_member);
+    wire ar_slot_free = (!m_arvalid || m_arready) && (rq_count < MAX_OUTSTANDING);
+    
+    reg [CORE_BITS-1:0] mc_leader, uc_sel;
+    reg uc_found, mc_found;
+    reg [NUM_CORES-1:0] ar_grant;
+    
+    always @(*) begin
+        mc_leader = 0;
+        uc_sel = 0;
+        mc_found = 0;
+        uc_found = 0;
+        for (int k = 0; k < NUM_CORES; k++) begin
+            if (!mc_found && mc_req[(rd_rr + k) % NUM_CORES]) begin
+                mc_leader = (rd_rr + k) % NUM_CORES;
+                mc_found = 1;
+            end
+            if (!uc_found && uc_req[(rd_rr + k) % NUM_CORES]) begin
+                uc_sel = (rd_rr + k) % NUM_CORES;
+                uc_found = 1;
+            end
+        end
+        
+        ar_grant = 0;
+        if (ar_slot_free) begin
+            if (mc_all) begin
+                // Everyone asking for the leader's burst shares it
+                for (int c = 0; c < NUM_CORES; c++) begin
+                    ar_grant[c] = mc_req[c] &&
+                        s_araddr[c*ADDR_WIDTH +: ADDR_WIDTH] == s_araddr[mc_leader*ADDR_WIDTH +: ADDR_WIDTH] &&
+                        s_arlen[c*8 +: 8] == s_arlen[mc_leader*8 +: 8];
+                end
+            end else if (uc_found) begin
+                ar_grant[uc_sel] = 1;
+            end
+        end
+    end
+    
+    assign s_arready = ar_grant;
+    
+    wire [CORE_BITS-1:0] ar_src = mc_all ? mc_leader : uc_sel;
+    
+    function [CORE_BITS:0] count_ones;
+        input [NUM_CORES-1:0] bits;
+        begin
+            count_ones = 0;
+            for (int c = 0; c < NUM_CORES; c++) count_ones = count_ones + bits[c];
+        end
+    endfunction
+    
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            m_arvalid <= 0;
+            m_araddr <= 0;
+            m_arlen <= 0;
+            m_arsize <= 0;
+            rd_rr <= 0;
+            mcast_reads <= 0;
+            mcast_beats_saved <= 0;
+        end else begin
+            if (m_arvalid && m_arready) begin
+                m_arvalid <= 0;
+            end
+            if (ar_grant != 0) begin
+                m_arvalid <= 1;
+                m_araddr <= s_araddr[ar_src*ADDR_WIDTH +: ADDR_WIDTH];
+                m_arlen <= s_arlen[ar_src*8 +: 8];
+                m_arsize <= s_arsize[ar_src*3 +: 3];
+                rd_rr <= (ar_src + 1) % NUM_CORES;
+                if (count_ones(ar_grant) > 1) begin
+                    mcast_reads <= mcast_reads + 1;
+                    mcast_beats_saved <= mcast_beats_saved +
+                        (count_ones(ar_grant) - 1) * (s_arlen[ar_src*8 +: 8] + 1);
+                end
+            end
+        end
+    end
+    
+    // ------------------------------------------------------------------
+    // Read data routing
+    // ------------------------------------------------------------------
+    wire [NUM_CORES-1:0] r_owner = rq_owner[rq_head];
+    wire r_active = (rq_count != 0);
+    
+    // Receivers that already took the current beat are not offered it again
+    reg [NUM_CORES-1:0] r_taken;
+    wire [NUM_CORES-1:0] r_took = s_rvalid & s_rready;
+    
+    assign s_rvalid = {NUM_CORES{m_rvalid && r_active}} & r_owner & ~r_taken;
+    assign s_rdata = m_rdata;
+    assign s_rlast = m_rlast;
+    assign m_rready = r_active && ((r_took | r_taken | ~r_owner) == {NUM_CORES{1'b1}});
+    
+    wire r_pop = m_rvalid && m_rready && m_rlast;
+    wire r_push = (ar_grant != 0);
+    
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            rq_count <= 0;
+            rq_head <= 0;
+            rq_tail <= 0;
+            r_taken <= 0;
+        end else begin
+            if (m_rvalid && m_rready) begin
+                r_taken <= 0;
+            end else begin
+                r_taken <= r_taken | r_took;
+            end
+            if (r_push) begin
+                rq_owner[rq_tail] <= ar_grant;
+                rq_tail <= rq_tail + 1;
+            end
+            if (r_pop) begin
+                rq_head <= rq_head + 1;
+            end
+            rq_count <= rq_count + r_push - r_pop;
+        end
+    end
+    
+    // ------------------------------------------------------------------
+    // Write path: one burst at a time, W follows the AW grant
+    // ------------------------------------------------------------------
+    reg [CORE_BITS-1:0] wr_rr;
+    reg w_active;
+    reg [CORE_BITS-1:0] w_sel;
+    
+    // B owner queue
+    reg [CORE_BITS-1:0] bq_owner [0:MAX_OUTSTANDING-1];
+    reg [Q_BITS:0] bq_count;
+    reg [Q_BITS-1:0] bq_head, bq_tail;
+    
+    reg [CORE_BITS-1:0] aw_sel;
+    reg aw_found;
+    always @(*) begin
+        aw_sel = 0;
+        aw_found = 0;
+        for (int k = 0; k < NUM_CORES; k++) begin
+            if (!aw_found && s_awvalid[(wr_rr + k) % NUM_CORES]) begin
+                aw_sel = (wr_rr + k) % NUM_CORES;
+                aw_found = 1;
+            end
+        end
+    end
+    
+    wire aw_go = aw_found && !w_active && (!m_awvalid || m_awready) &&
+                 (bq_count < MAX_OUTSTANDING);
+    assign s_awready = aw_go ? ({{(NUM_CORES-1){1'b0}}, 1'b1} << aw_sel) : {NUM_CORES{1'b0}};
+    
+    assign m_wvalid = w_active && s_wvalid[w_sel];
+    assign m_wdata = s_wdata[w_sel*DATA_WIDTH +: DATA_WIDTH];
+    assign m_wstrb = s_wstrb[w_sel*DATA_WIDTH/8 +: DATA_WIDTH/8];
+    assign m_wlast = s_wlast[w_sel];
+    assign s_wready = (w_active && m_wready) ? ({{(NUM_CORES-1){1'b0}}, 1'b1} << w_sel) : {NUM_CORES{1'b0}};
+    
+    wire [CORE_BITS-1:0] b_owner = bq_owner[bq_head];
+    wire b_active = (bq_count != 0);
+    assign s_bvalid = (m_bvalid && b_active) ? ({{(NUM_CORES-1){1'b0}}, 1'b1} << b_owner) : {NUM_CORES{1'b0}};
+    assign m_bready = b_active && s_bready[b_owner];
+    
+    wire b_pop = m_bvalid && m_bready;
+    
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            m_awvalid <= 0;
+            m_awaddr <= 0;
+            m_awlen <= 0;
+            m_awsize <= 0;
+            wr_rr <= 0;
+            w_active <= 0;
+            w_sel <= 0;
+            bq_count <= 0;
+            bq_head <= 0;
+            bq_tail <= 0;
+        end else begin
+            if (m_awvalid && m_awready) begin
+                m_awvalid <= 0;
+            end
+            if (aw_go) begin
+                m_awvalid <= 1;
+                m_awaddr <= s_awaddr[aw_sel*ADDR_WIDTH +: ADDR_WIDTH];
+                m_awlen <= s_awlen[aw_sel*8 +: 8];
+                m_awsize <= s_awsize[aw_sel*3 +: 3];
+                w_active <= 1;
+                w_sel <= aw_sel;
+                wr_rr <= (aw_sel + 1) % NUM_CORES;
+                bq_owner[bq_tail] <= aw_sel;
+                bq_tail <= bq_tail + 1;
+            end
+            if (m_wvalid && m_wready && m_wlast) begin
+                w_active <= 0;
+            end
+            if (b_pop) begin
+                bq_head <= bq_head + 1;
+            end
+            bq_count <= bq_count + aw_go - b_pop;
+        end
+    end
+
+endmodule
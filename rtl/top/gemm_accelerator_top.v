@@ -7,9 +7,11 @@ module gemm_accelerator_top #(
     parameter ACC_WIDTH = 32,
     parameter SCRATCHPAD_SIZE = 16384,
     parameter SCRATCHPAD_ADDR_WIDTH = 14,
-    parameter REG_ADDR_WIDTH = 8
+    parameter REG_ADDR_WIDTH = 8,
+    parameter AXI_DATA_WIDTH = 256     // Memory port width: 64, 128 or 256
 )(
-    input wire clk,
+    input wire clk,                    // Bus clock: registers, DMA, AXI
+    input wire compute_clk,            // Compute clock: MAC array, controller
     input wire rst_n,
     
     // RISC-V CPU interface
@@ -32,38 +34,50 @@ module gemm_accelerator_top #(
     output reg [31:0] mem_araddr,
     output reg [7:0] mem_arlen,
     output reg [2:0] mem_arsize,
+    output wire [3:0] mem_arqos,
     input wire mem_arready,
     
     output reg mem_rready,
     input wire mem_rvalid,
-    input wire [255:0] mem_rdata,
+    input wire [AXI_DATA_WIDTH-1:0] mem_rdata,
     input wire mem_rlast,
     
     output reg mem_awvalid,
     output reg [31:0] mem_awaddr,
     output reg [7:0] mem_awlen,
     output reg [2:0] mem_awsize,
+    output wire [3:0] mem_awqos,
     input wire mem_awready,
     
     output reg mem_wvalid,
-    output reg [255:0] mem_wdata,
+    output reg [AXI_DATA_WIDTH-1:0] mem_wdata,
+    output wire [AXI_DATA_WIDTH/8-1:0] mem_wstrb,
     output reg mem_wlast,
     input wire mem_wready,
     
     input wire mem_bvalid,
     output reg mem_bready,
     
+    // Cluster weight multicast (see cluster_interconnect)
+    output wire mem_armcast,           // AR sideband: read may be shared
+    output wire mcast_member,          // Multicast weights still to load
+    
     // Interrupt output
     output reg irq_out
 );
 
     // Internal signals
     wire accel_start, accel_reset, accel_irq_en;
-    wire accel_busy, accel_done, accel_error;
+    reg accel_busy, accel_done, accel_error;
     wire [31:0] matrix_a_addr, matrix_b_addr, matrix_c_addr;
     wire [15:0] m_dim, k_dim, n_dim;
     wire [7:0] data_type;
+    wire [3:0] weight_bits;
     wire [15:0] stride_a, stride_b, stride_c;
+    wire [3:0] pad_top, pad_bottom, pad_left, pad_right;
+    wire gather_en;
+    wire [31:0] gather_index_addr, gather_table_rows;
+    reg gather_error;
     
     // MAC array interface
     wire mac_enable, mac_clear_acc;
@@ -71,6 +85,13 @@ module gemm_accelerator_top #(
     wire [MAC_WIDTH*MAC_WIDTH*ACC_WIDTH-1:0] mac_accumulators;
     wire mac_valid_out;
     wire [2:0] mac_pipeline_stage;
+    wire [2:0] mac_weight_plane;
+    wire [MAC_WIDTH-1:0] mac_row_mask, mac_col_mask;
+    wire [MAC_WIDTH*8*DATA_WIDTH-1:0] mac_a_groups, mac_b_groups;
+    wire [6:0] mac_bnn_count;
+    
+    // Binary/ternary data types use the XNOR-popcount datapath
+    wire [1:0] bnn_mode = (data_type == 8'd2) ? 2'd1 : (data_type == 8'd3) ? 2'd2 : 2'd0;
     
     // Scratchpad interface
     wire scratchpad_wr_en;
@@ -82,19 +103,162 @@ module gemm_accelerator_top #(
     wire [SCRATCHPAD_ADDR_WIDTH-1:0] scratchpad_rd_addr;
     wire [255:0] scratchpad_rd_data;
     wire scratchpad_rd_valid;
+    wire scratchpad_rd_ready;
+    
+    // Scratchpad DMA port
+    wire dma_wr_en, dma_wr_ready;
+    wire [SCRATCHPAD_ADDR_WIDTH-1:0] dma_wr_addr;
+    wire [255:0] dma_wr_data;
+    wire dma_rd_en, dma_rd_valid, dma_rd_ready;
+    wire [SCRATCHPAD_ADDR_WIDTH-1:0] dma_rd_addr;
+    wire [255:0] dma_rd_data;
+    
+    // Scratchpad lines per buffer; addresses at the scratchpad are line indices
+    localparam SCRATCHPAD_LINES = SCRATCHPAD_SIZE * 8 / 256;
     
     // DMA interface
-    wire dma_start, dma_dir;
-    wire [31:0] dma_mem_addr;
-    wire [SCRATCHPAD_ADDR_WIDTH-1:0] dma_scratchpad_addr;
-    wire [15:0] dma_transfer_len, dma_stride;
+    reg dma_start, dma_dir;
+    reg [31:0] dma_mem_addr;
+    reg [SCRATCHPAD_ADDR_WIDTH-1:0] dma_scratchpad_addr;
+    reg [15:0] dma_transfer_len, dma_stride;
+    reg [15:0] dma_row_bytes;
+    reg [3:0] dma_pad_top, dma_pad_bottom;
+    reg [5:0] dma_pad_left, dma_pad_right;
+    reg dma_gather_en;
+    wire dma_gather_error;
+    reg dma_accumulate;
+    wire accum_en;                     // C += A*B: previous C is loaded and added on store
+    
+    // Output stage: bias row (loaded like the previous C), ReLU and int8
+    // requantization applied by the DMA as C is stored
+    wire out_bias_en, out_relu_en, out_requant_en;
+    wire [5:0] out_shift;
+    wire [7:0] out_zero_point, out_min, out_max;
+    wire [31:0] out_bias_addr, out_multiplier;
+    reg dma_out_stage;
+    
+    // Fused attention: A*B (Q*K^T) scores stay in the scratchpad, the
+    // softmax unit turns them into int8 P in place, and a second pass
+    // multiplies P by V (attn_seq_len x n_dim at attn_v_addr)
+    wire attn_en;
+    wire [3:0] attn_shift;
+    wire [15:0] attn_seq_len;
+    wire [31:0] attn_v_addr;
+    wire [15:0] attn_v_stride;
+    wire softmax_lut_wr;
+    wire [7:0] softmax_lut_index, softmax_lut_data;
+    reg attn_phase;                    // 0 = scores, 1 = P*V
+    reg softmax_start;
+    wire softmax_done;
+    wire softmax_active;               // Softmax unit owns the DMA scratchpad port
+    wire sm_rd_en, sm_wr_en;
+    wire [SCRATCHPAD_ADDR_WIDTH-1:0] sm_rd_addr, sm_wr_addr;
+    wire [255:0] sm_wr_data;
+    wire [15:0] job_k_dim = attn_phase ? attn_seq_len : k_dim;
+    wire [15:0] job_n_dim = (attn_en && !attn_phase) ? attn_seq_len : n_dim;
+    wire [15:0] job_stride_b = attn_phase ? attn_v_stride : stride_b;
+    wire [31:0] job_b_addr = attn_phase ? attn_v_addr : matrix_b_addr;
     wire dma_done, dma_busy;
     
+    // Output checksums (see abft_checker): int8 jobs whose A and B rows are
+    // whole scratchpad lines, with A rows of at most ABFT_MAX_ROW_LINES
+    localparam ABFT_MAX_ROW_LINES = 32;
+    localparam ERR_NONE = 4'd0;
+    localparam ERR_MMU_FAULT = 4'd1;
+    localparam ERR_INDEX = 4'd2;
+    localparam ERR_ABFT = 4'd3;
+    wire abft_en;
+    wire [15:0] abft_a_row_lines = (k_dim * DATA_WIDTH) / 256;
+    wire [15:0] abft_b_row_lines = (n_dim * DATA_WIDTH) / 256;
+    wire abft_eligible = abft_en && data_type == 8'd0 && weight_bits == 0 && !gather_en && !accum_en && !attn_en &&
+                         !out_bias_en && !out_relu_en && !out_requant_en &&
+                         {pad_top, pad_bottom, pad_left, pad_right} == 0 &&
+                         (k_dim * DATA_WIDTH) % 256 == 0 && (n_dim * DATA_WIDTH) % 256 == 0 &&
+                         abft_a_row_lines != 0 && abft_a_row_lines <= ABFT_MAX_ROW_LINES;
+    wire [31:0] abft_expected, abft_observed;
+    wire abft_mismatch;
+    reg abft_active;                   // This job is checked
+    reg abft_error;
+    reg [3:0] job_error_code;
+    
     // Matrix access controller interface
-    wire mac_controller_start;
+    reg mac_controller_start;
     wire mac_controller_done;
     wire [2:0] mac_controller_state;
     
+    // Compute clock domain: job configuration captured from the job FIFO
+    wire compute_rst_n;
+    reg [7:0] c_data_type;
+    reg [3:0] c_weight_bits;
+    reg [15:0] c_m_dim, c_k_dim, c_n_dim;
+    reg [15:0] c_stride_a, c_stride_b, c_stride_c;
+    reg [31:0] c_matrix_a_addr, c_matrix_b_addr, c_matrix_c_addr;
+    wire [1:0] c_bnn_mode = (c_data_type == 8'd2) ? 2'd1 : (c_data_type == 8'd3) ? 2'd2 : 2'd0;
+    
+    // Clock domain crossing between the bus and compute clocks
+    localparam JOB_WIDTH = 8 + 4 + 6*16 + 3*32;
+    reg compute_job_push;
+    wire compute_job_full, compute_job_empty;
+    wire [JOB_WIDTH-1:0] compute_job_data;
+    reg compute_active;
+    reg compute_done_d;
+    wire compute_finish;
+    wire compute_done_pulse;
+    
+    // AXI latency monitor interface
+    wire lat_mon_enable, lat_mon_clear;
+    wire [3:0] lat_mon_bin_shift;
+    wire lat_mon_sel_channel;
+    wire [3:0] lat_mon_sel_bin;
+    wire [31:0] lat_mon_sel_count;
+    wire [15:0] lat_mon_sel_max_latency;
+    
+    // DMA address translation interface
+    wire mmu_enable, mmu_tlb_flush, mmu_fault_clear;
+    wire [31:0] mmu_ptbr;
+    wire mmu_fault;
+    wire [31:0] mmu_fault_addr;
+    wire mcast_en;
+    wire dma_mcast;                    // DMA reads may be shared (B load)
+    
+    // DMA bandwidth regulation
+    wire [15:0] bw_window, bw_rd_bytes, bw_wr_bytes;
+    wire [3:0] axi_qos;
+    
+    // DMA memory interface (virtual addresses, before translation)
+    wire dma_m_arvalid, dma_m_arready;
+    wire [31:0] dma_m_araddr;
+    wire [7:0] dma_m_arlen;
+    wire [2:0] dma_m_arsize;
+    wire dma_m_armcast;
+    wire dma_m_rready, dma_m_rvalid, dma_m_rlast;
+    wire [255:0] dma_m_rdata;
+    wire dma_m_awvalid, dma_m_awready;
+    wire [31:0] dma_m_awaddr;
+    wire [7:0] dma_m_awlen;
+    wire [2:0] dma_m_awsize;
+    wire dma_m_wvalid, dma_m_wlast, dma_m_wready;
+    wire [255:0] dma_m_wdata;
+    wire [31:0] dma_m_wstrb;
+    wire dma_m_bvalid, dma_m_bready;
+    
+    // Translated memory interface in 256-bit lines, before width conversion
+    wire line_m_arvalid, line_m_arready;
+    wire [31:0] line_m_araddr;
+    wire [7:0] line_m_arlen;
+    wire [2:0] line_m_arsize;
+    wire line_m_armcast;
+    wire line_m_rready, line_m_rvalid, line_m_rlast;
+    wire [255:0] line_m_rdata;
+    wire line_m_awvalid, line_m_awready;
+    wire [31:0] line_m_awaddr;
+    wire [7:0] line_m_awlen;
+    wire [2:0] line_m_awsize;
+    wire line_m_wvalid, line_m_wlast, line_m_wready;
+    wire [255:0] line_m_wdata;
+    wire [31:0] line_m_wstrb;
+    wire line_m_bvalid, line_m_bready;
+    
     // Instantiate RISC-V interface
     riscv_interface riscv_if_inst (
         .clk(clk),
@@ -123,21 +287,79 @@ module gemm_accelerator_top #(
         .k_dim(k_dim),
         .n_dim(n_dim),
         .data_type(data_type),
+        .weight_bits(weight_bits),
         .stride_a(stride_a),
         .stride_b(stride_b),
         .stride_c(stride_c),
+        .pad_top(pad_top),
+        .pad_bottom(pad_bottom),
+        .pad_left(pad_left),
+        .pad_right(pad_right),
+        .gather_en(gather_en),
+        .gather_index_addr(gather_index_addr),
+        .gather_table_rows(gather_table_rows),
+        .gather_error(gather_error),
+        .abft_en(abft_en),
+        .abft_checked(abft_active),
+        .abft_error(abft_error),
+        .job_error_code(job_error_code),
+        .accum_en(accum_en),
+        .attn_en(attn_en),
+        .attn_shift(attn_shift),
+        .attn_seq_len(attn_seq_len),
+        .attn_v_addr(attn_v_addr),
+        .attn_v_stride(attn_v_stride),
+        .softmax_lut_wr(softmax_lut_wr),
+        .softmax_lut_index(softmax_lut_index),
+        .softmax_lut_data(softmax_lut_data),
+        .out_bias_en(out_bias_en),
+        .out_relu_en(out_relu_en),
+        .out_requant_en(out_requant_en),
+        .out_shift(out_shift),
+        .out_zero_point(out_zero_point),
+        .out_bias_addr(out_bias_addr),
+        .out_multiplier(out_multiplier),
+        .out_min(out_min),
+        .out_max(out_max),
+        .lat_mon_enable(lat_mon_enable),
+        .lat_mon_clear(lat_mon_clear),
+        .lat_mon_bin_shift(lat_mon_bin_shift),
+        .lat_mon_sel_channel(lat_mon_sel_channel),
+        .lat_mon_sel_bin(lat_mon_sel_bin),
+        .lat_mon_sel_count(lat_mon_sel_count),
+        .lat_mon_sel_max_latency(lat_mon_sel_max_latency),
+        .mmu_enable(mmu_enable),
+        .mmu_tlb_flush(mmu_tlb_flush),
+        .mmu_fault_clear(mmu_fault_clear),
+        .mmu_ptbr(mmu_ptbr),
+        .mmu_fault(mmu_fault),
+        .mmu_fault_addr(mmu_fault_addr),
+        .mcast_en(mcast_en),
+        .bw_window(bw_window),
+        .bw_rd_bytes(bw_rd_bytes),
+        .bw_wr_bytes(bw_wr_bytes),
+        .axi_qos(axi_qos),
         .irq_out(irq_out)
     );
     
     // Instantiate MAC array
     mac_array mac_array_inst (
-        .clk(clk),
-        .rst_n(rst_n),
+        .clk(compute_clk),
+        .rst_n(compute_rst_n),
         .enable(mac_enable),
-        .data_type(data_type),
+        .data_type(c_data_type),
         .clear_acc(mac_clear_acc),
+        .row_mask(mac_row_mask),
+        .col_mask(mac_col_mask),
         .matrix_a_row(mac_a_row),
         .matrix_b_col(mac_b_col),
+        .bit_serial(c_weight_bits != 0),
+        .weight_bits(c_weight_bits),
+        .weight_plane(mac_weight_plane),
+        .a_groups(mac_a_groups),
+        .bnn_mode(c_bnn_mode),
+        .bnn_count(mac_bnn_count),
+        .b_groups(mac_b_groups),
         .accumulators(mac_accumulators),
         .valid_out(mac_valid_out),
         .pipeline_stage(mac_pipeline_stage)
@@ -147,26 +369,54 @@ module gemm_accelerator_top #(
     scratchpad_sram scratchpad_inst (
         .clk(clk),
         .rst_n(rst_n),
+        .compute_clk(compute_clk),
+        .compute_rst_n(compute_rst_n),
         .buffer_select(1'b0), // Single buffer for now
         .buffer_swap(1'b0),
         .rd_en(scratchpad_rd_en),
         .rd_addr(scratchpad_rd_addr),
         .rd_data(scratchpad_rd_data),
         .rd_valid(scratchpad_rd_valid),
+        .rd_ready(scratchpad_rd_ready),
         .wr_en(scratchpad_wr_en),
         .wr_addr(scratchpad_wr_addr),
         .wr_data(scratchpad_wr_data),
+        .wr_be({32{1'b1}}),
         .wr_ready(scratchpad_wr_ready),
-        .dma_rd_en(dma_rd_en),
-        .dma_rd_addr(dma_rd_addr),
+        // The softmax stage borrows the DMA port between attention passes
+        .dma_rd_en(softmax_active ? sm_rd_en : dma_rd_en),
+        .dma_rd_addr(softmax_active ? sm_rd_addr : dma_rd_addr),
         .dma_rd_data(dma_rd_data),
         .dma_rd_valid(dma_rd_valid),
-        .dma_wr_en(dma_wr_en),
-        .dma_wr_addr(dma_wr_addr),
-        .dma_wr_data(dma_wr_data),
+        .dma_rd_ready(dma_rd_ready),
+        .dma_wr_en(softmax_active ? sm_wr_en : dma_wr_en),
+        .dma_wr_addr(softmax_active ? sm_wr_addr : dma_wr_addr),
+        .dma_wr_data(softmax_active ? sm_wr_data : dma_wr_data),
+        .dma_wr_be({32{1'b1}}),
         .dma_wr_ready(dma_wr_ready)
     );
     
+    // A read colliding with a write on the same port is not accepted, and
+    // none of the requesters here retry. They never need to: the compute
+    // controller and the DMA each read and write in different states, and
+    // the softmax stage only owns the DMA port between attention passes,
+    // while the DMA is idle. The checks flag any change that breaks this.
+    // synthesis translate_off
+    always @(posedge compute_clk) begin
+        if (compute_rst_n && scratchpad_rd_en && !scratchpad_rd_ready) begin
+            $display("ERROR: %m: compute read of line %0d collides with a write", scratchpad_rd_addr);
+        end
+    end
+    always @(posedge clk) begin
+        if (rst_n && (softmax_active ? sm_rd_en : dma_rd_en) && !dma_rd_ready) begin
+            $display("ERROR: %m: DMA port read collides with a write");
+        end
+        if (rst_n && softmax_active && (dma_rd_en || dma_wr_en)) begin
+            $display("ERROR: %m: DMA access while the softmax stage owns the port");
+        end
+    end
+    // synthesis translate_on
+    
     // Instantiate DMA engine
     dma_engine dma_inst (
         .clk(clk),
@@ -177,28 +427,53 @@ module gemm_accelerator_top #(
         .scratchpad_addr(dma_scratchpad_addr),
         .transfer_len(dma_transfer_len),
         .stride(dma_stride),
+        .row_bytes(dma_row_bytes),
+        .pad_top(dma_pad_top),
+        .pad_bottom(dma_pad_bottom),
+        .pad_left(dma_pad_left),
+        .pad_right(dma_pad_right),
+        .gather_en(dma_gather_en),
+        .index_addr(gather_index_addr),
+        .table_rows(gather_table_rows),
+        .accumulate(dma_accumulate),
+        .acc_scratchpad_addr(SCRATCHPAD_LINES/2),
+        .out_bias(dma_out_stage && out_bias_en),
+        .out_relu(dma_out_stage && out_relu_en),
+        .out_requant(dma_out_stage && out_requant_en),
+        .out_shift(out_shift),
+        .out_multiplier(out_multiplier),
+        .out_zero_point(out_zero_point),
+        .out_min(out_min),
+        .out_max(out_max),
+        .gather_error(dma_gather_error),
+        .bw_window(bw_window),
+        .bw_rd_bytes(bw_rd_bytes),
+        .bw_wr_bytes(bw_wr_bytes),
+        .mcast(dma_mcast),
         .dma_done(dma_done),
         .dma_busy(dma_busy),
-        .mem_arvalid(mem_arvalid),
-        .mem_araddr(mem_araddr),
-        .mem_arlen(mem_arlen),
-        .mem_arsize(mem_arsize),
-        .mem_arready(mem_arready),
-        .mem_rready(mem_rready),
-        .mem_rvalid(mem_rvalid),
-        .mem_rdata(mem_rdata),
-        .mem_rlast(mem_rlast),
-        .mem_awvalid(mem_awvalid),
-        .mem_awaddr(mem_awaddr),
-        .mem_awlen(mem_awlen),
-        .mem_awsize(mem_awsize),
-        .mem_awready(mem_awready),
-        .mem_wvalid(mem_wvalid),
-        .mem_wdata(mem_wdata),
-        .mem_wlast(mem_wlast),
-        .mem_wready(mem_wready),
-        .mem_bvalid(mem_bvalid),
-        .mem_bready(mem_bready),
+        .mem_arvalid(dma_m_arvalid),
+        .mem_araddr(dma_m_araddr),
+        .mem_arlen(dma_m_arlen),
+        .mem_arsize(dma_m_arsize),
+        .mem_armcast(dma_m_armcast),
+        .mem_arready(dma_m_arready),
+        .mem_rready(dma_m_rready),
+        .mem_rvalid(dma_m_rvalid),
+        .mem_rdata(dma_m_rdata),
+        .mem_rlast(dma_m_rlast),
+        .mem_awvalid(dma_m_awvalid),
+        .mem_awaddr(dma_m_awaddr),
+        .mem_awlen(dma_m_awlen),
+        .mem_awsize(dma_m_awsize),
+        .mem_awready(dma_m_awready),
+        .mem_wvalid(dma_m_wvalid),
+        .mem_wdata(dma_m_wdata),
+        .mem_wstrb(dma_m_wstrb),
+        .mem_wlast(dma_m_wlast),
+        .mem_wready(dma_m_wready),
+        .mem_bvalid(dma_m_bvalid),
+        .mem_bready(dma_m_bready),
         .scratchpad_wr_en(dma_wr_en),
         .scratchpad_wr_addr(dma_wr_addr),
         .scratchpad_wr_data(dma_wr_data),
@@ -209,20 +484,151 @@ module gemm_accelerator_top #(
         .scratchpad_rd_valid(dma_rd_valid)
     );
     
-    // Instantiate matrix access controller
-    matrix_access_controller mac_controller_inst (
+    // Instantiate DMA address translation unit
+    dma_mmu dma_mmu_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+        .enable(mmu_enable),
+        .tlb_flush(mmu_tlb_flush),
+        .fault_clear(mmu_fault_clear),
+        .ptbr(mmu_ptbr),
+        .fault(mmu_fault),
+        .fault_addr(mmu_fault_addr),
+        .s_arvalid(dma_m_arvalid),
+        .s_araddr(dma_m_araddr),
+        .s_arlen(dma_m_arlen),
+        .s_arsize(dma_m_arsize),
+        .s_armcast(dma_m_armcast),
+        .s_arready(dma_m_arready),
+        .s_rready(dma_m_rready),
+        .s_rvalid(dma_m_rvalid),
+        .s_rdata(dma_m_rdata),
+        .s_rlast(dma_m_rlast),
+        .s_awvalid(dma_m_awvalid),
+        .s_awaddr(dma_m_awaddr),
+        .s_awlen(dma_m_awlen),
+        .s_awsize(dma_m_awsize),
+        .s_awready(dma_m_awready),
+        .s_wvalid(dma_m_wvalid),
+        .s_wdata(dma_m_wdata),
+        .s_wstrb(dma_m_wstrb),
+        .s_wlast(dma_m_wlast),
+        .s_wready(dma_m_wready),
+        .s_bvalid(dma_m_bvalid),
+        .s_bready(dma_m_bready),
+        .m_arvalid(line_m_arvalid),
+        .m_araddr(line_m_araddr),
+        .m_arlen(line_m_arlen),
+        .m_arsize(line_m_arsize),
+        .m_armcast(line_m_armcast),
+        .m_arready(line_m_arready),
+        .m_rready(line_m_rready),
+        .m_rvalid(line_m_rvalid),
+        .m_rdata(line_m_rdata),
+        .m_rlast(line_m_rlast),
+        .m_awvalid(line_m_awvalid),
+        .m_awaddr(line_m_awaddr),
+        .m_awlen(line_m_awlen),
+        .m_awsize(line_m_awsize),
+        .m_awready(line_m_awready),
+        .m_wvalid(line_m_wvalid),
+        .m_wdata(line_m_wdata),
+        .m_wstrb(line_m_wstrb),
+        .m_wlast(line_m_wlast),
+        .m_wready(line_m_wready),
+        .m_bvalid(line_m_bvalid),
+        .m_bready(line_m_bready)
+    );
+    
+    // Instantiate AXI width converter between 256-bit lines and the memory port
+    axi_width_converter #(
+        .LINE_WIDTH(256),
+        .AXI_DATA_WIDTH(AXI_DATA_WIDTH)
+    ) axi_width_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+        .s_arvalid(line_m_arvalid),
+        .s_araddr(line_m_araddr),
+        .s_arlen(line_m_arlen),
+        .s_arsize(line_m_arsize),
+        .s_arready(line_m_arready),
+        .s_rready(line_m_rready),
+        .s_rvalid(line_m_rvalid),
+        .s_rdata(line_m_rdata),
+        .s_rlast(line_m_rlast),
+        .s_awvalid(line_m_awvalid),
+        .s_awaddr(line_m_awaddr),
+        .s_awlen(line_m_awlen),
+        .s_awsize(line_m_awsize),
+        .s_awready(line_m_awready),
+        .s_wvalid(line_m_wvalid),
+        .s_wdata(line_m_wdata),
+        .s_wstrb(line_m_wstrb),
+        .s_wlast(line_m_wlast),
+        .s_wready(line_m_wready),
+        .s_bvalid(line_m_bvalid),
+        .s_bready(line_m_bready),
+        .m_arvalid(mem_arvalid),
+        .m_araddr(mem_araddr),
+        .m_arlen(mem_arlen),
+        .m_arsize(mem_arsize),
+        .m_arready(mem_arready),
+        .m_rready(mem_rready),
+        .m_rvalid(mem_rvalid),
+        .m_rdata(mem_rdata),
+        .m_rlast(mem_rlast),
+        .m_awvalid(mem_awvalid),
+        .m_awaddr(mem_awaddr),
+        .m_awlen(mem_awlen),
+        .m_awsize(mem_awsize),
+        .m_awready(mem_awready),
+        .m_wvalid(mem_wvalid),
+        .m_wdata(mem_wdata),
+        .m_wstrb(mem_wstrb),
+        .m_wlast(mem_wlast),
+        .m_wready(mem_wready),
+        .m_bvalid(mem_bvalid),
+        .m_bready(mem_bready)
+    );
+    
+    // Instantiate AXI latency monitor on the DMA memory channels
+    axi_latency_monitor lat_mon_inst (
         .clk(clk),
         .rst_n(rst_n),
+        .enable(lat_mon_enable),
+        .clear(lat_mon_clear),
+        .bin_shift(lat_mon_bin_shift),
+        .ar_valid(mem_arvalid),
+        .ar_ready(mem_arready),
+        .r_valid(mem_rvalid),
+        .r_ready(mem_rready),
+        .r_last(mem_rlast),
+        .aw_valid(mem_awvalid),
+        .aw_ready(mem_awready),
+        .b_valid(mem_bvalid),
+        .b_ready(mem_bready),
+        .sel_channel(lat_mon_sel_channel),
+        .sel_bin(lat_mon_sel_bin),
+        .sel_count(lat_mon_sel_count),
+        .sel_max_latency(lat_mon_sel_max_latency)
+    );
+    
+    // Instantiate matrix access controller
+    matrix_access_controller mac_controller_inst (
+        .clk(compute_clk),
+        .rst_n(compute_rst_n),
         .start(mac_controller_start),
-        .m_dim(m_dim),
-        .k_dim(k_dim),
-        .n_dim(n_dim),
-        .stride_a(stride_a),
-        .stride_b(stride_b),
-        .stride_c(stride_c),
-        .matrix_a_base(matrix_a_addr),
-        .matrix_b_base(matrix_b_addr),
-        .matrix_c_base(matrix_c_addr),
+        .m_dim(c_m_dim),
+        .k_dim(c_k_dim),
+        .n_dim(c_n_dim),
+        .stride_a(c_stride_a),
+        .stride_b(c_stride_b),
+        .stride_c(c_stride_c),
+        .weight_bits(c_weight_bits),
+        .bnn_mode(c_bnn_mode),
+        .matrix_a_base(c_matrix_a_addr),
+        .matrix_b_base(c_matrix_b_addr),
+        .matrix_c_base(c_matrix_c_addr),
         .scratchpad_wr_en(scratchpad_wr_en),
         .scratchpad_wr_addr(scratchpad_wr_addr),
         .scratchpad_wr_data(scratchpad_wr_data),
@@ -234,10 +640,88 @@ module gemm_accelerator_top #(
         .mac_enable(mac_enable),
         .mac_a_row(mac_a_row),
         .mac_b_col(mac_b_col),
+        .mac_weight_plane(mac_weight_plane),
+        .mac_a_groups(mac_a_groups),
+        .mac_b_groups(mac_b_groups),
+        .mac_bnn_count(mac_bnn_count),
+        .mac_row_mask(mac_row_mask),
+        .mac_col_mask(mac_col_mask),
         .done(mac_controller_done),
         .state(mac_controller_state)
     );
     
+    // Compute domain reset: asserted with rst_n, released on compute_clk
+    cdc_reset_sync compute_rst_sync (
+        .clk(compute_clk),
+        .rst_n_in(rst_n),
+        .rst_n_out(compute_rst_n)
+    );
+    
+    // Job handoff: the bus domain pushes a snapshot of the job registers,
+    // the compute domain pops it into c_* registers and starts the
+    // controller the next cycle
+    async_fifo #(
+        .WIDTH(JOB_WIDTH),
+        .DEPTH(4)
+    ) compute_job_fifo (
+        .wr_clk(clk),
+        .wr_rst_n(rst_n),
+        .wr_en(compute_job_push),
+        .wr_data({data_type, weight_bits, m_dim, job_k_dim, job_n_dim,
+                  stride_a, job_stride_b, stride_c,
+                  matrix_a_addr, job_b_addr, matrix_c_addr}),
+        .full(compute_job_full),
+        .rd_clk(compute_clk),
+        .rd_rst_n(compute_rst_n),
+        .rd_en(!compute_active),
+        .rd_data(compute_job_data),
+        .empty(compute_job_empty)
+    );
+    
+    always @(posedge compute_clk or negedge compute_rst_n) begin
+        if (!compute_rst_n) begin
+            c_data_type <= 0;
+            c_weight_bits <= 0;
+            c_m_dim <= 0;
+            c_k_dim <= 0;
+            c_n_dim <= 0;
+            c_stride_a <= 0;
+            c_stride_b <= 0;
+            c_stride_c <= 0;
+            c_matrix_a_addr <= 0;
+            c_matrix_b_addr <= 0;
+            c_matrix_c_addr <= 0;
+            mac_controller_start <= 0;
+            compute_active <= 0;
+            compute_done_d <= 0;
+        end else begin
+            mac_controller_start <= 0;
+            compute_done_d <= mac_controller_done;
+            if (!compute_active && !compute_job_empty) begin
+                {c_data_type, c_weight_bits, c_m_dim, c_k_dim, c_n_dim,
+                 c_stride_a, c_stride_b, c_stride_c,
+                 c_matrix_a_addr, c_matrix_b_addr, c_matrix_c_addr} <= compute_job_data;
+                mac_controller_start <= 1;
+                compute_active <= 1;
+            end else if (compute_finish) begin
+                compute_active <= 0;
+            end
+        end
+    end
+    
+    // Completion handshake back to the bus domain; done stays high from the
+    // previous job until the controller restarts, so only its rising edge counts
+    assign compute_finish = compute_active && mac_controller_done && !compute_done_d;
+    
+    cdc_pulse compute_done_sync (
+        .src_clk(compute_clk),
+        .src_rst_n(compute_rst_n),
+        .src_pulse(compute_finish),
+        .dst_clk(clk),
+        .dst_rst_n(rst_n),
+        .dst_pulse(compute_done_pulse)
+    );
+    
     // Control logic
     reg [2:0] control_state;
     localparam IDLE = 3'b000;
@@ -246,15 +730,31 @@ module gemm_accelerator_top #(
     localparam COMPUTE = 3'b011;
     localparam STORE_MATRIX_C = 3'b100;
     localparam DONE = 3'b101;
+    localparam LOAD_MATRIX_C = 3'b110;
+    localparam SOFTMAX = 3'b111;
     
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             control_state <= IDLE;
-            mac_controller_start <= 0;
+            compute_job_push <= 0;
             dma_start <= 0;
+            dma_row_bytes <= 0;
+            dma_pad_top <= 0;
+            dma_pad_bottom <= 0;
+            dma_pad_left <= 0;
+            dma_pad_right <= 0;
+            dma_gather_en <= 0;
+            dma_accumulate <= 0;
+            dma_out_stage <= 0;
+            attn_phase <= 0;
+            softmax_start <= 0;
+            gather_error <= 0;
             accel_busy <= 0;
             accel_done <= 0;
             accel_error <= 0;
+            abft_active <= 0;
+            abft_error <= 0;
+            job_error_code <= ERR_NONE;
         end else begin
             case (control_state)
                 IDLE: begin
@@ -263,6 +763,11 @@ module gemm_accelerator_top #(
                         accel_busy <= 1;
                         accel_done <= 0;
                         accel_error <= 0;
+                        gather_error <= 0;
+                        attn_phase <= 0;
+                        abft_active <= abft_eligible;
+                        abft_error <= 0;
+                        job_error_code <= ERR_NONE;
                     end
                 end
                 
@@ -272,34 +777,109 @@ module gemm_accelerator_top #(
                     dma_dir <= 0; // mem to scratchpad
                     dma_mem_addr <= matrix_a_addr;
                     dma_scratchpad_addr <= 0;
-                    dma_transfer_len <= (m_dim * k_dim * DATA_WIDTH) / 256;
-                    dma_stride <= stride_a;
+                    if ({pad_top, pad_bottom, pad_left, pad_right} != 0 || gather_en ||
+                        (bnn_mode == 0 && stride_a != k_dim)) begin
+                        // Row-mode A: m_dim x k_dim includes any borders; only
+                        // interior rows are read (by index when gathering, from
+                        // the table at matrix_a_addr), the DMA generates the zeros.
+                        // Also used for a strided A, e.g. a column slice
+                        dma_transfer_len <= m_dim - pad_top - pad_bottom;
+                        dma_stride <= stride_a * (DATA_WIDTH/8);
+                        dma_row_bytes <= (k_dim - pad_left - pad_right) * (DATA_WIDTH/8);
+                        dma_pad_top <= pad_top;
+                        dma_pad_bottom <= pad_bottom;
+                        dma_pad_left <= pad_left * (DATA_WIDTH/8);
+                        dma_pad_right <= pad_right * (DATA_WIDTH/8);
+                        dma_gather_en <= gather_en;
+                    end else if (bnn_mode != 0) begin
+                        // Packed binary/ternary A: m_dim rows of stride_a bytes
+                        dma_transfer_len <= (m_dim * stride_a * 8) / 256;
+                        dma_stride <= 0;
+                        dma_row_bytes <= 0;
+                    end else begin
+                        dma_transfer_len <= (m_dim * k_dim * DATA_WIDTH) / 256;
+                        dma_stride <= 0;
+                        dma_row_bytes <= 0;
+                    end
                     
                     if (dma_done) begin
                         dma_start <= 0;
+                        gather_error <= dma_gather_error;
                         control_state <= LOAD_MATRIX_B;
                     end
                 end
                 
                 LOAD_MATRIX_B: begin
-                    // Configure DMA to load matrix B
+                    // Configure DMA to load matrix B (V in the P*V pass)
                     dma_start <= 1;
                     dma_dir <= 0; // mem to scratchpad
-                    dma_mem_addr <= matrix_b_addr;
-                    dma_scratchpad_addr <= SCRATCHPAD_SIZE/2; // Second half
-                    dma_transfer_len <= (k_dim * n_dim * DATA_WIDTH) / 256;
-                    dma_stride <= stride_b;
+                    dma_mem_addr <= job_b_addr;
+                    dma_scratchpad_addr <= SCRATCHPAD_LINES/2; // Second half
+                    if (bnn_mode != 0) begin
+                        // Packed binary/ternary B: one row of stride_b bytes
+                        // per output column
+                        dma_transfer_len <= (n_dim * stride_b * 8) / 256;
+                    end else if (weight_bits != 0) begin
+                        // Bit-serial B: weight_bits planes of n_dim bytes per
+                        // group of eight k rows, so traffic scales with precision
+                        dma_transfer_len <= (((k_dim + 7) >> 3) * weight_bits * n_dim * 8) / 256;
+                    end else begin
+                        dma_transfer_len <= (job_k_dim * job_n_dim * DATA_WIDTH) / 256;
+                    end
+                    dma_stride <= 0; // Whole lines; the DMA stride is a byte row pitch
+                    dma_row_bytes <= 0;
+                    dma_pad_top <= 0;
+                    dma_pad_bottom <= 0;
+                    dma_pad_left <= 0;
+                    dma_pad_right <= 0;
+                    dma_gather_en <= 0;
                     
                     if (dma_done) begin
                         dma_start <= 0;
                         control_state <= COMPUTE;
-                        mac_controller_start <= 1;
+                        compute_job_push <= 1;
                     end
                 end
                 
                 COMPUTE: begin
-                    mac_controller_start <= 0;
-                    if (mac_controller_done) begin
+                    compute_job_push <= 0;
+                    if (compute_done_pulse) begin
+                        if (attn_en && !attn_phase) begin
+                            control_state <= SOFTMAX;
+                            softmax_start <= 1;
+                        end else begin
+                            control_state <= (accum_en || out_bias_en) ? LOAD_MATRIX_C : STORE_MATRIX_C;
+                        end
+                    end
+                end
+                
+                SOFTMAX: begin
+                    // Scores at line 0 become int8 P rows in place, the A
+                    // operand of the P*V pass; V then replaces K^T
+                    softmax_start <= 0;
+                    if (softmax_done) begin
+                        attn_phase <= 1;
+                        control_state <= LOAD_MATRIX_B;
+                    end
+                end
+                
+                LOAD_MATRIX_C: begin
+                    // Accumulating job: load the previous C rows into the
+                    // B half, which is free once compute is done. Rows come
+                    // from index[m] when gathering, as the store goes there.
+                    // A biased job loads its one int32 bias row instead
+                    dma_start <= 1;
+                    dma_dir <= 0; // mem to scratchpad
+                    dma_mem_addr <= out_bias_en ? out_bias_addr : matrix_c_addr;
+                    dma_scratchpad_addr <= SCRATCHPAD_LINES/2;
+                    dma_transfer_len <= out_bias_en ? 16'd1 : m_dim;
+                    dma_stride <= stride_c * (ACC_WIDTH/8);
+                    dma_row_bytes <= n_dim * (ACC_WIDTH/8);
+                    dma_gather_en <= gather_en && !out_bias_en;
+                    
+                    if (dma_done) begin
+                        dma_start <= 0;
+                        gather_error <= gather_error || dma_gather_error;
                         control_state <= STORE_MATRIX_C;
                     end
                 end
@@ -309,12 +889,25 @@ module gemm_accelerator_top #(
                     dma_start <= 1;
                     dma_dir <= 1; // scratchpad to mem
                     dma_mem_addr <= matrix_c_addr;
-                    dma_scratchpad_addr <= 0; // Results stored here
-                    dma_transfer_len <= (m_dim * n_dim * DATA_WIDTH) / 256;
-                    dma_stride <= stride_c;
+                    dma_scratchpad_addr <= 0; // Results stored here, one line-aligned row each
+                    // C rows go to matrix_c_addr + m * stride_c, so C can be a
+                    // strided view (e.g. a column slice of a concat tensor);
+                    // the store coalescer merges rows into full bursts
+                    // Requantized C is int8, so stride_c is then in bytes
+                    dma_transfer_len <= m_dim;
+                    dma_stride <= out_requant_en ? stride_c : stride_c * (ACC_WIDTH/8);
+                    dma_row_bytes <= n_dim * (ACC_WIDTH/8);
+                    // Accumulating stores add the loaded C and, when
+                    // gathering, scatter row m back to index[m]
+                    dma_gather_en <= gather_en && accum_en;
+                    dma_accumulate <= accum_en;
+                    dma_out_stage <= 1;
                     
                     if (dma_done) begin
                         dma_start <= 0;
+                        dma_accumulate <= 0;
+                        dma_out_stage <= 0;
+                        gather_error <= gather_error || dma_gather_error;
                         control_state <= DONE;
                     end
                 end
@@ -322,13 +915,88 @@ module gemm_accelerator_top #(
                 DONE: begin
                     accel_busy <= 0;
                     accel_done <= 1;
+                    // Aborted transfer, bad index or corrupted result
+                    accel_error <= mmu_fault || gather_error || abft_mismatch;
+                    abft_error <= abft_mismatch;
+                    job_error_code <= mmu_fault ? ERR_MMU_FAULT :
+                                      gather_error ? ERR_INDEX :
+                                      abft_mismatch ? ERR_ABFT : ERR_NONE;
+                    attn_phase <= 0;
                     control_state <= IDLE;
                 end
             endcase
         end
     end
     
-    // MAC clear accumulator control
-    assign mac_clear_acc = (control_state == COMPUTE) && (mac_controller_state == 3'b000);
+    // Instantiate softmax unit for fused attention; scores are line-aligned
+    // int32 rows at line 0, as left by the compute pass
+    assign softmax_active = (control_state == SOFTMAX);
+    
+    softmax_unit #(
+        .LINE_WIDTH(256),
+        .ADDR_WIDTH(SCRATCHPAD_ADDR_WIDTH)
+    ) softmax_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+        .lut_wr_en(softmax_lut_wr),
+        .lut_wr_index(softmax_lut_index),
+        .lut_wr_data(softmax_lut_data),
+        .start(softmax_start),
+        .base_addr({SCRATCHPAD_ADDR_WIDTH{1'b0}}),
+        .rows(m_dim),
+        .cols(attn_seq_len),
+        .shift(attn_shift),
+        .done(softmax_done),
+        .busy(),
+        .scratchpad_rd_en(sm_rd_en),
+        .scratchpad_rd_addr(sm_rd_addr),
+        .scratchpad_rd_data(dma_rd_data),
+        .scratchpad_rd_valid(dma_rd_valid),
+        .scratchpad_wr_en(sm_wr_en),
+        .scratchpad_wr_addr(sm_wr_addr),
+        .scratchpad_wr_data(sm_wr_data),
+        .scratchpad_wr_ready(dma_wr_ready)
+    );
+    
+    // Instantiate output checksum unit; it watches the DMA side of the
+    // scratchpad, so checking adds no memory traffic or job latency
+    abft_checker #(
+        .LINE_WIDTH(256),
+        .ELEM_WIDTH(DATA_WIDTH),
+        .MAX_ROW_LINES(ABFT_MAX_ROW_LINES)
+    ) abft_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+        .start(control_state == IDLE && accel_start),
+        .a_row_lines(abft_a_row_lines),
+        .b_row_lines(abft_b_row_lines),
+        .n_dim(n_dim),
+        .load_a(abft_active && control_state == LOAD_MATRIX_A),
+        .load_b(abft_active && control_state == LOAD_MATRIX_B),
+        .store_c(abft_active && control_state == STORE_MATRIX_C),
+        .wr_valid(dma_wr_en),
+        .wr_data(dma_wr_data),
+        .rd_valid(dma_rd_valid),
+        .rd_data(dma_rd_data),
+        .expected(abft_expected),
+        .observed(abft_observed)
+    );
+    
+    assign abft_mismatch = abft_active && abft_expected != abft_observed;
+    
+    // Weight multicast: a subscribed job is a group member until its B load
+    // is done. The DMA flags its B data reads per transaction; page table
+    // walks go out unicast. The width converter passes AR through
+    // combinationally, so the flag stays aligned with it
+    assign mcast_member = mcast_en && (control_state == LOAD_MATRIX_A || control_state == LOAD_MATRIX_B);
+    assign dma_mcast = mcast_en && (control_state == LOAD_MATRIX_B);
+    assign mem_armcast = line_m_armcast;
+    
+    // One QoS level per job, including page table walks
+    assign mem_arqos = axi_qos;
+    assign mem_awqos = axi_qos;
+    
+    // MAC clear accumulator control (compute domain)
+    assign mac_clear_acc = compute_active && (mac_controller_state == 3'b000);
 
 endmodule
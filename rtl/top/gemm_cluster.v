@@ -0,0 +1,186 @@
+// GEMM Accelerator Cluster
+// NUM_CORES accelerator cores behind one memory port, with multicast
+// weight reads through cluster_interconnect
+
+module gemm_cluster #(
+    parameter NUM_CORES = 4,
+    parameter MAC_WIDTH = 8,
+    parameter DATA_WIDTH = 8,
+    parameter ACC_WIDTH = 32,
+    parameter REG_ADDR_WIDTH = 8,
+    parameter AXI_DATA_WIDTH = 256     // Shared memory port width
+)(
+    input wire clk,
+    input wire compute_clk,
+    input wire rst_n,
+    
+    // Per-core memory-mapped register interfaces (flattened)
+    input wire [NUM_CORES-1:0] reg_rd_en,
+    input wire [NUM_CORES-1:0] reg_wr_en,
+    input wire [NUM_CORES*REG_ADDR_WIDTH-1:0] reg_addr,
+    input wire [NUM_CORES*32-1:0] reg_wr_data,
+    output wire [NUM_CORES*32-1:0] reg_rd_data,
+    output wire [NUM_CORES-1:0] reg_rd_valid,
+    
+    // Shared memory interface
+    output wire mem_arvalid,
+    output wire [31:0] mem_araddr,
+    output wire [7:0] mem_arlen,
+    output wire [2:0] mem_arsize,
+    input wire mem_arready,
+    
+    output wire mem_rready,
+    input wire mem_rvalid,
+    input wire [AXI_DATA_WIDTH-1:0] mem_rdata,
+    input wire mem_rlast,
+    
+    output wire mem_awvalid,
+    output wire [31:0] mem_awaddr,
+    output wire [7:0] mem_awlen,
+    output wire [2:0] mem_awsize,
+    input wire mem_awready,
+    
+    output wire mem_wvalid,
+    output wire [AXI_DATA_WIDTH-1:0] mem_wdata,
+    output wire [AXI_DATA_WIDTH/8-1:0] mem_wstrb,
+    output wire mem_wlast,
+    input wire mem_wready,
+    
+    input wire mem_bvalid,
+    output wire mem_bready,
+    
+    // Multicast statistics
+    output wire [31:0] mcast_reads,
+    output wire [31:0] mcast_beats_saved,
+    
+    // Per-core interrupts
+    output wire [NUM_CORES-1:0] irq_out
+);
+
+    // Core memory ports
+    wire [NUM_CORES-1:0] core_arvalid, core_arready, core_armcast, core_member;
+    wire [NUM_CORES*32-1:0] core_araddr;
+    wire [NUM_CORES*8-1:0] core_arlen;
+    wire [NUM_CORES*3-1:0] core_arsize;
+    wire [NUM_CORES-1:0] core_rready, core_rvalid;
+    wire [AXI_DATA_WIDTH-1:0] core_rdata;
+    wire core_rlast;
+    wire [NUM_CORES-1:0] core_awvalid, core_awready;
+    wire [NUM_CORES*32-1:0] core_awaddr;
+    wire [NUM_CORES*8-1:0] core_awlen;
+    wire [NUM_CORES*3-1:0] core_awsize;
+    wire [NUM_CORES-1:0] core_wvalid, core_wlast, core_wready;
+    wire [NUM_CORES*AXI_DATA_WIDTH-1:0] core_wdata;
+    wire [NUM_CORES*AXI_DATA_WIDTH/8-1:0] core_wstrb;
+    wire [NUM_CORES-1:0] core_bvalid, core_bready;
+    
+    genvar c;
+    generate
+        for (c = 0; c < NUM_CORES; c = c + 1) begin : cores
+            gemm_accelerator_top #(
+                .MAC_WIDTH(MAC_WIDTH),
+                .DATA_WIDTH(DATA_WIDTH),
+                .ACC_WIDTH(ACC_WIDTH),
+                .REG_ADDR_WIDTH(REG_ADDR_WIDTH),
+                .AXI_DATA_WIDTH(AXI_DATA_WIDTH)
+            ) core (
+                .clk(clk),
+                .compute_clk(compute_clk),
+                .rst_n(rst_n),
+                .cpu_pc(32'h0),
+                .cpu_instruction(32'h0),
+                .cpu_valid(1'b0),
+                .cpu_ready(),
+                .cpu_result(),
+                .reg_rd_en(reg_rd_en[c]),
+                .reg_wr_en(reg_wr_en[c]),
+                .reg_addr(reg_addr[c*REG_ADDR_WIDTH +: REG_ADDR_WIDTH]),
+                .reg_wr_data(reg_wr_data[c*32 +: 32]),
+                .reg_rd_data(reg_rd_data[c*32 +: 32]),
+                .reg_rd_valid(reg_rd_valid[c]),
+                .mem_arvalid(core_arvalid[c]),
+                .mem_araddr(core_araddr[c*32 +: 32]),
+                .mem_arlen(core_arlen[c*8 +: 8]),
+                .mem_arsize(core_arsize[c*3 +: 3]),
+                .mem_arready(core_arready[c]),
+                .mem_rready(core_rready[c]),
+                .mem_rvalid(core_rvalid[c]),
+                .mem_rdata(core_rdata),
+                .mem_rlast(core_rlast),
+                .mem_awvalid(core_awvalid[c]),
+                .mem_awaddr(core_awaddr[c*32 +: 32]),
+                .mem_awlen(core_awlen[c*8 +: 8]),
+                .mem_awsize(core_awsize[c*3 +: 3]),
+                .mem_awready(core_awready[c]),
+                .mem_wvalid(core_wvalid[c]),
+                .mem_wdata(core_wdata[c*AXI_DATA_WIDTH +: AXI_DATA_WIDTH]),
+                .mem_wstrb(core_wstrb[c*AXI_DATA_WIDTH/8 +: AXI_DATA_WIDTH/8]),
+                .mem_wlast(core_wlast[c]),
+                .mem_wready(core_wready[c]),
+                .mem_bvalid(core_bvalid[c]),
+                .mem_bready(core_bready[c]),
+                .mem_arqos(), // Shared port arbitrates round-robin
+                .mem_awqos(),
+                .mem_armcast(core_armcast[c]),
+                .mcast_member(core_member[c]),
+                .irq_out(irq_out[c])
+            );
+        end
+    endgenerate
+    
+    // Shared memory port with multicast reads
+    cluster_interconnect #(
+        .NUM_CORES(NUM_CORES),
+        .DATA_WIDTH(AXI_DATA_WIDTH)
+    ) interconnect_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+        .mcast_member(core_member),
+        .s_arvalid(core_arvalid),
+        .s_araddr(core_araddr),
+        .s_arlen(core_arlen),
+        .s_arsize(core_arsize),
+        .s_armcast(core_armcast),
+        .s_arready(core_arready),
+        .s_rready(core_rready),
+        .s_rvalid(core_rvalid),
+        .s_rdata(core_rdata),
+        .s_rlast(core_rlast),
+        .s_awvalid(core_awvalid),
+        .s_awaddr(core_awaddr),
+        .s_awlen(core_awlen),
+        .s_awsize(core_awsize),
+        .s_awready(core_awready),
+        .s_wvalid(core_wvalid),
+        .s_wdata(core_wdata),
+        .s_wstrb(core_wstrb),
+        .s_wlast(core_wlast),
+        .s_wready(core_wready),
+        .s_bvalid(core_bvalid),
+        .s_bready(core_bready),
+        .m_arvalid(mem_arvalid),
+        .m_araddr(mem_araddr),
+        .m_arlen(mem_arlen),
+        .m_arsize(mem_arsize),
+        .m_arready(mem_arready),
+        .m_rready(mem_rready),
+        .m_rvalid(mem_rvalid),
+        .m_rdata(mem_rdata),
+        .m_rlast(mem_rlast),
+        .m_awvalid(mem_awvalid),
+        .m_awaddr(mem_awaddr),
+        .m_awlen(mem_awlen),
+        .m_awsize(mem_awsize),
+        .m_awready(mem_awready),
+        .m_wvalid(mem_wvalid),
+        .m_wdata(mem_wdata),
+        .m_wstrb(mem_wstrb),
+        .m_wlast(mem_wlast),
+        .m_wready(mem_wready),
+        .m_bvalid(mem_bvalid),
+        .m_bready(mem_bready),
+        .mcast_reads(mcast_reads),
+        .mcast_beats_saved(mcast_beats_saved)
+    );
+
+endmodule
@@ -0,0 +1,257 @@
+// Softmax Unit
+// LUT-based row softmax over int32 score rows held in the scratchpad, the
+// elementwise stage of a fused attention job
+//
+// Score row r (cols int32 lanes) starts at line base_addr + r * ceil(cols/8).
+// The int8 probabilities of row r are written in place to line
+// base_addr + r * ceil(cols/32), always at or below the score lines already
+// consumed, so P is left as line-aligned A rows for the P*V pass. Each row
+// is read three times:
+//   1. max of the row
+//   2. e = lut[min((max - s) >> shift, 255)], summed
+//   3. p = (e * recip) >> 16 with recip = floor(127 * 2^16 / sum)
+// so p <= 127 and a row sums to about 127. The LUT is loaded by software
+// (typically 255 * exp(-i / scale)); recip is formed by a serial divider.
+
+module softmax_unit #(
+    parameter LINE_WIDTH = 256,
+    parameter ADDR_WIDTH = 14
+)(
+    input wire clk,
+    input wire rst_n,
+
+    // Exponent table
+    input wire lut_wr_en,
+    input wire [7:0] lut_wr_index,
+    input wire [7:0] lut_wr_data,
+
+    // Job
+    input wire start,                  // Pulse; geometry sampled here
+    input wire [ADDR_WIDTH-1:0] base_addr,
+    input wire [15:0] rows,
+    input wire [15:0] cols,
+    input wire [3:0] shift,            // Score difference scale (right shift)
+    output reg done,                   // One-cycle pulse
+    output wire busy,
+
+    // Scratchpad port (one-cycle read latency)
+    output reg scratchpad_rd_en,
+    output reg [ADDR_WIDTH-1:0] scratchpad_rd_addr,
+    input wire [LINE_WIDTH-1:0] scratchpad_rd_data,
+    input wire scratchpad_rd_valid,
+    output reg scratchpad_wr_en,
+    output reg [ADDR_WIDTH-1:0] scratchpad_wr_addr,
+    output reg [LINE_WIDTH-1:0] scratchpad_wr_data,
+    input wire scratchpad_wr_ready
+);
+
+    localparam LANES = LINE_WIDTH / 32;        // Scores per line
+    localparam P_LANES = LINE_WIDTH / 8;       // Probabilities per line
+    localparam GROUP = P_LANES / LANES;        // Score lines per P line
+    localparam RECIP_NUM = 24'd127 << 16;
+
+    localparam S_IDLE = 3'd0;
+    localparam S_READ = 3'd1;
+    localparam S_WAIT = 3'd2;
+    localparam S_DIV = 3'd3;
+    localparam S_WRITE = 3'd4;
+
+    reg [7:0] lut [0:255];
+
+    reg [2:0] state;
+    reg [1:0] pass;                    // 0 = max, 1 = sum, 2 = normalize
+    reg [ADDR_WIDTH-1:0] base;
+    reg [15:0] num_rows, num_cols;
+    reg [3:0] diff_shift;
+    reg [15:0] row;
+    reg [15:0] line;
+    reg [ADDR_WIDTH-1:0] row_addr;     // First score line of the row
+    reg [ADDR_WIDTH-1:0] p_row_addr;   // First P line of the row
+    reg signed [31:0] row_max;
+    reg [31:0] row_sum;
+    reg [23:0] recip;
+    reg [32:0] div_rem;
+    reg [4:0] div_bit;
+    reg [LINE_WIDTH-1:0] pack;
+
+    wire [15:0] s_row_lines = (num_cols + LANES - 1) / LANES;
+    wire [15:0] p_row_lines = (num_cols + P_LANES - 1) / P_LANES;
+    wire last_line = (line == s_row_lines - 1);
+    wire group_end = last_line || (line % GROUP == GROUP - 1);
+
+    assign busy = (state != S_IDLE);
+
+    always @(posedge clk) begin
+        if (lut_wr_en) begin
+            lut[lut_wr_index] <= lut_wr_data;
+        end
+    end
+
+    // Per-lane max, exponent and probability of the line being read
+    reg signed [31:0] line_max;
+    reg [31:0] line_sum;
+    reg [8*LANES-1:0] line_p;
+    reg signed [31:0] score;
+    reg [31:0] diff;
+    reg [7:0] e;
+    reg [31:0] p_full;
+
+    integer i;
+    always @(*) begin
+        line_max = row_max;
+        line_sum = 0;
+        line_p = 0;
+        for (i = 0; i < LANES; i = i + 1) begin
+            score = scratchpad_rd_data[32*i +: 32];
+            diff = row_max - score;
+            e = ((diff >> diff_shift) > 255) ? lut[255] : lut[diff >> diff_shift];
+            p_full = (e * recip) >> 16;
+            if (line * LANES + i < num_cols) begin
+                if (score > line_max) begin
+                    line_max = score;
+                end
+                line_sum = line_sum + e;
+                line_p[8*i +: 8] = p_full[7:0];
+            end
+        end
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            state <= S_IDLE;
+            pass <= 0;
+            base <= 0;
+            num_rows <= 0;
+            num_cols <= 0;
+            diff_shift <= 0;
+            row <= 0;
+            line <= 0;
+            row_addr <= 0;
+            p_row_addr <= 0;
+            row_max <= 0;
+            row_sum <= 0;
+            recip <= 0;
+            div_rem <= 0;
+            div_bit <= 0;
+            pack <= 0;
+            done <= 0;
+            scratchpad_rd_en <= 0;
+            scratchpad_rd_addr <= 0;
+            scratchpad_wr_en <= 0;
+            scratchpad_wr_addr <= 0;
+            scratchpad_wr_data <= 0;
+        end else begin
+            done <= 0;
+            scratchpad_rd_en <= 0;
+            scratchpad_wr_en <= 0;
+
+            case (state)
+                S_IDLE: begin
+                    if (start) begin
+                        base <= base_addr;
+                        num_rows <= rows;
+                        num_cols <= cols;
+                        diff_shift <= shift;
+                        row <= 0;
+                        line <= 0;
+                        pass <= 0;
+                        row_addr <= base_addr;
+                        p_row_addr <= base_addr;
+                        row_max <= 32'sh80000000;
+                        pack <= 0;
+                        if (rows == 0 || cols == 0) begin
+                            done <= 1;
+                        end else begin
+                            state <= S_READ;
+                        end
+                    end
+                end
+
+                S_READ: begin
+                    scratchpad_rd_en <= 1;
+                    scratchpad_rd_addr <= row_addr + line;
+                    state <= S_WAIT;
+                end
+
+                S_WAIT: begin
+                    if (scratchpad_rd_valid) begin
+                        state <= S_READ;
+                        line <= last_line ? 16'd0 : line + 1;
+                        case (pass)
+                            2'd0: begin
+                                row_max <= line_max;
+                                if (last_line) begin
+                                    pass <= 1;
+                                    row_sum <= 0;
+                                end
+                            end
+                            2'd1: begin
+                                row_sum <= row_sum + line_sum;
+                                if (last_line) begin
+                                    div_rem <= 0;
+                                    div_bit <= 23;
+                                    recip <= 0;
+                                    state <= S_DIV;
+                                end
+                            end
+                            default: begin
+                                pack[8*LANES*(line % GROUP) +: 8*LANES] <= line_p;
+                                if (group_end) begin
+                                    state <= S_WRITE;
+                                end
+                            end
+                        endcase
+                    end
+                end
+
+                S_DIV: begin
+                    // Restoring division, one quotient bit per cycle
+                    if (row_sum == 0) begin
+                        recip <= 0;
+                        pass <= 2;
+                        state <= S_READ;
+                    end else begin
+                        if ({div_rem[31:0], RECIP_NUM[div_bit]} >= row_sum) begin
+                            div_rem <= {div_rem[31:0], RECIP_NUM[div_bit]} - row_sum;
+                            recip[div_bit] <= 1;
+                        end else begin
+                            div_rem <= {div_rem[31:0], RECIP_NUM[div_bit]};
+                        end
+                        if (div_bit == 0) begin
+                            pass <= 2;
+                            state <= S_READ;
+                        end else begin
+                            div_bit <= div_bit - 1;
+                        end
+                    end
+                end
+
+                S_WRITE: begin
+                    if (scratchpad_wr_ready) begin
+                        scratchpad_wr_en <= 1;
+                        // line already points past the group just packed
+                        scratchpad_wr_addr <= p_row_addr + (line == 0 ? p_row_lines - 1 : line / GROUP - 1);
+                        scratchpad_wr_data <= pack;
+                        pack <= 0;
+                        state <= S_READ;
+                        if (line == 0) begin
+                            // Row complete
+                            pass <= 0;
+                            row_max <= 32'sh80000000;
+                            row_addr <= row_addr + s_row_lines;
+                            p_row_addr <= p_row_addr + p_row_lines;
+                            row <= row + 1;
+                            if (row == num_rows - 1) begin
+                                done <= 1;
+                                state <= S_IDLE;
+                            end
+                        end
+                    end
+                end
+
+                default: state <= S_IDLE;
+            endcase
+        end
+    end
+
+endmodule
@@ -6,12 +6,26 @@
 #include <string.h>
 
 // Memory-mapped register access macros
-#define REG_READ(addr)          (*(volatile uint32_t*)(addr))
-#define REG_WRITE(addr, val)   (*(volatile uint32_t*)(addr) = (val))
+#ifdef GEMM_ACCEL_DEVICE_MODEL
+// Host builds route register accesses to the C device model
+#include "gemm_device_model.h"
+#define REG_READ(addr)          gemm_model_reg_read(gemm_model_instance(current_instance), (addr) - GEMM_ACCEL_BASE_ADDR)
+#define REG_WRITE(addr, val)    gemm_model_reg_write(gemm_model_instance(current_instance), (addr) - GEMM_ACCEL_BASE_ADDR, (val))
+#else
+#define INSTANCE_ADDR(addr)     ((uintptr_t)(addr) + (uintptr_t)current_instance * GEMM_ACCEL_INSTANCE_STRIDE)
+#define REG_READ(addr)          (*(volatile uint32_t*)(uintptr_t)INSTANCE_ADDR(addr))
+#define REG_WRITE(addr, val)    (*(volatile uint32_t*)(uintptr_t)INSTANCE_ADDR(addr) = (val))
+#endif
+
+// Scratchpad lines of a buffer of 'bytes' bytes
+#define SCRATCHPAD_LINES_FOR(bytes) (((bytes) + GEMM_SCRATCHPAD_LINE_BYTES - 1) / GEMM_SCRATCHPAD_LINE_BYTES)
 
 // Global variables
 static bool driver_initialized = false;
+static uint8_t current_instance = 0;
+static gemm_bw_class_t job_classes[GEMM_NUM_JOB_CLASSES];
 static uint32_t cycle_count_start = 0;
+static gemm_mem_profile_t* mem_profile = NULL;
 
 // Initialize the GEMM accelerator
 int gemm_accel_init(void) {
@@ -56,11 +70,111 @@ int gemm_accel_start(const gemm_config_t* config) {
         return -1;
     }
     
-    if (config->data_type > GEMM_DATA_TYPE_INT16) {
+    if (config->data_type > GEMM_DATA_TYPE_TERNARY) {
         printf("ERROR: Invalid data type\n");
         return -1;
     }
     
+    bool bnn = config->data_type == GEMM_DATA_TYPE_BINARY || config->data_type == GEMM_DATA_TYPE_TERNARY;
+    if (bnn) {
+        uint16_t row_bytes = gemm_bnn_row_bytes(config->k_dim, config->data_type);
+        if (config->stride_a < row_bytes || config->stride_b < row_bytes ||
+            (config->stride_a | config->stride_b) % 8 != 0) {
+            printf("ERROR: Packed row pitch must cover %d bytes in 8-byte words\n", row_bytes);
+            return -1;
+        }
+        if (config->pad_top || config->pad_bottom || config->pad_left || config->pad_right ||
+            config->gather_table_rows != 0 || config->accumulate) {
+            printf("ERROR: Padding, gather and accumulate need int8 or int16 data\n");
+            return -1;
+        }
+    }
+    
+    if (config->weight_bits != 0 &&
+        (config->weight_bits < GEMM_WEIGHT_BITS_MIN || config->weight_bits > GEMM_WEIGHT_BITS_MAX ||
+         config->data_type != GEMM_DATA_TYPE_INT8)) {
+        printf("ERROR: Bit-serial weights must be %d-%d bits with int8 data\n",
+               GEMM_WEIGHT_BITS_MIN, GEMM_WEIGHT_BITS_MAX);
+        return -1;
+    }
+    
+    if (config->stride_c < config->n_dim || config->stride_c > GEMM_MAX_STRIDE_C) {
+        printf("ERROR: Invalid output stride\n");
+        return -1;
+    }
+    
+    bool padded = config->pad_top || config->pad_bottom || config->pad_left || config->pad_right;
+    if (padded) {
+        if (config->pad_top > GEMM_PAD_MAX || config->pad_bottom > GEMM_PAD_MAX ||
+            config->pad_left > GEMM_PAD_MAX || config->pad_right > GEMM_PAD_MAX) {
+            printf("ERROR: Padding exceeds %d\n", GEMM_PAD_MAX);
+            return -1;
+        }
+        if (config->pad_top + config->pad_bottom >= config->m_dim ||
+            config->pad_left + config->pad_right >= config->k_dim) {
+            printf("ERROR: Padding leaves no interior\n");
+            return -1;
+        }
+    }
+    
+    if (config->gather_table_rows != 0 && (config->gather_index_addr & 3) != 0) {
+        printf("ERROR: Gather index array must be 4-byte aligned\n");
+        return -1;
+    }
+    
+    // Scattered accumulation takes C rows from index[m], which padded jobs
+    // would offset by pad_top
+    if (config->accumulate && config->gather_table_rows != 0 && padded) {
+        printf("ERROR: Gathered accumulation cannot be padded\n");
+        return -1;
+    }
+    
+    if (config->job_class >= GEMM_NUM_JOB_CLASSES) {
+        printf("ERROR: Invalid job class\n");
+        return -1;
+    }
+    
+    if (config->attn_seq_len != 0) {
+        if (config->data_type != GEMM_DATA_TYPE_INT8 || config->weight_bits != 0 || padded ||
+            config->gather_table_rows != 0 || config->accumulate) {
+            printf("ERROR: Attention needs a plain int8 job\n");
+            return -1;
+        }
+        if (config->attn_shift > GEMM_ATTN_SHIFT_MAX) {
+            printf("ERROR: Score shift exceeds %d\n", GEMM_ATTN_SHIFT_MAX);
+            return -1;
+        }
+        // Scores and P*V results are line-aligned int32 rows in the A half;
+        // K^T and V each replace the other in the B half
+        uint32_t score_lines = (uint32_t)config->m_dim * SCRATCHPAD_LINES_FOR(config->attn_seq_len * 4);
+        uint32_t out_lines = (uint32_t)config->m_dim * SCRATCHPAD_LINES_FOR(config->n_dim * 4);
+        if (score_lines > GEMM_SCRATCHPAD_HALF_LINES || out_lines > GEMM_SCRATCHPAD_HALF_LINES ||
+            SCRATCHPAD_LINES_FOR((uint32_t)config->m_dim * config->k_dim) > GEMM_SCRATCHPAD_HALF_LINES ||
+            SCRATCHPAD_LINES_FOR((uint32_t)config->k_dim * config->attn_seq_len) > GEMM_SCRATCHPAD_HALF_LINES ||
+            SCRATCHPAD_LINES_FOR((uint32_t)config->attn_seq_len * config->n_dim) > GEMM_SCRATCHPAD_HALF_LINES) {
+            printf("ERROR: Attention block exceeds the scratchpad\n");
+            return -1;
+        }
+    }
+    
+    bool out_stage = config->out_bias || config->out_relu || config->out_requant;
+    if (out_stage) {
+        // The bias row is loaded where accumulation keeps the previous C
+        if (bnn || config->accumulate || config->attn_seq_len != 0) {
+            printf("ERROR: Output stage needs a plain int8 or int16 job\n");
+            return -1;
+        }
+        if (config->out_requant &&
+            (config->out_shift > GEMM_OUTPUT_SHIFT_MAX || config->out_min > config->out_max)) {
+            printf("ERROR: Invalid requantization\n");
+            return -1;
+        }
+        if (config->out_bias && (config->out_bias_addr & 3) != 0) {
+            printf("ERROR: Bias must be 4-byte aligned\n");
+            return -1;
+        }
+    }
+    
     // Configure registers
     REG_WRITE(GEMM_MATRIX_A_ADDR_REG, config->matrix_a_addr);
     REG_WRITE(GEMM_MATRIX_B_ADDR_REG, config->matrix_b_addr);
@@ -68,10 +182,34 @@ int gemm_accel_start(const gemm_config_t* config) {
     REG_WRITE(GEMM_M_DIM_REG, config->m_dim);
     REG_WRITE(GEMM_K_DIM_REG, config->k_dim);
     REG_WRITE(GEMM_N_DIM_REG, config->n_dim);
-    REG_WRITE(GEMM_DATA_TYPE_REG, config->data_type);
+    REG_WRITE(GEMM_DATA_TYPE_REG, config->data_type | (config->weight_bits << GEMM_WEIGHT_BITS_POS));
     REG_WRITE(GEMM_STRIDE_A_REG, config->stride_a);
     REG_WRITE(GEMM_STRIDE_B_REG, config->stride_b);
     REG_WRITE(GEMM_STRIDE_C_REG, config->stride_c);
+    REG_WRITE(GEMM_PAD_REG, config->pad_top | (config->pad_bottom << 4) |
+                            (config->pad_left << 8) | (config->pad_right << 12));
+    REG_WRITE(GEMM_GATHER_INDEX_ADDR_REG, config->gather_index_addr);
+    REG_WRITE(GEMM_GATHER_NUM_ROWS_REG, config->gather_table_rows);
+    REG_WRITE(GEMM_GATHER_CTRL_REG, config->gather_table_rows != 0 ? GEMM_GATHER_CTRL_ENABLE : 0);
+    REG_WRITE(GEMM_ACCUM_CTRL_REG, config->accumulate ? GEMM_ACCUM_CTRL_ENABLE : 0);
+    REG_WRITE(GEMM_ATTN_CTRL_REG, config->attn_seq_len != 0 ?
+              GEMM_ATTN_CTRL_ENABLE | ((uint32_t)config->attn_shift << GEMM_ATTN_SHIFT_POS) |
+              ((uint32_t)config->attn_seq_len << GEMM_ATTN_SEQ_POS) : 0);
+    REG_WRITE(GEMM_ATTN_V_ADDR_REG, config->attn_v_addr);
+    REG_WRITE(GEMM_ATTN_V_STRIDE_REG, config->attn_v_stride);
+    REG_WRITE(GEMM_OUTPUT_CTRL_REG, (config->out_bias ? GEMM_OUTPUT_CTRL_BIAS : 0) |
+              (config->out_relu ? GEMM_OUTPUT_CTRL_RELU : 0) |
+              (config->out_requant ? GEMM_OUTPUT_CTRL_REQUANT : 0) |
+              ((uint32_t)config->out_shift << GEMM_OUTPUT_SHIFT_POS) |
+              ((uint32_t)(uint8_t)config->out_zero_point << GEMM_OUTPUT_ZERO_POS));
+    REG_WRITE(GEMM_OUTPUT_BIAS_ADDR_REG, config->out_bias_addr);
+    REG_WRITE(GEMM_OUTPUT_MULT_REG, (uint32_t)config->out_multiplier);
+    REG_WRITE(GEMM_OUTPUT_CLAMP_REG, (uint8_t)config->out_min |
+              ((uint32_t)(uint8_t)config->out_max << GEMM_OUTPUT_MAX_POS));
+    
+    const gemm_bw_class_t* bw = &job_classes[config->job_class];
+    REG_WRITE(GEMM_BW_CTRL_REG, bw->window_cycles | ((uint32_t)bw->qos << GEMM_BW_QOS_POS));
+    REG_WRITE(GEMM_BW_BUDGET_REG, bw->read_bytes | ((uint32_t)bw->write_bytes << GEMM_BW_WR_BYTES_POS));
     
     // Start operation
     REG_WRITE(GEMM_CTRL_REG, GEMM_CTRL_START);
@@ -79,9 +217,21 @@ int gemm_accel_start(const gemm_config_t* config) {
     // Record start time for performance measurement
     cycle_count_start = gemm_accel_get_cycle_count();
     
+    if (mem_profile != NULL) {
+        // Occupancy is per job: the next start replaces it
+        uint32_t scratchpad = gemm_accel_job_scratchpad_bytes(config);
+        mem_profile->current[GEMM_MEM_SCRATCHPAD] = 0;
+        gemm_mem_profile_alloc(GEMM_MEM_SCRATCHPAD, scratchpad);
+        if (mem_profile->max_samples != 0) {
+            memcpy(mem_profile->samples[mem_profile->jobs % mem_profile->max_samples].bytes,
+                   mem_profile->current, sizeof(mem_profile->current));
+        }
+        mem_profile->jobs++;
+    }
+    
+    static const char* const type_names[] = {"int8", "int16", "binary", "ternary"};
     printf("GEMM operation started: %dx%dx%d, type=%s\n", 
-           config->m_dim, config->k_dim, config->n_dim,
-           config->data_type == GEMM_DATA_TYPE_INT8 ? "int8" : "int16");
+           config->m_dim, config->k_dim, config->n_dim, type_names[config->data_type]);
     
     return 0;
 }
@@ -100,6 +250,15 @@ int gemm_accel_wait(void) {
     
     // Check for errors
     if (gemm_accel_has_error()) {
+        if (gemm_accel_mmu_has_fault()) {
+            printf("ERROR: DMA translation fault at 0x%08x\n", gemm_accel_mmu_fault_addr());
+        }
+        if (REG_READ(GEMM_STATUS_REG) & GEMM_STATUS_INDEX_ERROR) {
+            printf("ERROR: Gather index out of range\n");
+        }
+        if (REG_READ(GEMM_STATUS_REG) & GEMM_STATUS_ABFT_ERROR) {
+            printf("ERROR: Output checksum mismatch\n");
+        }
         printf("ERROR: GEMM operation failed\n");
         return -1;
     }
@@ -170,6 +329,64 @@ void gemm_accel_set_interrupt_enable(bool enable) {
     REG_WRITE(GEMM_CTRL_REG, ctrl);
 }
 
+// Share matrix B reads with the other subscribed cores of a cluster
+void gemm_accel_set_weight_multicast(bool enable) {
+    REG_WRITE(GEMM_MCAST_CTRL_REG, enable ? GEMM_MCAST_CTRL_ENABLE : 0);
+}
+
+// Set the DMA bandwidth budget and AXI QoS used by jobs of a class
+int gemm_accel_set_job_class(uint8_t job_class, const gemm_bw_class_t* bw) {
+    if (bw == NULL) {
+        printf("ERROR: NULL bandwidth class\n");
+        return -1;
+    }
+    
+    if (job_class >= GEMM_NUM_JOB_CLASSES || bw->qos > GEMM_BW_QOS_MAX) {
+        printf("ERROR: Invalid job class or QoS\n");
+        return -1;
+    }
+    
+    // A zero budget would stall the DMA for good
+    if (bw->window_cycles != 0 && (bw->read_bytes == 0 || bw->write_bytes == 0)) {
+        printf("ERROR: Regulated class needs read and write budgets\n");
+        return -1;
+    }
+    
+    job_classes[job_class] = *bw;
+    return 0;
+}
+
+// Verify eligible jobs' results against checksums of their operands
+void gemm_accel_set_abft(bool enable) {
+    REG_WRITE(GEMM_ABFT_CTRL_REG, enable ? GEMM_ABFT_CTRL_ENABLE : 0);
+}
+
+// Error code of the last completed job (GEMM_ERR_*)
+uint8_t gemm_accel_error_code(void) {
+    return REG_READ(GEMM_ERROR_CODE_REG) & GEMM_ERR_CODE_MASK;
+}
+
+// Whether the last job's result was verified by the checksum unit
+bool gemm_accel_abft_checked(void) {
+    return (REG_READ(GEMM_ERROR_CODE_REG) & GEMM_ERR_ABFT_CHECKED) != 0;
+}
+
+// Direct register accesses to another accelerator instance
+int gemm_accel_select_instance(uint8_t instance) {
+    if (instance >= GEMM_ACCEL_MAX_INSTANCES) {
+        printf("ERROR: Invalid accelerator instance %d\n", instance);
+        return -1;
+    }
+    
+    current_instance = instance;
+    return 0;
+}
+
+// Instance addressed by register accesses
+uint8_t gemm_accel_current_instance(void) {
+    return current_instance;
+}
+
 // Get cycle count (placeholder - would read from cycle counter register)
 uint32_t gemm_accel_get_cycle_count(void) {
     // This would typically read from a cycle counter register
@@ -179,6 +396,953 @@ uint32_t gemm_accel_get_cycle_count(void) {
     return cycle_count;
 }
 
+// Configure the AXI latency monitor
+int gemm_accel_latency_monitor_config(bool enable, uint8_t bin_shift) {
+    if (bin_shift > 15) {
+        printf("ERROR: Invalid latency bin shift\n");
+        return -1;
+    }
+    
+    uint32_t ctrl = (uint32_t)bin_shift << GEMM_LAT_CTRL_SHIFT_POS;
+    if (enable) {
+        ctrl |= GEMM_LAT_CTRL_ENABLE;
+    }
+    REG_WRITE(GEMM_LAT_CTRL_REG, ctrl);
+    return 0;
+}
+
+// Clear latency histograms and maxima, keeping the current configuration
+void gemm_accel_latency_monitor_clear(void) {
+    uint32_t ctrl = REG_READ(GEMM_LAT_CTRL_REG);
+    REG_WRITE(GEMM_LAT_CTRL_REG, ctrl | GEMM_LAT_CTRL_CLEAR);
+}
+
+// Read the latency histogram of one AXI channel
+int gemm_accel_read_latency_histogram(uint8_t channel, gemm_latency_hist_t* hist) {
+    if (hist == NULL) {
+        printf("ERROR: NULL histogram\n");
+        return -1;
+    }
+    
+    if (channel > GEMM_LAT_CHANNEL_WRITE) {
+        printf("ERROR: Invalid latency channel\n");
+        return -1;
+    }
+    
+    uint32_t sel_channel = (channel == GEMM_LAT_CHANNEL_WRITE) ? GEMM_LAT_SEL_WRITE : 0;
+    for (int bin = 0; bin < GEMM_LAT_NUM_BINS; bin++) {
+        REG_WRITE(GEMM_LAT_SEL_REG, sel_channel | (uint32_t)bin);
+        hist->bins[bin] = REG_READ(GEMM_LAT_BIN_REG);
+    }
+    hist->max_latency = REG_READ(GEMM_LAT_MAX_REG);
+    hist->bin_shift = (REG_READ(GEMM_LAT_CTRL_REG) >> GEMM_LAT_CTRL_SHIFT_POS) & 0xF;
+    
+    return 0;
+}
+
+// Upper bound (exclusive, in cycles) of a latency bin
+static uint32_t latency_bin_limit(const gemm_latency_hist_t* hist, int bin) {
+    return (1u << bin) << hist->bin_shift;
+}
+
+// First bin covering the given percentile of transactions
+static int latency_percentile(const gemm_latency_hist_t* hist, uint32_t total, int percent) {
+    uint64_t target = ((uint64_t)total * percent + 99) / 100;
+    uint64_t seen = 0;
+    
+    for (int bin = 0; bin < GEMM_LAT_NUM_BINS; bin++) {
+        seen += hist->bins[bin];
+        if (seen >= target) {
+            return bin;
+        }
+    }
+    return GEMM_LAT_NUM_BINS - 1;
+}
+
+// Print the bound of a bin: "< limit", or ">= lower bound" for the last
+// bin, which has no upper limit
+static void latency_print_bound(const gemm_latency_hist_t* hist, int bin) {
+    if (bin == GEMM_LAT_NUM_BINS - 1) {
+        printf(">= %u", latency_bin_limit(hist, bin - 1));
+    } else {
+        printf("< %u", latency_bin_limit(hist, bin));
+    }
+}
+
+// Print a summary of read and write latency distributions
+void gemm_accel_print_latency_summary(void) {
+    const char* names[2] = {"Read (AR->R)", "Write (AW->B)"};
+    
+    for (uint8_t channel = GEMM_LAT_CHANNEL_READ; channel <= GEMM_LAT_CHANNEL_WRITE; channel++) {
+        gemm_latency_hist_t hist;
+        if (gemm_accel_read_latency_histogram(channel, &hist) != 0) {
+            return;
+        }
+        
+        uint32_t total = 0;
+        for (int bin = 0; bin < GEMM_LAT_NUM_BINS; bin++) {
+            total += hist.bins[bin];
+        }
+        
+        printf("%s latency: %u transactions", names[channel], total);
+        if (total == 0) {
+            printf("\n");
+            continue;
+        }
+        static const int percents[3] = {50, 90, 99};
+        for (int i = 0; i < 3; i++) {
+            printf(", p%d ", percents[i]);
+            latency_print_bound(&hist, latency_percentile(&hist, total, percents[i]));
+        }
+        printf(", max %u cycles\n", hist.max_latency);
+        
+        for (int bin = 0; bin < GEMM_LAT_NUM_BINS; bin++) {
+            if (hist.bins[bin] == 0) {
+                continue;
+            }
+            if (bin == GEMM_LAT_NUM_BINS - 1) {
+                printf("  >= %5u cycles: %u\n", latency_bin_limit(&hist, bin - 1), hist.bins[bin]);
+            } else {
+                printf("  < %6u cycles: %u\n", latency_bin_limit(&hist, bin), hist.bins[bin]);
+            }
+        }
+    }
+}
+
+// Scratchpad bytes a job occupies: A (or scores) and results share the
+// first half, B (or K^T, then V) the second
+uint32_t gemm_accel_job_scratchpad_bytes(const gemm_config_t* config) {
+    uint32_t m = config->m_dim, k = config->k_dim, n = config->n_dim;
+    uint32_t elem = config->data_type == GEMM_DATA_TYPE_INT16 ? 2 : 1;
+    uint32_t a_lines = SCRATCHPAD_LINES_FOR(m * k * elem);
+    uint32_t b_lines = SCRATCHPAD_LINES_FOR(k * n * elem);
+    uint32_t c_lines = m * SCRATCHPAD_LINES_FOR(n * 4);
+    
+    if (config->data_type == GEMM_DATA_TYPE_BINARY || config->data_type == GEMM_DATA_TYPE_TERNARY) {
+        a_lines = SCRATCHPAD_LINES_FOR(m * config->stride_a);
+        b_lines = SCRATCHPAD_LINES_FOR(n * config->stride_b);
+    } else if (config->weight_bits != 0) {
+        b_lines = SCRATCHPAD_LINES_FOR(gemm_packed_weights_size(k, n, config->weight_bits));
+    }
+    if (config->attn_seq_len != 0) {
+        uint32_t seq = config->attn_seq_len;
+        uint32_t score_lines = m * SCRATCHPAD_LINES_FOR(seq * 4);
+        uint32_t v_lines = SCRATCHPAD_LINES_FOR(seq * n);
+        a_lines = a_lines > score_lines ? a_lines : score_lines;
+        b_lines = SCRATCHPAD_LINES_FOR(k * seq);
+        b_lines = b_lines > v_lines ? b_lines : v_lines;
+    }
+    
+    uint32_t first_half = a_lines > c_lines ? a_lines : c_lines;
+    return (first_half + b_lines) * GEMM_SCRATCHPAD_LINE_BYTES;
+}
+
+// Start recording into prof (limits may be set afterwards); the scratchpad
+// limit is its capacity
+void gemm_mem_profile_start(gemm_mem_profile_t* prof, const char* name,
+                            gemm_mem_sample_t* samples, uint32_t max_samples) {
+    memset(prof, 0, sizeof(*prof));
+    prof->name = name;
+    prof->samples = samples;
+    prof->max_samples = samples != NULL ? max_samples : 0;
+    prof->limit[GEMM_MEM_SCRATCHPAD] = 2 * GEMM_SCRATCHPAD_HALF_LINES * GEMM_SCRATCHPAD_LINE_BYTES;
+    mem_profile = prof;
+}
+
+// Stop recording; the profile keeps its contents
+void gemm_mem_profile_stop(void) {
+    mem_profile = NULL;
+}
+
+// Account bytes of a kind taken or released (no-op without a profile)
+void gemm_mem_profile_alloc(uint8_t kind, uint32_t bytes) {
+    if (mem_profile == NULL || kind >= GEMM_MEM_KINDS) {
+        return;
+    }
+    mem_profile->current[kind] += bytes;
+    if (mem_profile->current[kind] > mem_profile->peak[kind]) {
+        mem_profile->peak[kind] = mem_profile->current[kind];
+    }
+}
+
+void gemm_mem_profile_free(uint8_t kind, uint32_t bytes) {
+    if (mem_profile == NULL || kind >= GEMM_MEM_KINDS) {
+        return;
+    }
+    mem_profile->current[kind] -= bytes < mem_profile->current[kind] ? bytes : mem_profile->current[kind];
+}
+
+// Print peak use against the limits, then the per-job timeline
+void gemm_mem_profile_report(const gemm_mem_profile_t* prof) {
+    const char* names[GEMM_MEM_KINDS] = {"DMA buffers", "Arena (accelerator)", "Scratchpad"};
+    
+    printf("Memory footprint of %s: %u jobs\n", prof->name != NULL ? prof->name : "model", prof->jobs);
+    for (uint8_t kind = 0; kind < GEMM_MEM_KINDS; kind++) {
+        printf("  %-20s peak %8u bytes", names[kind], prof->peak[kind]);
+        uint32_t limit = prof->limit[kind];
+        if (limit != 0) {
+            printf(" of %8u (%3u%%), headroom %u", limit,
+                   (uint32_t)((uint64_t)prof->peak[kind] * 100 / limit),
+                   limit > prof->peak[kind] ? limit - prof->peak[kind] : 0);
+        }
+        printf("\n");
+    }
+    
+    uint32_t count = prof->jobs < prof->max_samples ? prof->jobs : prof->max_samples;
+    if (count == 0) {
+        return;
+    }
+    printf("  %8s %12s %12s %12s\n", "job", "dma", "arena", "scratchpad");
+    for (uint32_t i = prof->jobs - count; i < prof->jobs; i++) {
+        const uint32_t* bytes = prof->samples[i % prof->max_samples].bytes;
+        printf("  %8u %12u %12u %12u\n", i, bytes[GEMM_MEM_DMA], bytes[GEMM_MEM_ARENA],
+               bytes[GEMM_MEM_SCRATCHPAD]);
+    }
+}
+
+// Initialize an empty page table from caller-provided table pages
+int gemm_accel_mmu_init_table(gemm_page_table_t* pt,
+                              uint32_t* l1_table, uint32_t l1_phys,
+                              uint32_t* l0_pool, uint32_t l0_pool_phys,
+                              uint16_t l0_pool_pages) {
+    if (pt == NULL || l1_table == NULL || l0_pool == NULL) {
+        printf("ERROR: NULL page table\n");
+        return -1;
+    }
+    
+    if ((l1_phys | l0_pool_phys) & (GEMM_MMU_PAGE_SIZE - 1)) {
+        printf("ERROR: Page tables must be 4KB aligned\n");
+        return -1;
+    }
+    
+    pt->l1_table = l1_table;
+    pt->l1_phys = l1_phys;
+    pt->l0_pool = l0_pool;
+    pt->l0_pool_phys = l0_pool_phys;
+    pt->l0_pool_pages = l0_pool_pages;
+    pt->l0_used = 0;
+    memset(l1_table, 0, GEMM_MMU_PAGE_SIZE);
+    
+    return 0;
+}
+
+// CPU view of the L0 table referenced by an L1 entry
+static uint32_t* mmu_l0_table(const gemm_page_table_t* pt, uint32_t l1_entry) {
+    uint32_t index = ((l1_entry & ~(GEMM_MMU_PAGE_SIZE - 1)) - pt->l0_pool_phys) / GEMM_MMU_PAGE_SIZE;
+    return pt->l0_pool + index * GEMM_MMU_PTES_PER_TABLE;
+}
+
+// Map a virtually contiguous range onto scattered physical pages
+int gemm_accel_mmu_map(gemm_page_table_t* pt, uint32_t iova,
+                       const uint32_t* page_phys, uint32_t num_pages, bool writable) {
+    if (pt == NULL || page_phys == NULL) {
+        printf("ERROR: NULL mapping\n");
+        return -1;
+    }
+    
+    if (iova & (GEMM_MMU_PAGE_SIZE - 1)) {
+        printf("ERROR: IOVA must be page aligned\n");
+        return -1;
+    }
+    
+    for (uint32_t i = 0; i < num_pages; i++) {
+        uint32_t va = iova + i * GEMM_MMU_PAGE_SIZE;
+        uint32_t* l1_entry = &pt->l1_table[va >> 22];
+        
+        // Allocate an L0 table on first use of this 4MB region
+        if (!(*l1_entry & GEMM_PTE_VALID)) {
+            if (pt->l0_used >= pt->l0_pool_pages) {
+                printf("ERROR: Page table pool exhausted\n");
+                return -1;
+            }
+            uint32_t l0_phys = pt->l0_pool_phys + pt->l0_used * GEMM_MMU_PAGE_SIZE;
+            memset(pt->l0_pool + pt->l0_used * GEMM_MMU_PTES_PER_TABLE, 0, GEMM_MMU_PAGE_SIZE);
+            pt->l0_used++;
+            *l1_entry = l0_phys | GEMM_PTE_VALID;
+        }
+        
+        uint32_t* l0_table = mmu_l0_table(pt, *l1_entry);
+        l0_table[(va >> 12) & (GEMM_MMU_PTES_PER_TABLE - 1)] =
+            (page_phys[i] & ~(GEMM_MMU_PAGE_SIZE - 1)) |
+            GEMM_PTE_VALID | (writable ? GEMM_PTE_WRITABLE : 0);
+    }
+    
+    return 0;
+}
+
+// Remove a mapping and drop any cached translations
+void gemm_accel_mmu_unmap(gemm_page_table_t* pt, uint32_t iova, uint32_t num_pages) {
+    if (pt == NULL) {
+        return;
+    }
+    
+    for (uint32_t i = 0; i < num_pages; i++) {
+        uint32_t va = iova + i * GEMM_MMU_PAGE_SIZE;
+        uint32_t l1_entry = pt->l1_table[va >> 22];
+        if (l1_entry & GEMM_PTE_VALID) {
+            mmu_l0_table(pt, l1_entry)[(va >> 12) & (GEMM_MMU_PTES_PER_TABLE - 1)] = 0;
+        }
+    }
+    
+    gemm_accel_mmu_flush_tlb();
+}
+
+// Point the walker at a page table and enable translation
+int gemm_accel_mmu_enable(const gemm_page_table_t* pt) {
+    if (pt == NULL) {
+        printf("ERROR: NULL page table\n");
+        return -1;
+    }
+    
+    REG_WRITE(GEMM_MMU_PTBR_REG, pt->l1_phys);
+    REG_WRITE(GEMM_MMU_CTRL_REG, GEMM_MMU_CTRL_ENABLE | GEMM_MMU_CTRL_TLB_FLUSH |
+                                 GEMM_MMU_CTRL_FAULT_CLR);
+    return 0;
+}
+
+// Return to physical addressing
+void gemm_accel_mmu_disable(void) {
+    REG_WRITE(GEMM_MMU_CTRL_REG, GEMM_MMU_CTRL_TLB_FLUSH | GEMM_MMU_CTRL_FAULT_CLR);
+}
+
+// Invalidate all cached translations
+void gemm_accel_mmu_flush_tlb(void) {
+    uint32_t ctrl = REG_READ(GEMM_MMU_CTRL_REG) & GEMM_MMU_CTRL_ENABLE;
+    REG_WRITE(GEMM_MMU_CTRL_REG, ctrl | GEMM_MMU_CTRL_TLB_FLUSH);
+}
+
+// Check for a translation fault
+bool gemm_accel_mmu_has_fault(void) {
+    return (REG_READ(GEMM_STATUS_REG) & GEMM_STATUS_MMU_FAULT) != 0;
+}
+
+// Virtual address of the last translation fault
+uint32_t gemm_accel_mmu_fault_addr(void) {
+    return REG_READ(GEMM_MMU_FAULT_ADDR_REG);
+}
+
+// Point the output of a configured GEMM at a view into a larger tensor
+int gemm_accel_set_output_view(gemm_config_t* config, const gemm_output_view_t* view) {
+    if (config == NULL || view == NULL) {
+        printf("ERROR: NULL output view\n");
+        return -1;
+    }
+    
+    if ((uint32_t)view->col_offset + config->n_dim > view->row_pitch ||
+        view->row_pitch > GEMM_MAX_STRIDE_C) {
+        printf("ERROR: Output view does not fit parent row\n");
+        return -1;
+    }
+    
+    config->matrix_c_addr = view->base_addr +
+        ((uint32_t)view->row_offset * view->row_pitch + view->col_offset) * sizeof(int32_t);
+    config->stride_c = view->row_pitch;
+    return 0;
+}
+
+// Bytes of packed B for a k_dim x n_dim weight matrix
+uint32_t gemm_packed_weights_size(uint16_t k_dim, uint16_t n_dim, uint8_t weight_bits) {
+    uint32_t groups = (k_dim + GEMM_WEIGHT_GROUP - 1) / GEMM_WEIGHT_GROUP;
+    return groups * weight_bits * n_dim;
+}
+
+// Pack int8 B (row pitch stride_b) into bit-planes for the bit-serial mode.
+// For each group of eight k rows and each bit i, one plane row of n_dim
+// bytes follows: bit j of byte n is bit i of B[8g+j][n]. Missing rows of the
+// last group are zero; the top plane is the two's complement sign.
+int gemm_pack_weights(const int8_t* b, uint16_t k_dim, uint16_t n_dim, uint16_t stride_b,
+                      uint8_t weight_bits, uint8_t* packed) {
+    if (b == NULL || packed == NULL) {
+        printf("ERROR: NULL weight buffer\n");
+        return -1;
+    }
+    
+    if (weight_bits < GEMM_WEIGHT_BITS_MIN || weight_bits > GEMM_WEIGHT_BITS_MAX) {
+        printf("ERROR: Invalid weight precision %d\n", weight_bits);
+        return -1;
+    }
+    
+    int lo = -(1 << (weight_bits - 1));
+    int hi = (1 << (weight_bits - 1)) - 1;
+    
+    memset(packed, 0, gemm_packed_weights_size(k_dim, n_dim, weight_bits));
+    for (uint32_t k = 0; k < k_dim; k++) {
+        uint8_t* group = packed + (k / GEMM_WEIGHT_GROUP) * weight_bits * n_dim;
+        for (uint32_t n = 0; n < n_dim; n++) {
+            int w = b[k * stride_b + n];
+            if (w < lo || w > hi) {
+                printf("ERROR: Weight %d at (%u, %u) does not fit %d bits\n", w, k, n, weight_bits);
+                return -1;
+            }
+            for (uint32_t i = 0; i < weight_bits; i++) {
+                if (((uint32_t)w >> i) & 1) {
+                    group[i * n_dim + n] |= 1 << (k % GEMM_WEIGHT_GROUP);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// Bytes per packed binary/ternary row: whole 64-bit words
+uint16_t gemm_bnn_row_bytes(uint16_t k_dim, uint8_t data_type) {
+    uint32_t per_word = data_type == GEMM_DATA_TYPE_TERNARY ?
+                        GEMM_BNN_TERNARY_PER_WORD : GEMM_BNN_BINARY_PER_WORD;
+    return (k_dim + per_word - 1) / per_word * 8;
+}
+
+// Pack rows of int8 values for the XNOR-popcount mode. Element k of row r is
+// src[r * row_step + k * k_step], so A (row_step = stride, k_step = 1) and
+// B (row_step = 1, k_step = stride, one row per column) use the same call.
+// Binary: bit k of the row is set for values >= 0 (+1), clear for -1.
+// Ternary: in each 8-byte word covering 32 k, bytes 0-3 hold sign bits
+// (set for -1) and bytes 4-7 nonzero bits; values must be -1, 0 or +1.
+int gemm_pack_bnn(const int8_t* src, uint16_t rows, uint16_t k_dim,
+                  uint32_t row_step, uint32_t k_step, uint8_t data_type, uint8_t* packed) {
+    if (src == NULL || packed == NULL) {
+        printf("ERROR: NULL binary/ternary buffer\n");
+        return -1;
+    }
+    
+    if (data_type != GEMM_DATA_TYPE_BINARY && data_type != GEMM_DATA_TYPE_TERNARY) {
+        printf("ERROR: Invalid binary/ternary data type %d\n", data_type);
+        return -1;
+    }
+    
+    uint16_t row_bytes = gemm_bnn_row_bytes(k_dim, data_type);
+    memset(packed, 0, (uint32_t)rows * row_bytes);
+    for (uint32_t r = 0; r < rows; r++) {
+        uint8_t* row = packed + r * row_bytes;
+        for (uint32_t k = 0; k < k_dim; k++) {
+            int v = src[r * row_step + k * k_step];
+            if (data_type == GEMM_DATA_TYPE_BINARY) {
+                if (v >= 0) {
+                    row[k / 8] |= 1 << (k % 8);
+                }
+            } else {
+                if (v < -1 || v > 1) {
+                    printf("ERROR: Ternary value %d at (%u, %u)\n", v, r, k);
+                    return -1;
+                }
+                uint8_t* word = row + (k / GEMM_BNN_TERNARY_PER_WORD) * 8;
+                uint32_t bit = k % GEMM_BNN_TERNARY_PER_WORD;
+                if (v != 0) {
+                    word[4 + bit / 8] |= 1 << (bit % 8);
+                }
+                if (v < 0) {
+                    word[bit / 8] |= 1 << (bit % 8);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// Start an empty layer pipeline
+void gemm_pipeline_init(gemm_pipeline_t* pipe, gemm_pipeline_forward_fn forward, void* ctx) {
+    memset(pipe, 0, sizeof(*pipe));
+    pipe->forward = forward;
+    pipe->forward_ctx = ctx;
+}
+
+// Append the next layer; its A buffers are fed from the previous stage
+int gemm_pipeline_add_stage(gemm_pipeline_t* pipe, const gemm_pipeline_stage_t* stage) {
+    if (pipe == NULL || stage == NULL) {
+        printf("ERROR: NULL pipeline stage\n");
+        return -1;
+    }
+    
+    if (pipe->num_stages >= GEMM_PIPELINE_MAX_STAGES) {
+        printf("ERROR: Pipeline exceeds %d stages\n", GEMM_PIPELINE_MAX_STAGES);
+        return -1;
+    }
+    
+    if (stage->instance >= GEMM_ACCEL_MAX_INSTANCES) {
+        printf("ERROR: Invalid accelerator instance %d\n", stage->instance);
+        return -1;
+    }
+    
+    if (pipe->num_stages > 0) {
+        const gemm_config_t* prev = &pipe->stages[pipe->num_stages - 1].layer;
+        if (stage->layer.m_dim != prev->m_dim || stage->layer.k_dim != prev->n_dim) {
+            printf("ERROR: Stage %d input is not %dx%d\n", pipe->num_stages, prev->m_dim, prev->n_dim);
+            return -1;
+        }
+    }
+    
+    pipe->stages[pipe->num_stages++] = *stage;
+    return 0;
+}
+
+// Poll a running stage; on completion forward its output and release the
+// slots it held
+static int pipeline_retire(gemm_pipeline_t* pipe, uint8_t s) {
+    uint8_t last = pipe->num_stages - 1;
+    
+    gemm_accel_select_instance(pipe->stages[s].instance);
+    if (gemm_accel_is_busy()) {
+        return 0;
+    }
+    
+    pipe->running[s] = false;
+    if (gemm_accel_has_error()) {
+        printf("ERROR: Pipeline stage %d failed on inference %u\n", s, pipe->completed[s]);
+        return -1;
+    }
+    
+    uint8_t slot = pipe->completed[s] % GEMM_PIPELINE_SLOTS;
+    pipe->completed[s]++;
+    if (s < last) {
+        if (pipe->forward != NULL && pipe->forward(s, slot, pipe->forward_ctx) != 0) {
+            printf("ERROR: Forwarding stage %d output failed\n", s);
+            return -1;
+        }
+        pipe->full[s]++;
+    }
+    if (s > 0) {
+        pipe->empty[s - 1]++;
+    }
+    return 0;
+}
+
+// Start the next inference of a stage once its input slot is full and its
+// output slot empty
+static int pipeline_issue(gemm_pipeline_t* pipe, uint8_t s, const uint32_t* input_addrs,
+                          const uint32_t* output_addrs) {
+    uint8_t last = pipe->num_stages - 1;
+    const gemm_pipeline_stage_t* stage = &pipe->stages[s];
+    
+    if ((s > 0 && pipe->full[s - 1] == 0) || (s < last && pipe->empty[s] == 0)) {
+        return 0;
+    }
+    
+    // Stages sharing an instance take turns
+    for (uint8_t t = 0; t < pipe->num_stages; t++) {
+        if (pipe->running[t] && pipe->stages[t].instance == stage->instance) {
+            return 0;
+        }
+    }
+    
+    uint32_t i = pipe->issued[s];
+    uint8_t slot = i % GEMM_PIPELINE_SLOTS;
+    gemm_config_t config = stage->layer;
+    config.matrix_a_addr = s == 0 ? input_addrs[i] : stage->in_addr[slot];
+    config.matrix_c_addr = s == last ? output_addrs[i] : stage->out_addr[slot];
+    
+    gemm_accel_select_instance(stage->instance);
+    if (gemm_accel_start(&config) != 0) {
+        return -1;
+    }
+    
+    if (s > 0) {
+        pipe->full[s - 1]--;
+    }
+    if (s < last) {
+        pipe->empty[s]--;
+    }
+    pipe->issued[s]++;
+    pipe->running[s] = true;
+    return 0;
+}
+
+// Stream count inferences through the pipeline. In steady state every stage
+// works on a different inference, so a new result completes per slowest
+// stage time rather than per whole-model time.
+int gemm_pipeline_run(gemm_pipeline_t* pipe, const uint32_t* input_addrs,
+                      const uint32_t* output_addrs, uint32_t count) {
+    if (!driver_initialized) {
+        printf("ERROR: Driver not initialized\n");
+        return -1;
+    }
+    
+    if (pipe == NULL || input_addrs == NULL || output_addrs == NULL) {
+        printf("ERROR: NULL pipeline buffers\n");
+        return -1;
+    }
+    
+    if (pipe->num_stages == 0) {
+        printf("ERROR: Empty pipeline\n");
+        return -1;
+    }
+    
+    uint8_t last = pipe->num_stages - 1;
+    uint8_t saved_instance = current_instance;
+    bool reset_done[GEMM_ACCEL_MAX_INSTANCES] = {false};
+    int result = 0;
+    
+    for (uint8_t s = 0; s < pipe->num_stages; s++) {
+        uint8_t instance = pipe->stages[s].instance;
+        if (!reset_done[instance]) {
+            gemm_accel_select_instance(instance);
+            gemm_accel_reset();
+            reset_done[instance] = true;
+        }
+        pipe->full[s] = 0;
+        pipe->empty[s] = GEMM_PIPELINE_SLOTS;
+        pipe->issued[s] = 0;
+        pipe->completed[s] = 0;
+        pipe->running[s] = false;
+    }
+    
+    while (pipe->completed[last] < count) {
+        // Downstream first, so slots freed this pass are reused at once
+        for (int s = last; s >= 0; s--) {
+            if (pipe->running[s] && pipeline_retire(pipe, s) != 0) {
+                result = -1;
+                break;
+            }
+            if (!pipe->running[s] && pipe->issued[s] < count &&
+                pipeline_issue(pipe, s, input_addrs, output_addrs) != 0) {
+                result = -1;
+                break;
+            }
+        }
+        if (result != 0) {
+            break;
+        }
+    }
+    
+    // Let jobs still in flight after an error drain before returning
+    for (uint8_t s = 0; s < pipe->num_stages; s++) {
+        if (pipe->running[s]) {
+            gemm_accel_select_instance(pipe->stages[s].instance);
+            while (gemm_accel_is_busy()) {
+                // Wait
+            }
+            pipe->running[s] = false;
+        }
+    }
+    
+    current_instance = saved_instance;
+    if (result == 0) {
+        printf("Pipeline completed %u inferences over %d stages\n", count, pipe->num_stages);
+    }
+    return result;
+}
+
+// Set up delta updates of base's C; call gemm_delta_update with the first A
+int gemm_delta_init(gemm_delta_t* delta, const gemm_config_t* base,
+                    int8_t* prev_a, int8_t* table, uint32_t table_phys,
+                    uint32_t* rows, uint32_t rows_phys) {
+    if (delta == NULL || base == NULL || prev_a == NULL || table == NULL || rows == NULL) {
+        printf("ERROR: NULL delta buffers\n");
+        return -1;
+    }
+    
+    if (base->data_type != GEMM_DATA_TYPE_INT8 || base->pad_top || base->pad_bottom ||
+        base->pad_left || base->pad_right || base->gather_table_rows != 0 || base->accumulate ||
+        base->attn_seq_len != 0 || base->out_bias || base->out_relu || base->out_requant) {
+        printf("ERROR: Delta updates need a plain int8 job\n");
+        return -1;
+    }
+    
+    if (base->stride_a < base->k_dim || (rows_phys & 3) != 0) {
+        printf("ERROR: Invalid delta table layout\n");
+        return -1;
+    }
+    
+    memset(delta, 0, sizeof(*delta));
+    delta->base = *base;
+    delta->prev_a = prev_a;
+    delta->delta = table;
+    delta->delta_phys = table_phys;
+    delta->rows = rows;
+    delta->rows_phys = rows_phys;
+    return 0;
+}
+
+// Part of an element change applied by residual pass 'pass'
+static int8_t delta_part(int32_t diff, uint8_t pass) {
+    for (uint8_t p = 0; ; p++) {
+        int32_t part = diff > 127 ? 127 : (diff < -128 ? -128 : diff);
+        if (p == pass) {
+            return (int8_t)part;
+        }
+        diff -= part;
+    }
+}
+
+// Bring C up to date with a_new (m_dim x stride_a, CPU view). Only changed
+// rows of A are read and only their rows of C are rewritten; unchanged
+// inputs issue no job at all.
+int gemm_delta_update(gemm_delta_t* delta, const int8_t* a_new) {
+    const gemm_config_t* base = &delta->base;
+    bool primed = delta->primed;
+    uint16_t count = 0;
+    
+    for (uint16_t m = 0; m < base->m_dim; m++) {
+        uint32_t row = (uint32_t)m * base->stride_a;
+        if (!primed || memcmp(a_new + row, delta->prev_a + row, base->k_dim) != 0) {
+            delta->rows[count++] = m;
+        }
+    }
+    delta->changed_rows = count;
+    delta->passes = 0;
+    
+    // Differences of up to +-255 are applied in clamped int8 parts; each
+    // pass only lists the rows that still have a nonzero part. An unprimed
+    // update keeps every row (zero rows must clear C too) and runs as one
+    // plain job, since gathered rows only scatter when accumulating.
+    for (uint8_t pass = 0; count != 0 && pass < GEMM_DELTA_MAX_PASSES; pass++) {
+        uint16_t live = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            uint32_t m = delta->rows[i];
+            uint32_t row = m * base->stride_a;
+            bool nonzero = false;
+            for (uint16_t k = 0; k < base->k_dim; k++) {
+                int32_t diff = a_new[row + k] - (primed ? delta->prev_a[row + k] : 0);
+                delta->delta[row + k] = delta_part(diff, pass);
+                nonzero |= delta->delta[row + k] != 0;
+            }
+            if (nonzero || (!primed && pass == 0)) {
+                delta->rows[live++] = m;
+            }
+        }
+        count = live;
+        if (count == 0) {
+            break;
+        }
+        
+        gemm_config_t job = *base;
+        job.matrix_a_addr = delta->delta_phys;
+        job.m_dim = count;
+        if (primed) {
+            job.gather_index_addr = delta->rows_phys;
+            job.gather_table_rows = base->m_dim;
+            job.accumulate = true;
+        }
+        if (gemm_accel_start(&job) != 0 || gemm_accel_wait() != 0) {
+            // C may be partly updated; recompute it on the next update
+            delta->primed = false;
+            return -1;
+        }
+        delta->passes++;
+        delta->primed = true;
+    }
+    
+    for (uint16_t m = 0; m < base->m_dim; m++) {
+        uint32_t row = (uint32_t)m * base->stride_a;
+        memcpy(delta->prev_a + row, a_new + row, base->k_dim);
+    }
+    return 0;
+}
+
+// Softmax exponent table: lut[i] = 255 * decay^i, decay in Q16 (for scores
+// with scale s and shift sh, decay = exp(-s * 2^sh))
+void gemm_softmax_exp_lut(uint8_t* lut, uint16_t decay_q16) {
+    uint32_t value = 255u << 16;
+    for (int i = 0; i < GEMM_SOFTMAX_LUT_SIZE; i++) {
+        lut[i] = (uint8_t)((value + 0x8000) >> 16);
+        value = (uint32_t)(((uint64_t)value * decay_q16) >> 16);
+    }
+}
+
+// Load the softmax table of the selected instance
+void gemm_accel_load_softmax_lut(const uint8_t* lut) {
+    for (int i = 0; i < GEMM_SOFTMAX_LUT_SIZE; i++) {
+        REG_WRITE(GEMM_SOFTMAX_LUT_REG, i | ((uint32_t)lut[i] << GEMM_SOFTMAX_LUT_VALUE_POS));
+    }
+}
+
+// Query rows per fused job: the block's scores, Q rows and outputs must fit
+// the A half of the scratchpad (0 if K^T or V alone does not fit the B half)
+uint16_t gemm_attention_block_rows(const gemm_attention_t* attn) {
+    if (SCRATCHPAD_LINES_FOR((uint32_t)attn->head_dim * attn->seq_kv) > GEMM_SCRATCHPAD_HALF_LINES ||
+        SCRATCHPAD_LINES_FOR((uint32_t)attn->seq_kv * attn->v_dim) > GEMM_SCRATCHPAD_HALF_LINES) {
+        return 0;
+    }
+    
+    uint32_t score_row = SCRATCHPAD_LINES_FOR(attn->seq_kv * 4);
+    uint32_t out_row = SCRATCHPAD_LINES_FOR(attn->v_dim * 4);
+    uint32_t rows = GEMM_SCRATCHPAD_HALF_LINES / (score_row > out_row ? score_row : out_row);
+    uint32_t q_rows = GEMM_SCRATCHPAD_HALF_LINES * GEMM_SCRATCHPAD_LINE_BYTES / attn->head_dim;
+    rows = rows < q_rows ? rows : q_rows;
+    return rows < attn->seq_q ? rows : attn->seq_q;
+}
+
+// Run attention over blocks of query rows, one fused job each; the score
+// matrix never leaves the scratchpad
+int gemm_attention_run(const gemm_attention_t* attn) {
+    if (attn == NULL || attn->seq_q == 0 || attn->seq_kv == 0 ||
+        attn->head_dim == 0 || attn->v_dim == 0) {
+        printf("ERROR: Invalid attention shape\n");
+        return -1;
+    }
+    
+    uint16_t block = gemm_attention_block_rows(attn);
+    if (block == 0) {
+        printf("ERROR: K and V exceed the scratchpad\n");
+        return -1;
+    }
+    
+    gemm_config_t config = {0};
+    config.matrix_b_addr = attn->kt_addr;
+    config.k_dim = attn->head_dim;
+    config.n_dim = attn->v_dim;
+    config.data_type = GEMM_DATA_TYPE_INT8;
+    config.stride_a = attn->q_stride;
+    config.stride_b = attn->kt_stride;
+    config.stride_c = attn->out_stride;
+    config.job_class = attn->job_class;
+    config.attn_seq_len = attn->seq_kv;
+    config.attn_shift = attn->score_shift;
+    config.attn_v_addr = attn->v_addr;
+    config.attn_v_stride = attn->v_stride;
+    
+    for (uint16_t q0 = 0; q0 < attn->seq_q; q0 += block) {
+        config.matrix_a_addr = attn->q_addr + (uint32_t)q0 * attn->q_stride;
+        config.matrix_c_addr = attn->out_addr + (uint32_t)q0 * attn->out_stride * sizeof(int32_t);
+        config.m_dim = attn->seq_q - q0 < block ? attn->seq_q - q0 : block;
+        if (gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Lines of the int32 C tile. A band writes it to the A half, and every band
+// after the first reloads the previous C into the B half to accumulate
+static uint32_t stream_c_lines(const gemm_config_t* base) {
+    return (uint32_t)base->m_dim * SCRATCHPAD_LINES_FOR((uint32_t)base->n_dim * 4);
+}
+
+// Largest band of B rows whose B block fits the B half of the scratchpad
+// and whose A columns fit the A half (0 if one row of B does not fit, or
+// if the C tile does not fit a half)
+uint16_t gemm_stream_block_rows(const gemm_config_t* base) {
+    if (base->m_dim == 0 || base->n_dim == 0 || stream_c_lines(base) > GEMM_SCRATCHPAD_HALF_LINES) {
+        return 0;
+    }
+    uint32_t elem = base->data_type == GEMM_DATA_TYPE_INT16 ? 2 : 1;
+    uint32_t half_bytes = GEMM_SCRATCHPAD_HALF_LINES * GEMM_SCRATCHPAD_LINE_BYTES;
+    uint32_t rows = half_bytes / ((uint32_t)base->n_dim * elem);
+    // A bands are column slices, loaded with each row on its own lines
+    uint32_t a_rows = (GEMM_SCRATCHPAD_HALF_LINES / base->m_dim) * GEMM_SCRATCHPAD_LINE_BYTES / elem;
+    rows = rows < a_rows ? rows : a_rows;
+    return rows < base->k_dim ? rows : base->k_dim;
+}
+
+// Bytes per ring slot: one band of B rows, in whole scratchpad lines
+uint32_t gemm_stream_slot_size(const gemm_stream_t* stream) {
+    uint32_t elem = stream->base.data_type == GEMM_DATA_TYPE_INT16 ? 2 : 1;
+    uint16_t rows = stream->block_rows != 0 ? stream->block_rows : gemm_stream_block_rows(&stream->base);
+    return SCRATCHPAD_LINES_FOR((uint32_t)rows * stream->base.stride_b * elem) * GEMM_SCRATCHPAD_LINE_BYTES;
+}
+
+// Start reading band j of B into its ring slot
+static int stream_submit(gemm_stream_t* stream, uint16_t j, uint16_t rows, uint32_t slot_size) {
+    uint32_t row_bytes = (uint32_t)stream->base.stride_b *
+                         (stream->base.data_type == GEMM_DATA_TYPE_INT16 ? 2 : 1);
+    uint16_t k0 = j * rows;
+    uint16_t band = stream->base.k_dim - k0 < rows ? stream->base.k_dim - k0 : rows;
+    uint8_t slot = j % stream->depth;
+    if (stream->submit(stream->io_ctx, slot, stream->b_offset + (uint64_t)k0 * row_bytes,
+                       band * row_bytes, stream->buffers + slot * slot_size) != 0) {
+        printf("ERROR: Weight read failed\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Wait out the reads of bands first..end - 1 so no slot is written after
+// the run returns; their results no longer matter
+static void stream_drain(gemm_stream_t* stream, uint16_t first, uint16_t end) {
+    for (uint16_t j = first; j < end; j++) {
+        stream->wait(stream->io_ctx, j % stream->depth);
+    }
+}
+
+// Compute the bands of B in turn. Reads of the next depth - 1 bands are in
+// flight while a band computes; a slot is refilled as soon as the job
+// consuming it completes. On an error the reads still in flight are drained
+// before returning.
+static int stream_bands(gemm_stream_t* stream, uint16_t rows) {
+    const gemm_config_t* base = &stream->base;
+    uint32_t elem = base->data_type == GEMM_DATA_TYPE_INT16 ? 2 : 1;
+    uint32_t slot_size = gemm_stream_slot_size(stream);
+    uint16_t blocks = (base->k_dim + rows - 1) / rows;
+    uint16_t submitted = 0;
+    stream->blocks = 0;
+    
+    for (; submitted < blocks && submitted < stream->depth; submitted++) {
+        if (stream_submit(stream, submitted, rows, slot_size) != 0) {
+            stream_drain(stream, 0, submitted);
+            return -1;
+        }
+    }
+    
+    gemm_config_t job = *base;
+    for (uint16_t j = 0; j < blocks; j++) {
+        uint8_t slot = j % stream->depth;
+        uint16_t k0 = j * rows;
+        if (stream->wait(stream->io_ctx, slot) != 0) {
+            printf("ERROR: Weight read failed\n");
+            stream_drain(stream, j + 1, submitted);
+            return -1;
+        }
+        
+        job.matrix_a_addr = base->matrix_a_addr + k0 * elem;
+        job.matrix_b_addr = stream->buffers_phys + slot * slot_size;
+        job.k_dim = base->k_dim - k0 < rows ? base->k_dim - k0 : rows;
+        job.accumulate = base->accumulate || j > 0;
+        if (gemm_accel_start(&job) != 0 || gemm_accel_wait() != 0) {
+            stream_drain(stream, j + 1, submitted);
+            return -1;
+        }
+        stream->blocks++;
+        
+        if (submitted < blocks) {
+            if (stream_submit(stream, submitted, rows, slot_size) != 0) {
+                stream_drain(stream, j + 1, submitted);
+                return -1;
+            }
+            submitted++;
+        }
+    }
+    return 0;
+}
+
+// Run C = A * B with B streamed from storage through the ring
+int gemm_stream_run(gemm_stream_t* stream) {
+    if (stream == NULL || stream->submit == NULL || stream->wait == NULL || stream->buffers == NULL) {
+        printf("ERROR: Invalid weight stream\n");
+        return -1;
+    }
+    
+    const gemm_config_t* base = &stream->base;
+    if ((base->data_type != GEMM_DATA_TYPE_INT8 && base->data_type != GEMM_DATA_TYPE_INT16) ||
+        base->weight_bits != 0 || base->pad_top || base->pad_bottom || base->pad_left ||
+        base->pad_right || base->gather_table_rows != 0 || base->attn_seq_len != 0 ||
+        base->out_bias || base->out_relu || base->out_requant) {
+        printf("ERROR: Weight streaming needs a plain int8 or int16 job\n");
+        return -1;
+    }
+    
+    if (stream->depth == 0 || stream->depth > GEMM_STREAM_MAX_DEPTH) {
+        printf("ERROR: Stream depth must be 1-%d\n", GEMM_STREAM_MAX_DEPTH);
+        return -1;
+    }
+    
+    if (stream_c_lines(base) > GEMM_SCRATCHPAD_HALF_LINES) {
+        printf("ERROR: Output tile exceeds the scratchpad\n");
+        return -1;
+    }
+    
+    uint16_t max_rows = gemm_stream_block_rows(base);
+    uint16_t rows = stream->block_rows != 0 ? stream->block_rows : max_rows;
+    if (rows == 0 || rows > max_rows) {
+        printf("ERROR: Weight band exceeds the scratchpad\n");
+        return -1;
+    }
+    
+    // The ring is DMA memory in use for the whole run
+    uint32_t ring_bytes = stream->depth * gemm_stream_slot_size(stream);
+    gemm_mem_profile_alloc(GEMM_MEM_DMA, ring_bytes);
+    int result = stream_bands(stream, rows);
+    gemm_mem_profile_free(GEMM_MEM_DMA, ring_bytes);
+    return result;
+}
+
 // Helper function to create configuration
 gemm_config_t gemm_create_config(
     uint32_t matrix_a_addr,
@@ -192,7 +1356,7 @@ gemm_config_t gemm_create_config(
     uint16_t stride_b,
     uint16_t stride_c
 ) {
-    gemm_config_t config;
+    gemm_config_t config = {0};
     config.matrix_a_addr = matrix_a_addr;
     config.matrix_b_addr = matrix_b_addr;
     config.matrix_c_addr = matrix_c_addr;
@@ -21,6 +21,36 @@
 #define GEMM_STRIDE_A_REG       (GEMM_ACCEL_BASE_ADDR + 0x24)
 #define GEMM_STRIDE_B_REG       (GEMM_ACCEL_BASE_ADDR + 0x28)
 #define GEMM_STRIDE_C_REG       (GEMM_ACCEL_BASE_ADDR + 0x2C)
+#define GEMM_LAT_CTRL_REG       (GEMM_ACCEL_BASE_ADDR + 0x30)
+#define GEMM_LAT_SEL_REG        (GEMM_ACCEL_BASE_ADDR + 0x34)
+#define GEMM_LAT_BIN_REG        (GEMM_ACCEL_BASE_ADDR + 0x38)
+#define GEMM_LAT_MAX_REG        (GEMM_ACCEL_BASE_ADDR + 0x3C)
+#define GEMM_MMU_CTRL_REG       (GEMM_ACCEL_BASE_ADDR + 0x40)
+#define GEMM_MMU_PTBR_REG       (GEMM_ACCEL_BASE_ADDR + 0x44)
+#define GEMM_MMU_FAULT_ADDR_REG (GEMM_ACCEL_BASE_ADDR + 0x48)
+#define GEMM_PAD_REG            (GEMM_ACCEL_BASE_ADDR + 0x4C)
+#define GEMM_GATHER_CTRL_REG    (GEMM_ACCEL_BASE_ADDR + 0x50)
+#define GEMM_GATHER_INDEX_ADDR_REG (GEMM_ACCEL_BASE_ADDR + 0x54)
+#define GEMM_GATHER_NUM_ROWS_REG (GEMM_ACCEL_BASE_ADDR + 0x58)
+#define GEMM_MCAST_CTRL_REG     (GEMM_ACCEL_BASE_ADDR + 0x5C)
+#define GEMM_BW_CTRL_REG        (GEMM_ACCEL_BASE_ADDR + 0x60)
+#define GEMM_BW_BUDGET_REG      (GEMM_ACCEL_BASE_ADDR + 0x64)
+#define GEMM_ABFT_CTRL_REG      (GEMM_ACCEL_BASE_ADDR + 0x68)
+#define GEMM_ERROR_CODE_REG     (GEMM_ACCEL_BASE_ADDR + 0x6C)
+#define GEMM_ACCUM_CTRL_REG     (GEMM_ACCEL_BASE_ADDR + 0x70)
+#define GEMM_ATTN_CTRL_REG      (GEMM_ACCEL_BASE_ADDR + 0x74)
+#define GEMM_ATTN_V_ADDR_REG    (GEMM_ACCEL_BASE_ADDR + 0x78)
+#define GEMM_ATTN_V_STRIDE_REG  (GEMM_ACCEL_BASE_ADDR + 0x7C)
+#define GEMM_SOFTMAX_LUT_REG    (GEMM_ACCEL_BASE_ADDR + 0x80)
+#define GEMM_OUTPUT_CTRL_REG    (GEMM_ACCEL_BASE_ADDR + 0x84)
+#define GEMM_OUTPUT_BIAS_ADDR_REG (GEMM_ACCEL_BASE_ADDR + 0x88)
+#define GEMM_OUTPUT_MULT_REG    (GEMM_ACCEL_BASE_ADDR + 0x8C)
+#define GEMM_OUTPUT_CLAMP_REG   (GEMM_ACCEL_BASE_ADDR + 0x90)
+
+// Multi-instance systems (e.g. gemm_cluster cores): instance i decodes at
+// GEMM_ACCEL_BASE_ADDR + i * GEMM_ACCEL_INSTANCE_STRIDE
+#define GEMM_ACCEL_MAX_INSTANCES   4
+#define GEMM_ACCEL_INSTANCE_STRIDE 0x1000
 
 // Control register bits
 #define GEMM_CTRL_START         (1 << 0)
@@ -31,10 +61,126 @@
 #define GEMM_STATUS_BUSY        (1 << 0)
 #define GEMM_STATUS_DONE        (1 << 1)
 #define GEMM_STATUS_ERROR       (1 << 2)
+#define GEMM_STATUS_MMU_FAULT   (1 << 3)
+#define GEMM_STATUS_INDEX_ERROR (1 << 4)
+#define GEMM_STATUS_ABFT_ERROR  (1 << 5)
+
+// Latency monitor control bits
+#define GEMM_LAT_CTRL_ENABLE    (1 << 0)
+#define GEMM_LAT_CTRL_CLEAR     (1 << 1)
+#define GEMM_LAT_CTRL_SHIFT_POS 4
+#define GEMM_LAT_SEL_WRITE      (1 << 8)
+
+// Latency monitor channels
+#define GEMM_LAT_CHANNEL_READ   0   // AR -> first R beat
+#define GEMM_LAT_CHANNEL_WRITE  1   // AW -> B response
+#define GEMM_LAT_NUM_BINS       16
+
+// MMU control bits
+#define GEMM_MMU_CTRL_ENABLE    (1 << 0)
+#define GEMM_MMU_CTRL_TLB_FLUSH (1 << 1)
+#define GEMM_MMU_CTRL_FAULT_CLR (1 << 2)
+
+// Page table format (two-level, 4KB pages, 32-bit PTEs)
+#define GEMM_MMU_PAGE_SIZE      4096
+#define GEMM_MMU_PTES_PER_TABLE 1024
+#define GEMM_PTE_VALID          (1 << 0)
+#define GEMM_PTE_WRITABLE       (1 << 1)
+
+// Zero-padding limit (PAD register nibbles)
+#define GEMM_PAD_MAX            15
+
+// Gather control bits
+#define GEMM_GATHER_CTRL_ENABLE (1 << 0)
+
+// Accumulate control bits
+#define GEMM_ACCUM_CTRL_ENABLE  (1 << 0)
+
+// Delta updates: residual passes per update when an element change exceeds
+// the int8 range (|delta| <= 255 needs at most three)
+#define GEMM_DELTA_MAX_PASSES   3
+
+// Weight streaming: most B blocks buffered (in flight or being consumed)
+#define GEMM_STREAM_MAX_DEPTH   8
+
+// Fused attention fields
+#define GEMM_ATTN_CTRL_ENABLE   (1 << 0)
+#define GEMM_ATTN_SHIFT_POS     4       // ATTN_CTRL: [7:4] score shift, [31:16] sequence length
+#define GEMM_ATTN_SHIFT_MAX     15
+#define GEMM_ATTN_SEQ_POS       16
+#define GEMM_SOFTMAX_LUT_SIZE   256
+#define GEMM_SOFTMAX_LUT_VALUE_POS 8    // SOFTMAX_LUT: [7:0] entry, [15:8] value
+#define GEMM_SOFTMAX_P_MAX      127     // Probabilities of a row sum to about this
+
+// Output stage fields: OUTPUT_CTRL [13:8] shift, [23:16] zero point;
+// OUTPUT_CLAMP [7:0] min, [15:8] max (int8)
+#define GEMM_OUTPUT_CTRL_BIAS   (1 << 0)
+#define GEMM_OUTPUT_CTRL_RELU   (1 << 1)
+#define GEMM_OUTPUT_CTRL_REQUANT (1 << 2)
+#define GEMM_OUTPUT_SHIFT_POS   8
+#define GEMM_OUTPUT_SHIFT_MAX   63
+#define GEMM_OUTPUT_ZERO_POS    16
+#define GEMM_OUTPUT_MAX_POS     8
+
+// Scratchpad geometry: operands and scores are held in 32-byte lines, A and
+// results in the first half and B in the second
+#define GEMM_SCRATCHPAD_LINE_BYTES 32
+#define GEMM_SCRATCHPAD_HALF_LINES 256
+
+// Memory footprint profiler: tracked kinds of memory
+#define GEMM_MEM_DMA            0       // DMA buffers (stream rings, ...)
+#define GEMM_MEM_ARENA          1       // TFLite arena held by accelerator tensors
+#define GEMM_MEM_SCRATCHPAD     2       // Scratchpad occupied by the current job
+#define GEMM_MEM_KINDS          3
+
+// Cluster weight multicast control bits
+#define GEMM_MCAST_CTRL_ENABLE  (1 << 0)
+
+// Output checksums (ABFT): int8 jobs without padding, gather or bit-serial
+// weights, with k_dim and n_dim multiples of 32 and k_dim <= 1024
+#define GEMM_ABFT_CTRL_ENABLE   (1 << 0)
+#define GEMM_ABFT_LINE_ELEMS    32
+#define GEMM_ABFT_MAX_K         1024
+
+// Per-job error codes (ERROR_CODE[3:0]); bit 8 is set when the job was checked
+#define GEMM_ERR_NONE           0
+#define GEMM_ERR_MMU_FAULT      1
+#define GEMM_ERR_INDEX          2
+#define GEMM_ERR_ABFT           3
+#define GEMM_ERR_CODE_MASK      0xF
+#define GEMM_ERR_ABFT_CHECKED   (1 << 8)
+
+// Bandwidth regulation fields
+#define GEMM_BW_QOS_POS         16      // BW_CTRL: [15:0] window, [19:16] AXI QoS
+#define GEMM_BW_QOS_MAX         15
+#define GEMM_BW_WR_BYTES_POS    16      // BW_BUDGET: [15:0] read, [31:16] write bytes
+
+// Job classes (class 0 is unregulated until configured)
+#define GEMM_JOB_CLASS_DEFAULT  0
+#define GEMM_NUM_JOB_CLASSES    4
+
+// Output rows are written at matrix_c_addr + m * stride_c * 4 (byte pitch is 16 bits)
+#define GEMM_MAX_STRIDE_C       (0xFFFF / 4)
+
+// Layer pipeline
+#define GEMM_PIPELINE_MAX_STAGES   8
+#define GEMM_PIPELINE_SLOTS        2       // Activation buffers per stage boundary
 
 // Data types
 #define GEMM_DATA_TYPE_INT8     0
 #define GEMM_DATA_TYPE_INT16    1
+#define GEMM_DATA_TYPE_BINARY   2       // +1/-1 bits, XNOR-popcount
+#define GEMM_DATA_TYPE_TERNARY  3       // -1/0/+1 as sign and nonzero bits
+
+// Binary/ternary operands are rows of 64-bit words covering this many k
+#define GEMM_BNN_BINARY_PER_WORD  64
+#define GEMM_BNN_TERNARY_PER_WORD 32
+
+// Bit-serial weights (DATA_TYPE register [11:8], int8 only)
+#define GEMM_WEIGHT_BITS_POS    8
+#define GEMM_WEIGHT_BITS_MIN    2
+#define GEMM_WEIGHT_BITS_MAX    8
+#define GEMM_WEIGHT_GROUP       8       // k rows per packed bit-plane byte
 
 // Configuration structure
 typedef struct {
@@ -45,11 +191,204 @@ typedef struct {
     uint16_t k_dim;
     uint16_t n_dim;
     uint8_t  data_type;
+    // Bit-serial B: 0 for plain int8/int16 B, else 2-8 bit weights packed by
+    // gemm_pack_weights; stride_b is then the plane row pitch in bytes
+    uint8_t  weight_bits;
     uint16_t stride_a;
     uint16_t stride_b;
     uint16_t stride_c;
+    // Zero borders of A generated by the DMA; m_dim/k_dim include them and
+    // matrix_a_addr/stride_a describe the unpadded interior
+    uint8_t  pad_top;
+    uint8_t  pad_bottom;
+    uint8_t  pad_left;
+    uint8_t  pad_right;
+    // Indexed gather: when gather_table_rows is nonzero, row m of A is row
+    // index[m] of the table at matrix_a_addr (pitch stride_a); index is a
+    // uint32 array at gather_index_addr, out-of-range entries load zeros
+    uint32_t gather_index_addr;
+    uint32_t gather_table_rows;
+    // Bandwidth class programmed with the job (see gemm_accel_set_job_class)
+    uint8_t  job_class;
+    // Accumulate: C += A*B, reading the existing C. With gather, row m of
+    // the result is added to row index[m] of C and no other rows are touched
+    uint8_t  accumulate;
+    // Fused attention when attn_seq_len is nonzero: A (Q) times B (K^T,
+    // k_dim x attn_seq_len) gives scores that stay in the scratchpad, a LUT
+    // softmax turns them into int8 P, and C = P * V with V attn_seq_len x
+    // n_dim int8 at attn_v_addr (pitch attn_v_stride)
+    uint16_t attn_seq_len;
+    uint8_t  attn_shift;
+    uint32_t attn_v_addr;
+    uint16_t attn_v_stride;
+    // Output stage, applied lane-wise as C is stored: x = A*B (+ bias[n],
+    // int32 at out_bias_addr when out_bias), then max(x, 0) when out_relu.
+    // With out_requant, C is int8 (stride_c then in bytes):
+    // clamp(((x * out_multiplier + round) >> out_shift) + out_zero_point,
+    // out_min, out_max), rounding half up
+    uint8_t  out_bias;
+    uint32_t out_bias_addr;
+    uint8_t  out_relu;
+    uint8_t  out_requant;
+    int32_t  out_multiplier;
+    uint8_t  out_shift;
+    int8_t   out_zero_point;
+    int8_t   out_min;
+    int8_t   out_max;
 } gemm_config_t;
 
+// DMA bandwidth and AXI QoS of a job class. Each window_cycles the DMA may
+// issue read_bytes and write_bytes of new bursts; window_cycles = 0 leaves
+// it unregulated.
+typedef struct {
+    uint16_t window_cycles;
+    uint16_t read_bytes;
+    uint16_t write_bytes;
+    uint8_t  qos;           // AXI AxQOS of all job traffic, 0-15
+} gemm_bw_class_t;
+
+// Temporal delta GEMM: keeps C = A*B current for an int8 A that changes
+// little between updates. Each update diffs the new A against prev_a, writes
+// the changed rows' differences into the delta table (m_dim rows of
+// stride_a bytes, at the rows' own positions) and lists them in rows; one
+// accumulating gathered job then adds delta*B into those rows of C only.
+// The first update computes C in full.
+typedef struct {
+    gemm_config_t base;     // Full job; matrix_a_addr is unused
+    int8_t*   prev_a;       // CPU copy of the last A, m_dim x stride_a
+    int8_t*   delta;        // Delta table, CPU view and accelerator address
+    uint32_t  delta_phys;
+    uint32_t* rows;         // Changed row list (m_dim entries)
+    uint32_t  rows_phys;
+    bool      primed;       // C holds base A * B for prev_a
+    uint16_t  changed_rows; // Rows recomputed by the last update
+    uint8_t   passes;       // Jobs issued by the last update
+} gemm_delta_t;
+
+// Single-head attention out = softmax(Q * K^T) * V, all int8 except the
+// int32 output, run as fused jobs over blocks of query rows that fit the
+// scratchpad. Score differences from the row maximum are shifted right by
+// score_shift before indexing the softmax LUT.
+typedef struct {
+    uint32_t q_addr;        // seq_q x head_dim
+    uint32_t kt_addr;       // head_dim x seq_kv (K transposed)
+    uint32_t v_addr;        // seq_kv x v_dim
+    uint32_t out_addr;      // seq_q x v_dim int32
+    uint16_t q_stride;      // Row pitches in elements
+    uint16_t kt_stride;
+    uint16_t v_stride;
+    uint16_t out_stride;
+    uint16_t seq_q;
+    uint16_t seq_kv;
+    uint16_t head_dim;
+    uint16_t v_dim;
+    uint8_t  score_shift;
+    uint8_t  job_class;
+} gemm_attention_t;
+
+// Out-of-core weight streaming: B is read from storage in bands of
+// block_rows rows into a ring of depth buffers while earlier bands compute,
+// so only depth bands are ever resident. Band j runs as one job on the
+// matching columns of A and accumulates into C after the first. Reads are
+// asynchronous: submit starts reading size bytes at offset into dst (the
+// slot's CPU view), and wait blocks until that slot's read is complete. They
+// can wrap io_uring, a thread pool, or mmap with madvise(WILLNEED) readahead.
+typedef int (*gemm_stream_submit_fn)(void* ctx, uint8_t slot, uint64_t offset,
+                                     uint32_t size, void* dst);
+typedef int (*gemm_stream_wait_fn)(void* ctx, uint8_t slot);
+
+typedef struct {
+    gemm_config_t base;     // Full job; matrix_b_addr is unused
+    uint64_t  b_offset;     // B in storage: k_dim rows of stride_b elements
+    gemm_stream_submit_fn submit;
+    gemm_stream_wait_fn   wait;
+    void*     io_ctx;
+    uint8_t*  buffers;      // depth slots of gemm_stream_slot_size() bytes
+    uint32_t  buffers_phys;
+    uint8_t   depth;        // 2 or more to overlap reads with compute
+    uint16_t  block_rows;   // B rows per band, 0 = gemm_stream_block_rows()
+    uint16_t  blocks;       // Bands run by the last gemm_stream_run()
+} gemm_stream_t;
+
+// Output view: C written as a sub-block of a larger row-major int32 tensor
+// (e.g. a column slice of a concatenation output); all fields in elements
+typedef struct {
+    uint32_t base_addr;     // Parent tensor base address
+    uint16_t row_pitch;     // Parent tensor row length
+    uint16_t row_offset;    // First parent row written
+    uint16_t col_offset;    // First parent column written
+} gemm_output_view_t;
+
+// AXI latency histogram for one channel
+// Bin 0 counts latencies below (1 << bin_shift) cycles; bin k counts
+// [2^(k-1), 2^k) << bin_shift cycles; the last bin also holds overflow.
+typedef struct {
+    uint32_t bins[GEMM_LAT_NUM_BINS];
+    uint32_t max_latency;
+    uint8_t  bin_shift;
+} gemm_latency_hist_t;
+
+// Memory footprint profile of one model run. The driver records scratchpad
+// occupancy at each job start along with its own DMA buffer use; the
+// owners of other DMA buffers and of arena tensors report them with
+// gemm_mem_profile_alloc/free. Job i's sample is kept at
+// samples[i % max_samples], so the timeline holds the last max_samples jobs.
+typedef struct {
+    uint32_t bytes[GEMM_MEM_KINDS];
+} gemm_mem_sample_t;
+
+typedef struct {
+    const char* name;                   // Model name for the report
+    uint32_t limit[GEMM_MEM_KINDS];     // Capacity for headroom (0 = unknown)
+    uint32_t current[GEMM_MEM_KINDS];
+    uint32_t peak[GEMM_MEM_KINDS];
+    uint32_t jobs;
+    gemm_mem_sample_t* samples;
+    uint32_t max_samples;
+} gemm_mem_profile_t;
+
+// Driver-maintained DMA page table
+// Each table is one 4KB page; l1_table/l0_pool are the CPU views and
+// l1_phys/l0_pool_phys the addresses the accelerator walks.
+typedef struct {
+    uint32_t* l1_table;
+    uint32_t  l1_phys;
+    uint32_t* l0_pool;
+    uint32_t  l0_pool_phys;
+    uint16_t  l0_pool_pages;
+    uint16_t  l0_used;
+} gemm_page_table_t;
+
+// Layer pipeline: consecutive layers run on different instances, one
+// inference per stage in flight. Stage s hands inference i to stage s+1
+// through slot i % GEMM_PIPELINE_SLOTS of their boundary; each slot is a C
+// buffer of stage s (out_addr) and an A buffer of stage s+1 (in_addr).
+// The forward callback turns one into the other (e.g. int32 requantized to
+// int8) after stage s completes. Stage 0 reads the stream inputs and the
+// last stage writes the stream outputs directly.
+typedef int (*gemm_pipeline_forward_fn)(uint8_t stage, uint8_t slot, void* ctx);
+
+typedef struct {
+    gemm_config_t layer;    // matrix_a_addr/matrix_c_addr come from the slots
+    uint8_t  instance;
+    uint32_t in_addr[GEMM_PIPELINE_SLOTS];
+    uint32_t out_addr[GEMM_PIPELINE_SLOTS];
+} gemm_pipeline_stage_t;
+
+typedef struct {
+    gemm_pipeline_stage_t stages[GEMM_PIPELINE_MAX_STAGES];
+    uint8_t  num_stages;
+    gemm_pipeline_forward_fn forward;
+    void*    forward_ctx;
+    // Boundary s semaphores: slots holding forwarded activations for stage
+    // s+1, and slots stage s may write
+    uint8_t  full[GEMM_PIPELINE_MAX_STAGES];
+    uint8_t  empty[GEMM_PIPELINE_MAX_STAGES];
+    uint32_t issued[GEMM_PIPELINE_MAX_STAGES];
+    uint32_t completed[GEMM_PIPELINE_MAX_STAGES];
+    bool     running[GEMM_PIPELINE_MAX_STAGES];
+} gemm_pipeline_t;
+
 // Function prototypes
 int gemm_accel_init(void);
 int gemm_accel_start(const gemm_config_t* config);
@@ -62,6 +401,80 @@ bool gemm_accel_has_error(void);
 
 // Utility functions
 void gemm_accel_set_interrupt_enable(bool enable);
+void gemm_accel_set_weight_multicast(bool enable);
+int gemm_accel_set_job_class(uint8_t job_class, const gemm_bw_class_t* bw);
+void gemm_accel_set_abft(bool enable);
+uint8_t gemm_accel_error_code(void);
+bool gemm_accel_abft_checked(void);
 uint32_t gemm_accel_get_cycle_count(void);
 
+// Multiple instances: later calls address the selected instance
+int gemm_accel_select_instance(uint8_t instance);
+uint8_t gemm_accel_current_instance(void);
+
+// Layer pipelining across instances
+void gemm_pipeline_init(gemm_pipeline_t* pipe, gemm_pipeline_forward_fn forward, void* ctx);
+int gemm_pipeline_add_stage(gemm_pipeline_t* pipe, const gemm_pipeline_stage_t* stage);
+int gemm_pipeline_run(gemm_pipeline_t* pipe, const uint32_t* input_addrs,
+                      const uint32_t* output_addrs, uint32_t count);
+
+// Temporal delta GEMM
+int gemm_delta_init(gemm_delta_t* delta, const gemm_config_t* base,
+                    int8_t* prev_a, int8_t* table, uint32_t table_phys,
+                    uint32_t* rows, uint32_t rows_phys);
+int gemm_delta_update(gemm_delta_t* delta, const int8_t* a_new);
+
+// Out-of-core weight streaming
+uint16_t gemm_stream_block_rows(const gemm_config_t* base);
+uint32_t gemm_stream_slot_size(const gemm_stream_t* stream);
+int gemm_stream_run(gemm_stream_t* stream);
+
+// Fused attention
+void gemm_softmax_exp_lut(uint8_t* lut, uint16_t decay_q16);
+void gemm_accel_load_softmax_lut(const uint8_t* lut);
+uint16_t gemm_attention_block_rows(const gemm_attention_t* attn);
+int gemm_attention_run(const gemm_attention_t* attn);
+
+// Output views
+int gemm_accel_set_output_view(gemm_config_t* config, const gemm_output_view_t* view);
+
+// Offline weight packing for bit-serial B
+uint32_t gemm_packed_weights_size(uint16_t k_dim, uint16_t n_dim, uint8_t weight_bits);
+int gemm_pack_weights(const int8_t* b, uint16_t k_dim, uint16_t n_dim, uint16_t stride_b,
+                      uint8_t weight_bits, uint8_t* packed);
+
+// Binary/ternary packing: A is packed by rows, B by columns (rows of B^T)
+uint16_t gemm_bnn_row_bytes(uint16_t k_dim, uint8_t data_type);
+int gemm_pack_bnn(const int8_t* src, uint16_t rows, uint16_t k_dim,
+                  uint32_t row_step, uint32_t k_step, uint8_t data_type, uint8_t* packed);
+
+// AXI latency monitor
+int gemm_accel_latency_monitor_config(bool enable, uint8_t bin_shift);
+void gemm_accel_latency_monitor_clear(void);
+int gemm_accel_read_latency_histogram(uint8_t channel, gemm_latency_hist_t* hist);
+void gemm_accel_print_latency_summary(void);
+
+// Memory footprint profiling
+uint32_t gemm_accel_job_scratchpad_bytes(const gemm_config_t* config);
+void gemm_mem_profile_start(gemm_mem_profile_t* prof, const char* name,
+                            gemm_mem_sample_t* samples, uint32_t max_samples);
+void gemm_mem_profile_stop(void);
+void gemm_mem_profile_alloc(uint8_t kind, uint32_t bytes);
+void gemm_mem_profile_free(uint8_t kind, uint32_t bytes);
+void gemm_mem_profile_report(const gemm_mem_profile_t* prof);
+
+// DMA address translation
+int gemm_accel_mmu_init_table(gemm_page_table_t* pt,
+                              uint32_t* l1_table, uint32_t l1_phys,
+                              uint32_t* l0_pool, uint32_t l0_pool_phys,
+                              uint16_t l0_pool_pages);
+int gemm_accel_mmu_map(gemm_page_table_t* pt, uint32_t iova,
+                       const uint32_t* page_phys, uint32_t num_pages, bool writable);
+void gemm_accel_mmu_unmap(gemm_page_table_t* pt, uint32_t iova, uint32_t num_pages);
+int gemm_accel_mmu_enable(const gemm_page_table_t* pt);
+void gemm_accel_mmu_disable(void);
+void gemm_accel_mmu_flush_tlb(void);
+bool gemm_accel_mmu_has_fault(void);
+uint32_t gemm_accel_mmu_fault_addr(void);
+
 #endif // GEMM_ACCEL_DRIVER_H
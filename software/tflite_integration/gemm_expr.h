@@ -0,0 +1,297 @@
+// GEMM Expression API
+// Lazy GEMM expressions whose elementwise tail is fused into the job's
+// output stage, e.g.
+//
+//   auto y = clamp(requant(gemm(a, b) + bias, rq), 0, 127);
+//   y.Eval(out);
+//
+// Building an expression only records the operations. Eval fuses the
+// longest prefix the output stage can apply (bias, ReLU, requantization and
+// its clamp, in that order) into one accelerator job and runs any remaining
+// operations as CPU passes over the result. Requantization yields int8;
+// after it only relu and clamp may follow.
+
+#ifndef GEMM_EXPR_H
+#define GEMM_EXPR_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "gemm_accel_driver.h"
+
+namespace tflite {
+namespace gemm_accel {
+
+// Recorded operations per expression
+constexpr int kMaxExprOps = 8;
+
+// int8 or int16 operand in accelerator memory: rows x cols elements of
+// data_type with a row pitch of stride elements
+struct MatrixRef {
+    uint32_t addr;
+    uint16_t rows;
+    uint16_t cols;
+    uint16_t stride;
+    uint8_t  data_type;
+};
+
+// Per-column int32 bias; data is the CPU view of addr
+struct BiasRef {
+    const int32_t* data;
+    uint32_t addr;
+};
+
+// y = ((x * multiplier + round) >> shift) + zero_point, saturated to int8
+struct RequantParams {
+    int32_t multiplier;
+    uint8_t shift;
+    int8_t  zero_point;
+};
+
+// Result buffer: CPU view, accelerator address and row pitch in elements
+struct OutputRef {
+    void*    data;
+    uint32_t addr;
+    uint16_t stride;
+};
+
+// Requantization as done by the output stage (dma_output_stage)
+inline int8_t RequantizeValue(int32_t x, const RequantParams& p, int8_t lo, int8_t hi) {
+    int64_t scaled = (int64_t)x * p.multiplier;
+    if (p.shift != 0) {
+        scaled += (int64_t)1 << (p.shift - 1);
+    }
+    int64_t y = (scaled >> p.shift) + p.zero_point;
+    return (int8_t)(y < lo ? lo : y > hi ? hi : y);
+}
+
+class GemmExpr {
+public:
+    enum OpKind { kBias, kRelu, kRequant, kClamp };
+
+    struct Op {
+        OpKind kind;
+        BiasRef bias;
+        RequantParams requant;
+        int8_t lo;
+        int8_t hi;
+    };
+
+    GemmExpr(const MatrixRef& a, const MatrixRef& b) : a_(a), b_(b), num_ops_(0), overflow_(false) {}
+
+    GemmExpr With(const Op& op) const {
+        GemmExpr e = *this;
+        if (e.num_ops_ == kMaxExprOps) {
+            e.overflow_ = true;
+        } else {
+            e.ops_[e.num_ops_++] = op;
+        }
+        return e;
+    }
+
+    int NumOps() const { return num_ops_; }
+
+    // The result is int8 once requantized
+    bool Int8Output() const {
+        for (int i = 0; i < num_ops_; i++) {
+            if (ops_[i].kind == kRequant) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Leading operations the output stage applies; the rest run on the CPU
+    int FusedOps() const {
+        int stage = 0;  // 1 = bias added, 2 = relu, 3 = requantized
+        int fused = 0;
+        for (; fused < num_ops_; fused++) {
+            OpKind kind = ops_[fused].kind;
+            if (kind == kBias && stage < 1) {
+                stage = 1;
+            } else if (kind == kRelu) {
+                stage = stage < 2 ? 2 : stage;
+            } else if (kind == kRequant && stage < 3) {
+                stage = 3;
+            } else if (kind != kClamp || stage != 3) {
+                break;
+            }
+        }
+        return fused;
+    }
+
+    // Job for the fused prefix. C goes to out, or as int32 to scratch when
+    // CPU passes must requantize afterwards.
+    int Plan(const OutputRef& out, const OutputRef* scratch, gemm_config_t* config) const {
+        if (!Valid()) {
+            return -1;
+        }
+        int fused = FusedOps();
+        bool hw_int8 = false;
+        for (int i = 0; i < fused; i++) {
+            hw_int8 = hw_int8 || ops_[i].kind == kRequant;
+        }
+        const OutputRef* dst = &out;
+        if (Int8Output() && !hw_int8) {
+            if (scratch == nullptr) {
+                printf("ERROR: CPU requantization needs an int32 scratch buffer\n");
+                return -1;
+            }
+            dst = scratch;
+        }
+
+        gemm_config_t c = {};
+        c.matrix_a_addr = a_.addr;
+        c.matrix_b_addr = b_.addr;
+        c.matrix_c_addr = dst->addr;
+        c.m_dim = a_.rows;
+        c.k_dim = a_.cols;
+        c.n_dim = b_.cols;
+        c.data_type = a_.data_type;
+        c.stride_a = a_.stride;
+        c.stride_b = b_.stride;
+        c.stride_c = dst->stride;
+        c.out_min = INT8_MIN;
+        c.out_max = INT8_MAX;
+        for (int i = 0; i < fused; i++) {
+            const Op& op = ops_[i];
+            switch (op.kind) {
+                case kBias:
+                    c.out_bias = 1;
+                    c.out_bias_addr = op.bias.addr;
+                    break;
+                case kRelu:
+                    if (c.out_requant) {
+                        // relu of int8 is a clamp at the zero point
+                        c.out_min = c.out_min > c.out_zero_point ? c.out_min : c.out_zero_point;
+                    } else {
+                        c.out_relu = 1;
+                    }
+                    break;
+                case kRequant:
+                    c.out_requant = 1;
+                    c.out_multiplier = op.requant.multiplier;
+                    c.out_shift = op.requant.shift;
+                    c.out_zero_point = op.requant.zero_point;
+                    break;
+                case kClamp:
+                    c.out_min = c.out_min > op.lo ? c.out_min : op.lo;
+                    c.out_max = c.out_max < op.hi ? c.out_max : op.hi;
+                    break;
+            }
+        }
+        *config = c;
+        return 0;
+    }
+
+    // Run the fused job, then the remaining operations on the CPU
+    int Eval(const OutputRef& out, const OutputRef* scratch = nullptr) const {
+        gemm_config_t config;
+        if (Plan(out, scratch, &config) != 0 ||
+            gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+            return -1;
+        }
+
+        int fused = FusedOps();
+        if (fused == num_ops_) {
+            return 0;
+        }
+        bool from_scratch = config.matrix_c_addr != out.addr;
+        const int32_t* src = static_cast<const int32_t*>(from_scratch ? scratch->data : out.data);
+        uint16_t src_stride = from_scratch ? scratch->stride : out.stride;
+        for (uint32_t m = 0; m < a_.rows; m++) {
+            for (uint32_t n = 0; n < b_.cols; n++) {
+                int32_t x = src[m * src_stride + n];
+                int8_t q = 0;
+                int8_t zero_point = 0;
+                bool quantized = false;
+                for (int i = fused; i < num_ops_; i++) {
+                    const Op& op = ops_[i];
+                    if (op.kind == kBias) {
+                        x = (int32_t)((uint32_t)x + (uint32_t)op.bias.data[n]);
+                    } else if (op.kind == kRequant) {
+                        q = RequantizeValue(x, op.requant, INT8_MIN, INT8_MAX);
+                        zero_point = op.requant.zero_point;
+                        quantized = true;
+                    } else if (op.kind == kClamp) {
+                        q = q < op.lo ? op.lo : q > op.hi ? op.hi : q;
+                    } else if (quantized) {
+                        q = q < zero_point ? zero_point : q;
+                    } else {
+                        x = x < 0 ? 0 : x;
+                    }
+                }
+                if (quantized) {
+                    static_cast<int8_t*>(out.data)[m * out.stride + n] = q;
+                } else {
+                    static_cast<int32_t*>(out.data)[m * out.stride + n] = x;
+                }
+            }
+        }
+        return 0;
+    }
+
+private:
+    // int8/int16 operands of matching shape; requantization must come once,
+    // followed only by relu and clamp, and a clamp needs int8 values
+    bool Valid() const {
+        if (overflow_) {
+            printf("ERROR: Expression exceeds %d operations\n", kMaxExprOps);
+            return false;
+        }
+        if ((a_.data_type != GEMM_DATA_TYPE_INT8 && a_.data_type != GEMM_DATA_TYPE_INT16) ||
+            b_.data_type != a_.data_type || a_.cols != b_.rows) {
+            printf("ERROR: GEMM operands must be int8 or int16 with matching shapes\n");
+            return false;
+        }
+        bool quantized = false;
+        for (int i = 0; i < num_ops_; i++) {
+            OpKind kind = ops_[i].kind;
+            bool ok = quantized ? (kind == kRelu || kind == kClamp) :
+                                  (kind != kClamp && (kind != kBias || ops_[i].bias.data != nullptr));
+            if (kind == kClamp && ops_[i].lo > ops_[i].hi) {
+                ok = false;
+            }
+            if (!ok) {
+                printf("ERROR: Unsupported operation order in GEMM expression\n");
+                return false;
+            }
+            quantized = quantized || kind == kRequant;
+        }
+        return true;
+    }
+
+    MatrixRef a_;
+    MatrixRef b_;
+    Op ops_[kMaxExprOps];
+    int num_ops_;
+    bool overflow_;
+};
+
+inline GemmExpr gemm(const MatrixRef& a, const MatrixRef& b) {
+    return GemmExpr(a, b);
+}
+
+inline GemmExpr operator+(const GemmExpr& e, const BiasRef& bias) {
+    GemmExpr::Op op = {GemmExpr::kBias, bias, {0, 0, 0}, 0, 0};
+    return e.With(op);
+}
+
+inline GemmExpr relu(const GemmExpr& e) {
+    GemmExpr::Op op = {GemmExpr::kRelu, {nullptr, 0}, {0, 0, 0}, 0, 0};
+    return e.With(op);
+}
+
+inline GemmExpr requant(const GemmExpr& e, const RequantParams& params) {
+    GemmExpr::Op op = {GemmExpr::kRequant, {nullptr, 0}, params, 0, 0};
+    return e.With(op);
+}
+
+inline GemmExpr clamp(const GemmExpr& e, int8_t lo, int8_t hi) {
+    GemmExpr::Op op = {GemmExpr::kClamp, {nullptr, 0}, {0, 0, 0}, lo, hi};
+    return e.With(op);
+}
+
+} // namespace gemm_accel
+} // namespace tflite
+
+#endif // GEMM_EXPR_H
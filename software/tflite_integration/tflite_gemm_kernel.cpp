@@ -8,8 +8,11 @@
 #include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
 #include "tensorflow/lite/micro/micro_log.h"
 #include "tensorflow/lite/micro/micro_utils.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+#include <string.h>
 
 namespace tflite {
 namespace ops {
@@ -17,12 +20,18 @@ namespace micro {
 
 // Custom GEMM kernel implementation
 TfLiteStatus EvalCustomGemm(TfLiteContext* context, TfLiteNode* node) {
-    const TfLiteTensor* input_a = GetInput(context, node, 0);
-    const TfLiteTensor* input_b = GetInput(context, node, 1);
+    // Embedding form takes (indices, table, B): the DMA gathers the indexed
+    // table rows as A, so lookup and projection run as one job
+    const bool gather = node->inputs->size == 3;
+    const TfLiteTensor* indices = gather ? GetInput(context, node, 0) : nullptr;
+    const TfLiteTensor* input_a = GetInput(context, node, gather ? 1 : 0);
+    const TfLiteTensor* input_b = GetInput(context, node, gather ? 2 : 1);
     TfLiteTensor* output = GetOutput(context, node, 0);
     
     // Validate tensors
-    TfLiteStatus status = gemm_accel::ValidateTensors(input_a, input_b, output);
+    TfLiteStatus status = gather ?
+        gemm_accel::ValidateGatherTensors(indices, input_a, input_b, output) :
+        gemm_accel::ValidateTensors(input_a, input_b, output);
     if (status != kTfLiteOk) {
         MicroPrintf("Tensor validation failed");
         return status;
@@ -33,7 +42,7 @@ TfLiteStatus EvalCustomGemm(TfLiteContext* context, TfLiteNode* node) {
     const RuntimeShape& input_b_shape = GetTensorShape(input_b);
     const RuntimeShape& output_shape = GetTensorShape(output);
     
-    int m = input_a_shape.Dims(0);
+    int m = output_shape.Dims(0);
     int k = input_a_shape.Dims(1);
     int n = input_b_shape.Dims(1);
     
@@ -43,6 +52,21 @@ TfLiteStatus EvalCustomGemm(TfLiteContext* context, TfLiteNode* node) {
     gemm_config_t config = gemm_accel::ConvertToAccelConfig(
         input_a, input_b, output, nullptr
     );
+    if (gather) {
+        config.m_dim = m;
+        config.gather_index_addr = (uint32_t)indices->data.data;
+        config.gather_table_rows = input_a_shape.Dims(0);
+    }
+    
+    // Write straight into the concatenation output when planned
+    const gemm_accel::ConcatAlias* alias = gemm_accel::FindConcatAlias(node->outputs->data[0]);
+    if (alias != nullptr) {
+        gemm_output_view_t view = {alias->concat_addr, alias->row_pitch, 0, alias->col_offset};
+        if (gemm_accel_set_output_view(&config, &view) != 0) {
+            MicroPrintf("Invalid concatenation alias");
+            return kTfLiteError;
+        }
+    }
     
     // Initialize accelerator if not already done
     static bool accel_initialized = false;
@@ -54,6 +78,9 @@ TfLiteStatus EvalCustomGemm(TfLiteContext* context, TfLiteNode* node) {
         accel_initialized = true;
     }
     
+    gemm_accel::ArenaFootprint footprint(input_a->bytes + input_b->bytes + output->bytes +
+                                         (gather ? indices->bytes : 0));
+    
     // Start GEMM operation
     if (gemm_accel_start(&config) != 0) {
         MicroPrintf("Failed to start GEMM operation");
@@ -70,6 +97,116 @@ TfLiteStatus EvalCustomGemm(TfLiteContext* context, TfLiteNode* node) {
     return kTfLiteOk;
 }
 
+// Per-node state of a BNN layer
+struct BnnOpData {
+    uint8_t data_type;          // GEMM_DATA_TYPE_BINARY or _TERNARY
+    int packed_input_index;     // Scratch buffer for the packed activations
+};
+
+void* InitBnnGemm(TfLiteContext* context, const char* buffer, size_t length) {
+    BnnOpData* data = static_cast<BnnOpData*>(
+        context->AllocatePersistentBuffer(context, sizeof(BnnOpData)));
+    if (data == nullptr) {
+        return nullptr;
+    }
+    data->data_type = (length > 0 && buffer[0] == gemm_accel::kBnnOptionTernary) ?
+                      GEMM_DATA_TYPE_TERNARY : GEMM_DATA_TYPE_BINARY;
+    data->packed_input_index = -1;
+    return data;
+}
+
+TfLiteStatus PrepareBnnGemm(TfLiteContext* context, TfLiteNode* node) {
+    BnnOpData* data = static_cast<BnnOpData*>(node->user_data);
+    const TfLiteTensor* input = GetInput(context, node, 0);
+    const TfLiteTensor* weights = GetInput(context, node, 1);
+    const TfLiteTensor* output = GetOutput(context, node, 0);
+    
+    TF_LITE_ENSURE(context, data != nullptr);
+    TF_LITE_ENSURE_OK(context, gemm_accel::ValidateBnnTensors(input, weights, output, data->data_type));
+    
+    // Activations are packed per invocation, one packed row per input row
+    const RuntimeShape& input_shape = GetTensorShape(input);
+    size_t bytes = (size_t)input_shape.Dims(0) *
+                   gemm_bnn_row_bytes(input_shape.Dims(1), data->data_type);
+    return context->RequestScratchBufferInArena(context, bytes, &data->packed_input_index);
+}
+
+// BNN layer: pack activations, then one XNOR-popcount job
+TfLiteStatus EvalBnnGemm(TfLiteContext* context, TfLiteNode* node) {
+    const BnnOpData* data = static_cast<const BnnOpData*>(node->user_data);
+    const TfLiteTensor* input = GetInput(context, node, 0);
+    const TfLiteTensor* weights = GetInput(context, node, 1);
+    TfLiteTensor* output = GetOutput(context, node, 0);
+    
+    const RuntimeShape& input_shape = GetTensorShape(input);
+    const RuntimeShape& output_shape = GetTensorShape(output);
+    int m = input_shape.Dims(0);
+    int k = input_shape.Dims(1);
+    int n = output_shape.Dims(1);
+    uint16_t row_bytes = gemm_bnn_row_bytes(k, data->data_type);
+    
+    uint8_t* packed = static_cast<uint8_t*>(context->GetScratchBuffer(context, data->packed_input_index));
+    if (gemm_pack_bnn(GetTensorData<int8_t>(input), m, k, k, 1, data->data_type, packed) != 0) {
+        MicroPrintf("Activations are not binary/ternary");
+        return kTfLiteError;
+    }
+    
+    gemm_config_t config = {};
+    config.matrix_a_addr = (uint32_t)packed;
+    config.matrix_b_addr = (uint32_t)weights->data.data;
+    config.matrix_c_addr = (uint32_t)output->data.data;
+    config.m_dim = m;
+    config.k_dim = k;
+    config.n_dim = n;
+    config.data_type = data->data_type;
+    config.stride_a = row_bytes;
+    config.stride_b = row_bytes;
+    config.stride_c = n;
+    
+    gemm_accel::ArenaFootprint footprint(input->bytes + weights->bytes + output->bytes +
+                                         (uint32_t)m * row_bytes);
+    if (gemm_accel_init() != 0 || gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+        MicroPrintf("BNN GEMM operation failed");
+        return kTfLiteError;
+    }
+    return kTfLiteOk;
+}
+
+TfLiteRegistration* Register_BNN_GEMM() {
+    static TfLiteRegistration r = {
+        InitBnnGemm,     // init
+        nullptr,         // free
+        PrepareBnnGemm,  // prepare
+        EvalBnnGemm,     // invoke
+    };
+    return &r;
+}
+
+// Stock concatenation invoke, used when the copy cannot be elided
+static TfLiteStatus (*concat_invoke)(TfLiteContext* context, TfLiteNode* node) = nullptr;
+
+// Concatenation whose inputs were already written in place
+TfLiteStatus EvalConcatAliased(TfLiteContext* context, TfLiteNode* node) {
+    const int concat_output = node->outputs->data[0];
+    
+    for (int i = 0; i < node->inputs->size; i++) {
+        const gemm_accel::ConcatAlias* alias = gemm_accel::FindConcatAlias(node->inputs->data[i]);
+        if (alias == nullptr || alias->concat_output != concat_output) {
+            return concat_invoke(context, node);
+        }
+    }
+    return kTfLiteOk; // Branch GEMMs already wrote the output
+}
+
+TfLiteRegistration* Register_CONCATENATION_ALIASED() {
+    static TfLiteRegistration r = Register_CONCATENATION();
+    if (concat_invoke == nullptr) {
+        concat_invoke = r.invoke;
+        r.invoke = EvalConcatAliased;
+    }
+    return &r;
+}
+
 // Register custom GEMM kernel
 TfLiteRegistration* Register_CUSTOM_GEMM() {
     static TfLiteRegistration r = {
@@ -86,6 +223,147 @@ TfLiteRegistration* Register_CUSTOM_GEMM() {
 
 namespace gemm_accel {
 
+static ConcatAliasPlan concat_plan = {};
+
+static bool IsGemmOp(const Model* model, const Operator* op) {
+    const OperatorCode* opcode = model->operator_codes()->Get(op->opcode_index());
+    return GetBuiltinCode(opcode) == BuiltinOperator_CUSTOM &&
+           opcode->custom_code() != nullptr &&
+           strcmp(opcode->custom_code()->c_str(), kCustomGemmOpName) == 0;
+}
+
+static bool Overlaps(const TfLiteTensor* a, const TfLiteTensor* b) {
+    uintptr_t a_start = (uintptr_t)a->data.data, b_start = (uintptr_t)b->data.data;
+    return a_start < b_start + b->bytes && b_start < a_start + a->bytes;
+}
+
+// Plan in-place writes of GEMM branch outputs into concatenation tensors
+int PlanConcatAliases(const Model* model, MicroInterpreter* interpreter) {
+    const SubGraph* subgraph = model->subgraphs()->Get(0);
+    const auto* operators = subgraph->operators();
+    const auto* tensors = subgraph->tensors();
+    const int num_ops = operators->size();
+    const int num_tensors = tensors->size();
+    int elided = 0;
+    
+    concat_plan.count = 0;
+    if (num_tensors > kMaxPlanTensors) {
+        MicroPrintf("Model too large for concatenation aliasing");
+        return 0;
+    }
+    
+    // Producer, consumer count and live operator range of every tensor
+    static int producer[kMaxPlanTensors];
+    static int consumers[kMaxPlanTensors];
+    static int first_live[kMaxPlanTensors];
+    static int last_live[kMaxPlanTensors];
+    for (int t = 0; t < num_tensors; t++) {
+        producer[t] = -1;
+        consumers[t] = 0;
+        first_live[t] = -1;
+        last_live[t] = -1;
+    }
+    for (int i = 0; i < num_ops; i++) {
+        const Operator* op = operators->Get(i);
+        for (int t : *op->outputs()) {
+            producer[t] = i;
+            first_live[t] = i;
+        }
+        for (int t : *op->inputs()) {
+            if (t >= 0) {
+                consumers[t]++;
+                last_live[t] = i;
+            }
+        }
+    }
+    for (int t : *subgraph->outputs()) {
+        last_live[t] = num_ops;
+        consumers[t]++; // Graph outputs keep their own buffer
+    }
+    
+    for (int i = 0; i < num_ops; i++) {
+        const Operator* op = operators->Get(i);
+        const OperatorCode* opcode = model->operator_codes()->Get(op->opcode_index());
+        if (GetBuiltinCode(opcode) != BuiltinOperator_CONCATENATION) {
+            continue;
+        }
+        
+        // 2D int32 concatenation along the last axis, no fused activation
+        const ConcatenationOptions* options = op->builtin_options_as_ConcatenationOptions();
+        const int concat_output = op->outputs()->Get(0);
+        const Tensor* out = tensors->Get(concat_output);
+        if (options == nullptr || (options->axis() != 1 && options->axis() != -1) ||
+            options->fused_activation_function() != ActivationFunctionType_NONE ||
+            out->type() != TensorType_INT32 || out->shape()->size() != 2) {
+            continue;
+        }
+        
+        // Every input must be a GEMM output read only by this concatenation
+        bool eligible = concat_plan.count + (int)op->inputs()->size() <= kMaxConcatAliases;
+        int first_branch = i;
+        for (int t : *op->inputs()) {
+            if (!eligible) {
+                break;
+            }
+            eligible = producer[t] >= 0 && consumers[t] == 1 &&
+                       IsGemmOp(model, operators->Get(producer[t]));
+            if (eligible && producer[t] < first_branch) {
+                first_branch = producer[t];
+            }
+        }
+        if (!eligible) {
+            continue;
+        }
+        
+        // The arena planner only reserves the concat buffer from op i on, so
+        // no other tensor may live in it while the branches run
+        const TfLiteTensor* concat_tensor = interpreter->GetTensor(concat_output);
+        for (int t = 0; t < num_tensors && eligible; t++) {
+            bool branch_output = false;
+            for (int b : *op->inputs()) {
+                branch_output |= (b == t);
+            }
+            if (t == concat_output || branch_output ||
+                last_live[t] < first_branch || first_live[t] >= i) {
+                continue;
+            }
+            const TfLiteTensor* other = interpreter->GetTensor(t);
+            if (other != nullptr && other->data.data != nullptr && Overlaps(other, concat_tensor)) {
+                eligible = false;
+            }
+        }
+        if (!eligible) {
+            MicroPrintf("Concatenation %d not aliased: arena overlap", i);
+            continue;
+        }
+        
+        uint16_t col = 0;
+        const uint16_t pitch = out->shape()->Get(1);
+        for (int t : *op->inputs()) {
+            ConcatAlias& alias = concat_plan.aliases[concat_plan.count++];
+            alias.gemm_output = t;
+            alias.concat_output = concat_output;
+            alias.concat_addr = (uint32_t)concat_tensor->data.data;
+            alias.row_pitch = pitch;
+            alias.col_offset = col;
+            col += tensors->Get(t)->shape()->Get(1);
+        }
+        elided++;
+    }
+    
+    return elided;
+}
+
+// Alias for a GEMM output tensor
+const ConcatAlias* FindConcatAlias(int gemm_output) {
+    for (int i = 0; i < concat_plan.count; i++) {
+        if (concat_plan.aliases[i].gemm_output == gemm_output) {
+            return &concat_plan.aliases[i];
+        }
+    }
+    return nullptr;
+}
+
 // Convert TfLiteTensor to accelerator configuration
 gemm_config_t ConvertToAccelConfig(
     const TfLiteTensor* input_a,
@@ -93,7 +371,7 @@ gemm_config_t ConvertToAccelConfig(
     const TfLiteTensor* output,
     const TfLiteGemmParams* params
 ) {
-    gemm_config_t config;
+    gemm_config_t config = {};  // No padding
     
     // Set matrix addresses (assuming contiguous memory layout)
     config.matrix_a_addr = (uint32_t)input_a->data.data;
@@ -125,6 +403,92 @@ gemm_config_t ConvertToAccelConfig(
     return config;
 }
 
+// Validate the BNN layer tensors against the packed row size
+TfLiteStatus ValidateBnnTensors(
+    const TfLiteTensor* input,
+    const TfLiteTensor* weights,
+    const TfLiteTensor* output,
+    uint8_t data_type
+) {
+    if (input == nullptr || weights == nullptr || output == nullptr) {
+        return kTfLiteError;
+    }
+    
+    if (input->type != kTfLiteInt8 || weights->type != kTfLiteUInt8 || output->type != kTfLiteInt32) {
+        MicroPrintf("BNN layer needs int8 input, packed uint8 weights and int32 output");
+        return kTfLiteError;
+    }
+    
+    const RuntimeShape& input_shape = GetTensorShape(input);
+    const RuntimeShape& weights_shape = GetTensorShape(weights);
+    const RuntimeShape& output_shape = GetTensorShape(output);
+    
+    if (input_shape.DimensionsCount() != 2 || weights_shape.DimensionsCount() != 2 ||
+        output_shape.DimensionsCount() != 2) {
+        MicroPrintf("BNN input, weights and output must be 2D tensors");
+        return kTfLiteError;
+    }
+    
+    if (weights_shape.Dims(1) != gemm_bnn_row_bytes(input_shape.Dims(1), data_type)) {
+        MicroPrintf("Packed weight rows must be %d bytes",
+                    gemm_bnn_row_bytes(input_shape.Dims(1), data_type));
+        return kTfLiteError;
+    }
+    
+    if (output_shape.Dims(0) != input_shape.Dims(0) || output_shape.Dims(1) != weights_shape.Dims(0)) {
+        MicroPrintf("Output dimensions mismatch");
+        return kTfLiteError;
+    }
+    
+    return kTfLiteOk;
+}
+
+// Validate the (indices, table, B) embedding form
+TfLiteStatus ValidateGatherTensors(
+    const TfLiteTensor* indices,
+    const TfLiteTensor* table,
+    const TfLiteTensor* input_b,
+    const TfLiteTensor* output
+) {
+    if (indices == nullptr || table == nullptr || input_b == nullptr || output == nullptr) {
+        return kTfLiteError;
+    }
+    
+    if (indices->type != kTfLiteInt32 || GetTensorShape(indices).DimensionsCount() != 1) {
+        MicroPrintf("Gather indices must be a 1D int32 tensor");
+        return kTfLiteError;
+    }
+    
+    if (table->type != input_b->type ||
+        (table->type != kTfLiteInt8 && table->type != kTfLiteInt16)) {
+        MicroPrintf("Unsupported embedding table type: %d", table->type);
+        return kTfLiteError;
+    }
+    
+    const RuntimeShape& table_shape = GetTensorShape(table);
+    const RuntimeShape& input_b_shape = GetTensorShape(input_b);
+    const RuntimeShape& output_shape = GetTensorShape(output);
+    
+    if (table_shape.DimensionsCount() != 2 || input_b_shape.DimensionsCount() != 2 ||
+        output_shape.DimensionsCount() != 2) {
+        MicroPrintf("Embedding table, B and output must be 2D tensors");
+        return kTfLiteError;
+    }
+    
+    if (table_shape.Dims(1) != input_b_shape.Dims(0)) {
+        MicroPrintf("Inner dimensions must match: %d != %d", table_shape.Dims(1), input_b_shape.Dims(0));
+        return kTfLiteError;
+    }
+    
+    if (output_shape.Dims(0) != GetTensorShape(indices).Dims(0) ||
+        output_shape.Dims(1) != input_b_shape.Dims(1)) {
+        MicroPrintf("Output dimensions mismatch");
+        return kTfLiteError;
+    }
+    
+    return kTfLiteOk;
+}
+
 // Validate tensor dimensions and types
 TfLiteStatus ValidateTensors(
     const TfLiteTensor* input_a,
@@ -205,6 +569,14 @@ void CalculatePerformanceMetrics(
     *efficiency = (*gops / theoretical_max_gops) * 100.0f;
 }
 
+// Report the profile against the model's arena
+void PrintMemoryReport(const MicroInterpreter* interpreter, gemm_mem_profile_t* profile) {
+    if (profile->limit[GEMM_MEM_ARENA] == 0) {
+        profile->limit[GEMM_MEM_ARENA] = interpreter->arena_used_bytes();
+    }
+    gemm_mem_profile_report(profile);
+}
+
 } // namespace gemm_accel
 } // namespace tflite
 
@@ -216,6 +588,11 @@ TfLiteRegistration* Register_CUSTOM_GEMM() {
     return tflite::ops::micro::Register_CUSTOM_GEMM();
 }
 
+// Register binary/ternary BNN kernel
+TfLiteRegistration* Register_BNN_GEMM() {
+    return tflite::ops::micro::Register_BNN_GEMM();
+}
+
 // Initialize GEMM accelerator
 int tflite_gemm_accel_init(void) {
     return gemm_accel_init();
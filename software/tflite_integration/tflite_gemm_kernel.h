@@ -7,6 +7,8 @@
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/micro_log.h"
 #include "tensorflow/lite/micro/micro_utils.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
 #include "gemm_accel_driver.h"
 
 // TensorFlow Lite Micro context
@@ -20,6 +22,16 @@ TfLiteRegistration* Register_CUSTOM_GEMM();
 // GEMM kernel implementation
 TfLiteStatus EvalCustomGemm(TfLiteContext* context, TfLiteNode* node);
 
+// Binary/ternary (BNN) fully connected layer on the XNOR-popcount mode
+TfLiteRegistration* Register_BNN_GEMM();
+
+// BNN kernel implementation
+TfLiteStatus EvalBnnGemm(TfLiteContext* context, TfLiteNode* node);
+
+// CONCATENATION kernel that skips the copy when every input was written
+// in place by a GEMM job (falls back to the stock kernel otherwise)
+TfLiteRegistration* Register_CONCATENATION_ALIASED();
+
 } // namespace micro
 } // namespace ops
 } // namespace tflite
@@ -28,6 +40,46 @@ TfLiteStatus EvalCustomGemm(TfLiteContext* context, TfLiteNode* node);
 namespace tflite {
 namespace gemm_accel {
 
+// Custom op name the GEMM kernel is registered under
+constexpr char kCustomGemmOpName[] = "CUSTOM_GEMM";
+
+// Custom op name of the binary/ternary layer. Inputs: int8 activations
+// [M][K] (+1/-1, or -1/0/+1 for ternary), weights packed offline with
+// gemm_pack_bnn as a uint8 [N][row_bytes] tensor; output int32 [M][N].
+// The one-byte custom options select the mode.
+constexpr char kBnnGemmOpName[] = "BNN_GEMM";
+constexpr uint8_t kBnnOptionBinary = 0;
+constexpr uint8_t kBnnOptionTernary = 1;
+
+// Maximum number of GEMM outputs aliased into concatenation tensors
+constexpr int kMaxConcatAliases = 16;
+
+// Largest subgraph the alias planner handles
+constexpr int kMaxPlanTensors = 256;
+
+// GEMM output written directly into a column slice of a concat output
+struct ConcatAlias {
+    int gemm_output;        // Tensor produced by the GEMM op
+    int concat_output;      // Tensor produced by the CONCATENATION op
+    uint32_t concat_addr;   // Concat output buffer (arena address)
+    uint16_t row_pitch;     // Concat output row length (elements)
+    uint16_t col_offset;    // Column of this slice in the concat output
+};
+
+struct ConcatAliasPlan {
+    ConcatAlias aliases[kMaxConcatAliases];
+    int count;
+};
+
+// Find 2D last-axis concatenations whose inputs all come from GEMM ops and
+// alias those outputs into the concat buffer. Call after AllocateTensors();
+// a concat is only aliased if its buffer does not overlap any tensor live
+// while its branches run. Returns the number of concatenations elided.
+int PlanConcatAliases(const Model* model, MicroInterpreter* interpreter);
+
+// Alias for a GEMM output tensor, or nullptr
+const ConcatAlias* FindConcatAlias(int gemm_output);
+
 // Convert TfLiteTensor to accelerator configuration
 gemm_config_t ConvertToAccelConfig(
     const TfLiteTensor* input_a,
@@ -43,6 +95,42 @@ TfLiteStatus ValidateTensors(
     const TfLiteTensor* output
 );
 
+// Validate the BNN layer tensors against the packed row size
+TfLiteStatus ValidateBnnTensors(
+    const TfLiteTensor* input,
+    const TfLiteTensor* weights,
+    const TfLiteTensor* output,
+    uint8_t data_type
+);
+
+// Validate the (indices, table, B) embedding form
+TfLiteStatus ValidateGatherTensors(
+    const TfLiteTensor* indices,
+    const TfLiteTensor* table,
+    const TfLiteTensor* input_b,
+    const TfLiteTensor* output
+);
+
+// Arena bytes held by an accelerator op's tensors, reported to the memory
+// profiler for as long as the op runs
+class ArenaFootprint {
+public:
+    explicit ArenaFootprint(uint32_t bytes) : bytes_(bytes) {
+        gemm_mem_profile_alloc(GEMM_MEM_ARENA, bytes_);
+    }
+    ~ArenaFootprint() {
+        gemm_mem_profile_free(GEMM_MEM_ARENA, bytes_);
+    }
+
+private:
+    uint32_t bytes_;
+};
+
+// Per-model footprint report, after Invoke(). Unless set, the arena limit is
+// what the interpreter uses for the whole model, so the percentage is the
+// share held by accelerator tensors.
+void PrintMemoryReport(const MicroInterpreter* interpreter, gemm_mem_profile_t* profile);
+
 // Calculate performance metrics
 void CalculatePerformanceMetrics(
     int m, int k, int n,
@@ -0,0 +1,435 @@
+// GEMM Accelerator Co-Simulation Harness
+// Verilator model of gemm_accelerator_top checked against the C device model,
+// with checkpoint/restore of the whole simulation
+//
+// The harness resets the accelerator, fills memory with random int8 A and B
+// and programs the job-independent registers ("setup"). Each --job is then
+// started through the register port and polled to completion. With --check
+// the job's memory is compared byte for byte with the device model run on
+// the memory image from the job start; the RTL compute path does not yet
+// write MAC results, so this is opt-in.
+//
+// Built with Verilator --savable, a run can write a checkpoint after setup
+// or at the first STATUS poll at or after a given cycle. A checkpoint holds
+// the RTL state, the AXI memory and in-flight bursts, and the harness state
+// including any running job. Restoring one skips reset and setup, so one
+// setup run can be forked into many continuations:
+//
+//   gemm_cosim --save setup.ckpt
+//   gemm_cosim --restore setup.ckpt --job 32x128x64
+//   gemm_cosim --restore setup.ckpt --check --job 16x256x32 --job 8x8x8
+
+#include "Vgemm_accelerator_top.h"
+#include "verilated.h"
+#include "verilated_save.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "gemm_device_model.h"
+#include "gemm_accel_driver.h"
+}
+
+// Memory behind the AXI port: A, B and C regions of 256 KB
+#define MEM_BASE        0x80000000u
+#define MEM_SIZE        (1u << 20)
+#define A_ADDR          MEM_BASE
+#define B_ADDR          (MEM_BASE + 0x40000)
+#define C_ADDR          (MEM_BASE + 0x80000)
+
+#define BUS_BYTES       32              // AXI_DATA_WIDTH / 8
+#define RESET_CYCLES    16
+#define JOB_TIMEOUT     20000000ull     // Cycles
+#define CKPT_MAGIC      0x47434b50u     // "GCKP"
+#define REG_OFFSET(reg) ((reg) - GEMM_ACCEL_BASE_ADDR)
+
+struct Job {
+    uint16_t m, k, n;
+};
+
+// AXI burst: INCR, beats of 2^size bytes
+struct Burst {
+    uint32_t addr;
+    uint32_t beats;
+    uint32_t size;
+};
+
+// Harness state saved with the RTL state
+struct HarnessState {
+    uint64_t cycle;
+    uint32_t regs[GEMM_MODEL_NUM_REGS]; // Values written, replayed on the reference
+    uint32_t b_pending;                 // Write responses owed
+    uint32_t jobs_done;
+    bool job_active;
+    bool job_checked;                   // expected holds the model result
+    Job job;
+    uint64_t job_start;
+};
+
+static Vgemm_accelerator_top* top;
+static HarnessState hs;
+static std::vector<uint8_t> mem(MEM_SIZE);
+static std::vector<uint8_t> expected(MEM_SIZE);  // Reference image of the running job
+static std::deque<Burst> rd_bursts;
+static std::deque<Burst> wr_bursts;
+
+static std::string save_path;
+static int64_t save_at = -1;            // Cycle; 0 = after setup
+static bool saved;
+static bool check;                      // Compare jobs with the device model
+
+static uint8_t* mem_ptr(uint32_t addr) {
+    if (addr < MEM_BASE || addr - MEM_BASE >= MEM_SIZE) {
+        return nullptr;
+    }
+    return &mem[addr - MEM_BASE];
+}
+
+// One bus clock (the compute clock runs in phase), serving the AXI port
+static void tick() {
+    top->clk = 0;
+    top->compute_clk = 0;
+    top->eval();
+
+    bool ar_fire = top->mem_arvalid && top->mem_arready;
+    bool r_fire = top->mem_rvalid && top->mem_rready;
+    bool aw_fire = top->mem_awvalid && top->mem_awready;
+    bool w_fire = top->mem_wvalid && top->mem_wready;
+    bool b_fire = top->mem_bvalid && top->mem_bready;
+    Burst ar = {top->mem_araddr, (uint32_t)top->mem_arlen + 1, top->mem_arsize};
+    Burst aw = {top->mem_awaddr, (uint32_t)top->mem_awlen + 1, top->mem_awsize};
+    uint32_t wstrb = top->mem_wstrb;
+    uint8_t wdata[BUS_BYTES];
+    memcpy(wdata, &top->mem_wdata[0], BUS_BYTES);
+    bool wlast = top->mem_wlast;
+
+    top->clk = 1;
+    top->compute_clk = 1;
+    top->eval();
+    hs.cycle++;
+
+    if (ar_fire) {
+        rd_bursts.push_back(ar);
+    }
+    if (r_fire) {
+        Burst& b = rd_bursts.front();
+        b.addr += 1u << b.size;
+        if (--b.beats == 0) {
+            rd_bursts.pop_front();
+        }
+    }
+    if (aw_fire) {
+        wr_bursts.push_back(aw);
+    }
+    if (w_fire) {
+        Burst& b = wr_bursts.front();
+        uint32_t line = b.addr & ~(BUS_BYTES - 1);
+        for (uint32_t i = 0; i < BUS_BYTES; i++) {
+            uint8_t* p = mem_ptr(line + i);
+            if ((wstrb >> i & 1) && p != nullptr) {
+                *p = wdata[i];
+            }
+        }
+        b.addr += 1u << b.size;
+        if (--b.beats == 0 || wlast) {
+            wr_bursts.pop_front();
+            hs.b_pending++;
+        }
+    }
+    if (b_fire) {
+        hs.b_pending--;
+    }
+
+    // Next cycle's responses: full bus lines from the aligned address
+    top->mem_arready = 1;
+    top->mem_awready = 1;
+    top->mem_wready = !wr_bursts.empty();
+    top->mem_bvalid = hs.b_pending != 0;
+    top->mem_rvalid = !rd_bursts.empty();
+    if (top->mem_rvalid) {
+        const Burst& b = rd_bursts.front();
+        uint32_t line = b.addr & ~(BUS_BYTES - 1);
+        uint8_t rdata[BUS_BYTES];
+        for (uint32_t i = 0; i < BUS_BYTES; i++) {
+            uint8_t* p = mem_ptr(line + i);
+            rdata[i] = p != nullptr ? *p : 0;
+        }
+        memcpy(&top->mem_rdata[0], rdata, BUS_BYTES);
+        top->mem_rlast = b.beats == 1;
+    } else {
+        top->mem_rlast = 0;
+    }
+}
+
+static void reg_write(uint32_t reg, uint32_t value) {
+    uint32_t offset = REG_OFFSET(reg);
+    top->reg_addr = offset;
+    top->reg_wr_data = value;
+    top->reg_wr_en = 1;
+    tick();
+    top->reg_wr_en = 0;
+    if (offset / 4 < GEMM_MODEL_NUM_REGS) {
+        hs.regs[offset / 4] = value;
+    }
+}
+
+static uint32_t reg_read(uint32_t reg) {
+    top->reg_addr = REG_OFFSET(reg);
+    top->reg_rd_en = 1;
+    tick();
+    top->reg_rd_en = 0;
+    while (!top->reg_rd_valid) {
+        tick();
+    }
+    return top->reg_rd_data;
+}
+
+// Checkpoint: RTL state, then harness state, memory and bursts
+
+static void write_bursts(VerilatedSave& os, const std::deque<Burst>& q) {
+    uint32_t count = q.size();
+    os.write(&count, sizeof(count));
+    for (const Burst& b : q) {
+        os.write(&b, sizeof(b));
+    }
+}
+
+static void read_bursts(VerilatedRestore& is, std::deque<Burst>& q) {
+    uint32_t count;
+    is.read(&count, sizeof(count));
+    q.resize(count);
+    for (Burst& b : q) {
+        is.read(&b, sizeof(b));
+    }
+}
+
+static int save_checkpoint(const char* path) {
+    VerilatedSave os;
+    os.open(path);
+    if (!os.isOpen()) {
+        printf("ERROR: Cannot write checkpoint %s\n", path);
+        return -1;
+    }
+    uint32_t magic = CKPT_MAGIC;
+    os << *top;
+    os.write(&magic, sizeof(magic));
+    os.write(&hs, sizeof(hs));
+    os.write(mem.data(), MEM_SIZE);
+    if (hs.job_active && hs.job_checked) {
+        os.write(expected.data(), MEM_SIZE);
+    }
+    write_bursts(os, rd_bursts);
+    write_bursts(os, wr_bursts);
+    os.close();
+    printf("Checkpoint %s at cycle %llu\n", path, (unsigned long long)hs.cycle);
+    return 0;
+}
+
+static int restore_checkpoint(const char* path) {
+    VerilatedRestore is;
+    is.open(path);
+    if (!is.isOpen()) {
+        printf("ERROR: Cannot read checkpoint %s\n", path);
+        return -1;
+    }
+    uint32_t magic = 0;
+    is >> *top;
+    is.read(&magic, sizeof(magic));
+    if (magic != CKPT_MAGIC) {
+        printf("ERROR: %s is not a harness checkpoint\n", path);
+        return -1;
+    }
+    is.read(&hs, sizeof(hs));
+    is.read(mem.data(), MEM_SIZE);
+    if (hs.job_active && hs.job_checked) {
+        is.read(expected.data(), MEM_SIZE);
+    }
+    read_bursts(is, rd_bursts);
+    read_bursts(is, wr_bursts);
+    is.close();
+    printf("Restored %s at cycle %llu\n", path, (unsigned long long)hs.cycle);
+    return 0;
+}
+
+// Jobs
+
+static bool job_fits(const Job& job) {
+    uint32_t half_bytes = GEMM_SCRATCHPAD_HALF_LINES * GEMM_SCRATCHPAD_LINE_BYTES;
+    uint32_t c_row_lines = (job.n * 4 + GEMM_SCRATCHPAD_LINE_BYTES - 1) / GEMM_SCRATCHPAD_LINE_BYTES;
+    return job.m != 0 && job.k != 0 && job.n != 0 &&
+           (uint32_t)job.m * job.k <= half_bytes && (uint32_t)job.k * job.n <= half_bytes &&
+           job.m * c_row_lines <= GEMM_SCRATCHPAD_HALF_LINES;
+}
+
+// Reference: the device model over a copy of memory with the same registers
+static void run_reference() {
+    static gemm_device_model_t ref;
+    expected = mem;
+    gemm_model_init(&ref, expected.data(), MEM_BASE, MEM_SIZE);
+    for (uint32_t i = 1; i < GEMM_MODEL_NUM_REGS; i++) {
+        gemm_model_reg_write(&ref, i * 4, hs.regs[i]);
+    }
+    gemm_model_reg_write(&ref, REG_OFFSET(GEMM_CTRL_REG), GEMM_CTRL_START);
+}
+
+static void start_job(const Job& job) {
+    reg_write(GEMM_M_DIM_REG, job.m);
+    reg_write(GEMM_K_DIM_REG, job.k);
+    reg_write(GEMM_N_DIM_REG, job.n);
+    reg_write(GEMM_STRIDE_A_REG, job.k);
+    reg_write(GEMM_STRIDE_B_REG, job.n);
+    reg_write(GEMM_STRIDE_C_REG, job.n);
+    if (check) {
+        run_reference();
+    }
+    hs.job = job;
+    hs.job_active = true;
+    hs.job_checked = check;
+    hs.job_start = hs.cycle;
+    reg_write(GEMM_CTRL_REG, GEMM_CTRL_START);
+}
+
+// Poll STATUS until the running job finishes, checkpointing on the way
+static int finish_job() {
+    uint32_t status;
+    do {
+        if (!saved && save_at > 0 && hs.cycle >= (uint64_t)save_at) {
+            if (save_checkpoint(save_path.c_str()) != 0) {
+                return -1;
+            }
+            saved = true;
+        }
+        if (hs.cycle - hs.job_start > JOB_TIMEOUT) {
+            printf("ERROR: Job %ux%ux%u timed out\n", hs.job.m, hs.job.k, hs.job.n);
+            return -1;
+        }
+        status = reg_read(GEMM_STATUS_REG);
+    } while (!(status & GEMM_STATUS_DONE));
+
+    hs.job_active = false;
+    hs.jobs_done++;
+    uint32_t diffs = 0;
+    for (uint32_t i = 0; hs.job_checked && i < MEM_SIZE; i++) {
+        if (mem[i] != expected[i]) {
+            if (diffs < 10) {
+                printf("ERROR: 0x%08x = 0x%02x, model 0x%02x\n", MEM_BASE + i, mem[i], expected[i]);
+            }
+            diffs++;
+        }
+    }
+    printf("Job %ux%ux%u: %llu cycles, %s\n", hs.job.m, hs.job.k, hs.job.n,
+           (unsigned long long)(hs.cycle - hs.job_start),
+           !hs.job_checked ? "done" : diffs == 0 ? "PASS" : "FAIL");
+    if ((status & GEMM_STATUS_ERROR) || diffs != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int run_job(const Job& job) {
+    if (!job_fits(job)) {
+        printf("ERROR: Job %ux%ux%u does not fit the scratchpad\n", job.m, job.k, job.n);
+        return -1;
+    }
+    start_job(job);
+    return finish_job();
+}
+
+// Reset and register programming only, so the setup checkpoint does not
+// depend on any job result
+static void setup() {
+    top->rst_n = 0;
+    for (int i = 0; i < RESET_CYCLES; i++) {
+        tick();
+    }
+    top->rst_n = 1;
+    tick();
+
+    srand(1);
+    for (uint32_t i = 0; i < 2 * 0x40000; i++) {
+        mem[i] = (uint8_t)rand();
+    }
+    reg_write(GEMM_MATRIX_A_ADDR_REG, A_ADDR);
+    reg_write(GEMM_MATRIX_B_ADDR_REG, B_ADDR);
+    reg_write(GEMM_MATRIX_C_ADDR_REG, C_ADDR);
+    reg_write(GEMM_DATA_TYPE_REG, GEMM_DATA_TYPE_INT8);
+}
+
+static bool parse_job(const char* arg, Job* job) {
+    unsigned m, k, n;
+    if (sscanf(arg, "%ux%ux%u", &m, &k, &n) != 3 || m > 0xFFFF || k > 0xFFFF || n > 0xFFFF) {
+        return false;
+    }
+    *job = {(uint16_t)m, (uint16_t)k, (uint16_t)n};
+    return true;
+}
+
+static void usage() {
+    printf("Usage: gemm_cosim [--restore FILE] [--save FILE [--save-at setup|CYCLE]] [--check] [--job MxKxN]...\n");
+}
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+
+    std::string restore_path;
+    std::vector<Job> jobs;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        Job job;
+        if (arg == "--save" && value) {
+            save_path = argv[++i];
+            save_at = save_at < 0 ? 0 : save_at;
+        } else if (arg == "--save-at" && value) {
+            std::string at = argv[++i];
+            save_at = at == "setup" ? 0 : strtoll(at.c_str(), nullptr, 0);
+        } else if (arg == "--restore" && value) {
+            restore_path = argv[++i];
+        } else if (arg == "--check") {
+            check = true;
+        } else if (arg == "--job" && value && parse_job(argv[++i], &job)) {
+            jobs.push_back(job);
+        } else if (arg[0] != '+') { // Plusargs are for Verilator
+            usage();
+            return 1;
+        }
+    }
+    if (save_at >= 0 && save_path.empty()) {
+        usage();
+        return 1;
+    }
+
+    top = new Vgemm_accelerator_top;
+    int result = 0;
+    if (!restore_path.empty()) {
+        result = restore_checkpoint(restore_path.c_str());
+        if (result == 0 && hs.job_active) {
+            result = finish_job();
+        }
+    } else {
+        memset(&hs, 0, sizeof(hs));
+        setup();
+        if (save_at == 0) {
+            result = save_checkpoint(save_path.c_str());
+            saved = true;
+        }
+    }
+
+    for (size_t i = 0; i < jobs.size() && result == 0; i++) {
+        result = run_job(jobs[i]);
+    }
+    if (result == 0 && !saved && save_at > 0) {
+        printf("ERROR: Run ended before cycle %lld\n", (long long)save_at);
+        result = -1;
+    }
+
+    top->final();
+    delete top;
+    printf("%s after %llu cycles\n", result == 0 ? "PASSED" : "FAILED", (unsigned long long)hs.cycle);
+    return result == 0 ? 0 : 1;
+}
@@ -0,0 +1,1255 @@
+// Device Model Tests
+// Runs the driver against the C device model on a Linux host
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gemm_accel_driver.h"
+#include "gemm_device_model.h"
+
+// Modeled physical memory
+#define MEM_BASE        0x80000000u
+#define MEM_PAGES       64
+#define MEM_SIZE        (MEM_PAGES * GEMM_MMU_PAGE_SIZE)
+
+// Page assignment inside modeled memory
+#define L1_PAGE         0
+#define L0_POOL_PAGE    1
+#define L0_POOL_PAGES   3
+#define DATA_PAGE       8
+
+// Device-visible virtual addresses
+#define IOVA_A          0x10000000u
+#define IOVA_B          0x10400000u     // Different L1 slot
+#define IOVA_C          0x10800000u
+
+static uint8_t* mem;
+static gemm_device_model_t* model;
+
+static uint32_t page_phys(int page) {
+    return MEM_BASE + page * GEMM_MMU_PAGE_SIZE;
+}
+
+static void* page_ptr(int page) {
+    return mem + page * GEMM_MMU_PAGE_SIZE;
+}
+
+// Scatter a virtually contiguous buffer over physical pages in reverse order
+static int map_scattered(gemm_page_table_t* pt, uint32_t iova, int first_page,
+                         int num_pages, bool writable) {
+    uint32_t phys[8];
+    for (int i = 0; i < num_pages; i++) {
+        phys[i] = page_phys(first_page + num_pages - 1 - i);
+    }
+    return gemm_accel_mmu_map(pt, iova, phys, num_pages, writable);
+}
+
+// Copy host data into a scattered mapping
+static void copy_to_iova(int first_page, int num_pages, const void* src, uint32_t size) {
+    const uint8_t* bytes = src;
+    for (uint32_t off = 0; off < size; off += GEMM_MMU_PAGE_SIZE) {
+        uint32_t chunk = size - off < GEMM_MMU_PAGE_SIZE ? size - off : GEMM_MMU_PAGE_SIZE;
+        int page = first_page + num_pages - 1 - off / GEMM_MMU_PAGE_SIZE;
+        memcpy(page_ptr(page), bytes + off, chunk);
+    }
+}
+
+// Test 1: GEMM on virtually contiguous, physically scattered buffers
+static int test_scattered_gemm(gemm_page_table_t* pt) {
+    const int M = 72, K = 96, N = 40;
+    int8_t a[72 * 96], b[96 * 40];
+    int32_t ref[72 * 40];
+    int errors = 0;
+
+    for (int i = 0; i < M * K; i++) a[i] = (int8_t)(rand() % 256 - 128);
+    for (int i = 0; i < K * N; i++) b[i] = (int8_t)(rand() % 256 - 128);
+    for (int m = 0; m < M; m++) {
+        for (int n = 0; n < N; n++) {
+            int32_t sum = 0;
+            for (int k = 0; k < K; k++) sum += (int32_t)a[m * K + k] * b[k * N + n];
+            ref[m * N + n] = sum;
+        }
+    }
+
+    // A: 2 pages, B: 1 page, C: 3 pages
+    const int a_page = DATA_PAGE, b_page = DATA_PAGE + 2, c_page = DATA_PAGE + 3;
+    if (map_scattered(pt, IOVA_A, a_page, 2, false) != 0 ||
+        map_scattered(pt, IOVA_B, b_page, 1, false) != 0 ||
+        map_scattered(pt, IOVA_C, c_page, 3, true) != 0) {
+        return 1;
+    }
+    copy_to_iova(a_page, 2, a, sizeof(a));
+    copy_to_iova(b_page, 1, b, sizeof(b));
+    gemm_accel_mmu_enable(pt);
+
+    gemm_config_t config = {
+        .matrix_a_addr = IOVA_A, .matrix_b_addr = IOVA_B, .matrix_c_addr = IOVA_C,
+        .m_dim = M, .k_dim = K, .n_dim = N, .data_type = GEMM_DATA_TYPE_INT8,
+        .stride_a = K, .stride_b = N, .stride_c = N
+    };
+    if (gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+        return 1;
+    }
+
+    // Gather C back from its scattered pages
+    for (int i = 0; i < M * N; i++) {
+        uint32_t off = i * 4;
+        int page = c_page + 2 - off / GEMM_MMU_PAGE_SIZE;
+        int32_t value;
+        memcpy(&value, (uint8_t*)page_ptr(page) + off % GEMM_MMU_PAGE_SIZE, 4);
+        if (value != ref[i]) {
+            if (errors < 10) printf("Error at index %d: HW=%d, REF=%d\n", i, value, ref[i]);
+            errors++;
+        }
+    }
+
+    printf("TLB hits: %llu, misses: %llu\n",
+           (unsigned long long)model->tlb_hits, (unsigned long long)model->tlb_misses);
+    return errors;
+}
+
+// Test 2: Unmapped and read-only accesses raise translation faults
+static int test_faults(gemm_page_table_t* pt) {
+    int errors = 0;
+
+    gemm_config_t config = {
+        .matrix_a_addr = IOVA_A, .matrix_b_addr = IOVA_B, .matrix_c_addr = IOVA_B,
+        .m_dim = 8, .k_dim = 8, .n_dim = 8, .data_type = GEMM_DATA_TYPE_INT8,
+        .stride_a = 8, .stride_b = 8, .stride_c = 8
+    };
+
+    // Write to read-only B mapping
+    gemm_accel_mmu_enable(pt);
+    gemm_accel_start(&config);
+    if (gemm_accel_wait() == 0 || gemm_accel_mmu_fault_addr() != IOVA_B) {
+        printf("ERROR: Read-only write not faulted\n");
+        errors++;
+    }
+
+    // Read from unmapped A after unmap
+    gemm_accel_mmu_unmap(pt, IOVA_A, 2);
+    gemm_accel_mmu_enable(pt);
+    config.matrix_c_addr = IOVA_C;
+    gemm_accel_start(&config);
+    if (gemm_accel_wait() == 0 || gemm_accel_mmu_fault_addr() != IOVA_A) {
+        printf("ERROR: Unmapped read not faulted\n");
+        errors++;
+    }
+
+    gemm_accel_mmu_disable();
+    return errors;
+}
+
+// Test 3: SAME-padded input read without a padded copy
+static int test_padding(void) {
+    const int H = 6, W = 10, PITCH = 12;    // Interior rows in memory
+    const int PT = 1, PB = 1, PL = 2, PR = 1;
+    const int M = H + PT + PB, K = W + PL + PR, N = 8;
+    int8_t a[6 * 12], b[13 * 8], padded[8 * 13];
+    int errors = 0;
+
+    for (int i = 0; i < H * PITCH; i++) a[i] = (int8_t)(rand() % 256 - 128);
+    for (int i = 0; i < K * N; i++) b[i] = (int8_t)(rand() % 256 - 128);
+
+    // Reference operates on an explicitly padded copy
+    memset(padded, 0, sizeof(padded));
+    for (int r = 0; r < H; r++) {
+        memcpy(&padded[(r + PT) * K + PL], &a[r * PITCH], W);
+    }
+
+    const int a_page = DATA_PAGE, b_page = DATA_PAGE + 1, c_page = DATA_PAGE + 2;
+    memcpy(page_ptr(a_page), a, sizeof(a));
+    memcpy(page_ptr(b_page), b, sizeof(b));
+
+    gemm_config_t config = {
+        .matrix_a_addr = page_phys(a_page), .matrix_b_addr = page_phys(b_page),
+        .matrix_c_addr = page_phys(c_page),
+        .m_dim = M, .k_dim = K, .n_dim = N, .data_type = GEMM_DATA_TYPE_INT8,
+        .stride_a = PITCH, .stride_b = N, .stride_c = N,
+        .pad_top = PT, .pad_bottom = PB, .pad_left = PL, .pad_right = PR
+    };
+    if (gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+        return 1;
+    }
+
+    const int32_t* c = page_ptr(c_page);
+    for (int m = 0; m < M; m++) {
+        for (int n = 0; n < N; n++) {
+            int32_t sum = 0;
+            for (int k = 0; k < K; k++) sum += (int32_t)padded[m * K + k] * b[k * N + n];
+            if (c[m * N + n] != sum) {
+                if (errors < 10) printf("Error at (%d,%d): HW=%d, REF=%d\n", m, n, c[m * N + n], sum);
+                errors++;
+            }
+        }
+    }
+
+    // Padding that leaves no interior is rejected
+    config.pad_left = 8;
+    config.pad_right = 5;
+    if (gemm_accel_start(&config) == 0) {
+        printf("ERROR: Invalid padding accepted\n");
+        errors++;
+    }
+    return errors;
+}
+
+// Test 4: Two branch GEMMs write straight into a concatenation tensor
+static int test_concat_views(void) {
+    const int M = 12, K = 16, N1 = 10, N2 = 6, NC = N1 + N2;
+    int8_t a[12 * 16], b1[16 * 10], b2[16 * 6];
+    int errors = 0;
+
+    for (int i = 0; i < M * K; i++) a[i] = (int8_t)(rand() % 256 - 128);
+    for (int i = 0; i < K * N1; i++) b1[i] = (int8_t)(rand() % 256 - 128);
+    for (int i = 0; i < K * N2; i++) b2[i] = (int8_t)(rand() % 256 - 128);
+
+    const int a_page = DATA_PAGE, b_page = DATA_PAGE + 1, c_page = DATA_PAGE + 2;
+    memcpy(page_ptr(a_page), a, sizeof(a));
+    memcpy(page_ptr(b_page), b1, sizeof(b1));
+    memcpy((uint8_t*)page_ptr(b_page) + 2048, b2, sizeof(b2));
+    memset(page_ptr(c_page), 0xEE, GEMM_MMU_PAGE_SIZE);
+
+    const int8_t* branch_b[2] = {b1, b2};
+    const uint32_t branch_b_addr[2] = {page_phys(b_page), page_phys(b_page) + 2048};
+    const uint16_t branch_n[2] = {N1, N2};
+    const uint16_t branch_col[2] = {0, N1};
+
+    for (int br = 0; br < 2; br++) {
+        gemm_config_t config = {
+            .matrix_a_addr = page_phys(a_page), .matrix_b_addr = branch_b_addr[br],
+            .m_dim = M, .k_dim = K, .n_dim = branch_n[br], .data_type = GEMM_DATA_TYPE_INT8,
+            .stride_a = K, .stride_b = branch_n[br]
+        };
+        gemm_output_view_t view = {
+            .base_addr = page_phys(c_page), .row_pitch = NC,
+            .row_offset = 0, .col_offset = branch_col[br]
+        };
+        if (gemm_accel_set_output_view(&config, &view) != 0 ||
+            gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+            return 1;
+        }
+    }
+
+    // Concatenation along the last axis, with nothing written past the tensor
+    const int32_t* c = page_ptr(c_page);
+    for (int m = 0; m < M; m++) {
+        for (int n = 0; n < NC; n++) {
+            int br = n < N1 ? 0 : 1;
+            int col = n - branch_col[br];
+            int32_t sum = 0;
+            for (int k = 0; k < K; k++) sum += (int32_t)a[m * K + k] * branch_b[br][k * branch_n[br] + col];
+            if (c[m * NC + n] != sum) {
+                if (errors < 10) printf("Error at (%d,%d): HW=%d, REF=%d\n", m, n, c[m * NC + n], sum);
+                errors++;
+            }
+        }
+    }
+    if (((const uint8_t*)c)[M * NC * 4] != 0xEE) {
+        printf("ERROR: Write past concatenation tensor\n");
+        errors++;
+    }
+
+    // A view wider than the parent row is rejected
+    gemm_config_t config = { .n_dim = N2 };
+    gemm_output_view_t view = { .base_addr = page_phys(c_page), .row_pitch = NC, .col_offset = N1 + 1 };
+    if (gemm_accel_set_output_view(&config, &view) == 0) {
+        printf("ERROR: Oversized view accepted\n");
+        errors++;
+    }
+    return errors;
+}
+
+// Test 5: Embedding lookup and projection as one gathered job
+static int test_gather(void) {
+    const int ROWS = 20, K = 48, M = 7, N = 12;
+    int8_t table[20 * 48], b[48 * 12];
+    uint32_t index[7] = {3, 19, 0, 3, 11, 7, 18};
+    int errors = 0;
+
+    for (int i = 0; i < ROWS * K; i++) table[i] = (int8_t)(rand() % 256 - 128);
+    for (int i = 0; i < K * N; i++) b[i] = (int8_t)(rand() % 256 - 128);
+
+    const int t_page = DATA_PAGE, b_page = DATA_PAGE + 1, c_page = DATA_PAGE + 2;
+    const int i_page = DATA_PAGE + 3;
+    memcpy(page_ptr(t_page), table, sizeof(table));
+    memcpy(page_ptr(b_page), b, sizeof(b));
+    memcpy(page_ptr(i_page), index, sizeof(index));
+
+    gemm_config_t config = {
+        .matrix_a_addr = page_phys(t_page), .matrix_b_addr = page_phys(b_page),
+        .matrix_c_addr = page_phys(c_page),
+        .m_dim = M, .k_dim = K, .n_dim = N, .data_type = GEMM_DATA_TYPE_INT8,
+        .stride_a = K, .stride_b = N, .stride_c = N,
+        .gather_index_addr = page_phys(i_page), .gather_table_rows = ROWS
+    };
+    if (gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+        return 1;
+    }
+
+    const int32_t* c = page_ptr(c_page);
+    for (int m = 0; m < M; m++) {
+        for (int n = 0; n < N; n++) {
+            int32_t sum = 0;
+            for (int k = 0; k < K; k++) sum += (int32_t)table[index[m] * K + k] * b[k * N + n];
+            if (c[m * N + n] != sum) {
+                if (errors < 10) printf("Error at (%d,%d): HW=%d, REF=%d\n", m, n, c[m * N + n], sum);
+                errors++;
+            }
+        }
+    }
+
+    // An out-of-range index fails the job and flags the cause
+    index[4] = ROWS;
+    memcpy(page_ptr(i_page), index, sizeof(index));
+    gemm_accel_start(&config);
+    if (gemm_accel_wait() == 0 || !(gemm_accel_status() < 0) ||
+        !(gemm_model_reg_read(model, GEMM_STATUS_REG - GEMM_ACCEL_BASE_ADDR) & GEMM_STATUS_INDEX_ERROR)) {
+        printf("ERROR: Out-of-range index not reported\n");
+        errors++;
+    }
+    return errors;
+}
+
+// Test 6: 3-bit weights packed offline and run bit-serially
+static int test_bit_serial(void) {
+    const int M = 5, K = 20, N = 12, BITS = 3;
+    int8_t a[5 * 20], b[20 * 12];
+    uint8_t packed[3 * 3 * 12];
+    int errors = 0;
+
+    for (int i = 0; i < M * K; i++) a[i] = (int8_t)(rand() % 256 - 128);
+    for (int i = 0; i < K * N; i++) b[i] = (int8_t)(rand() % 8 - 4); // -4..3
+
+    if (gemm_packed_weights_size(K, N, BITS) != sizeof(packed) ||
+        gemm_pack_weights(b, K, N, N, BITS, packed) != 0) {
+        printf("ERROR: Weight packing failed\n");
+        return 1;
+    }
+
+    const int a_page = DATA_PAGE, b_page = DATA_PAGE + 1, c_page = DATA_PAGE + 2;
+    memcpy(page_ptr(a_page), a, sizeof(a));
+    memcpy(page_ptr(b_page), packed, sizeof(packed));
+
+    gemm_config_t config = {
+        .matrix_a_addr = page_phys(a_page), .matrix_b_addr = page_phys(b_page),
+        .matrix_c_addr = page_phys(c_page),
+        .m_dim = M, .k_dim = K, .n_dim = N, .data_type = GEMM_DATA_TYPE_INT8,
+        .weight_bits = BITS, .stride_a = K, .stride_b = N, .stride_c = N
+    };
+    if (gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+        return 1;
+    }
+
+    const int32_t* c = page_ptr(c_page);
+    for (int m = 0; m < M; m++) {
+        for (int n = 0; n < N; n++) {
+            int32_t sum = 0;
+            for (int k = 0; k < K; k++) sum += (int32_t)a[m * K + k] * b[k * N + n];
+            if (c[m * N + n] != sum) {
+                if (errors < 10) printf("Error at (%d,%d): HW=%d, REF=%d\n", m, n, c[m * N + n], sum);
+                errors++;
+            }
+        }
+    }
+
+    // Weights outside the configured precision are rejected by the packer
+    b[7] = 4;
+    if (gemm_pack_weights(b, K, N, N, BITS, packed) == 0) {
+        printf("ERROR: Out-of-range weight packed\n");
+        errors++;
+    }
+    return errors;
+}
+
+// Test 7: Binary and ternary layers through the XNOR-popcount mode
+static int test_bnn(void) {
+    const int M = 6, K = 100, N = 9;
+    int8_t a[6 * 100], b[100 * 9];
+    int errors = 0;
+
+    for (int type = GEMM_DATA_TYPE_BINARY; type <= GEMM_DATA_TYPE_TERNARY; type++) {
+        bool ternary = type == GEMM_DATA_TYPE_TERNARY;
+        for (int i = 0; i < M * K; i++) a[i] = ternary ? rand() % 3 - 1 : (rand() & 1 ? 1 : -1);
+        for (int i = 0; i < K * N; i++) b[i] = ternary ? rand() % 3 - 1 : (rand() & 1 ? 1 : -1);
+
+        // A packed by rows, B by columns
+        uint16_t row_bytes = gemm_bnn_row_bytes(K, type);
+        const int a_page = DATA_PAGE, b_page = DATA_PAGE + 1, c_page = DATA_PAGE + 2;
+        if (gemm_pack_bnn(a, M, K, K, 1, type, page_ptr(a_page)) != 0 ||
+            gemm_pack_bnn(b, N, K, 1, N, type, page_ptr(b_page)) != 0) {
+            printf("ERROR: Binary/ternary packing failed\n");
+            return errors + 1;
+        }
+
+        gemm_config_t config = {
+            .matrix_a_addr = page_phys(a_page), .matrix_b_addr = page_phys(b_page),
+            .matrix_c_addr = page_phys(c_page),
+            .m_dim = M, .k_dim = K, .n_dim = N, .data_type = type,
+            .stride_a = row_bytes, .stride_b = row_bytes, .stride_c = N
+        };
+        if (gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+            return errors + 1;
+        }
+
+        const int32_t* c = page_ptr(c_page);
+        for (int m = 0; m < M; m++) {
+            for (int n = 0; n < N; n++) {
+                int32_t sum = 0;
+                for (int k = 0; k < K; k++) sum += a[m * K + k] * b[k * N + n];
+                if (c[m * N + n] != sum) {
+                    if (errors < 10) printf("Error at (%d,%d): HW=%d, REF=%d\n", m, n, c[m * N + n], sum);
+                    errors++;
+                }
+            }
+        }
+    }
+    return errors;
+}
+
+// Test 8: Two layers pipelined over two instances
+#define PIPE_M      4
+#define PIPE_K      16
+#define PIPE_H      12      // Hidden width
+#define PIPE_N      8
+#define PIPE_COUNT  5
+#define PIPE_SHIFT  6       // Requantization between the layers
+
+static int8_t requantize(int32_t v) {
+    v >>= PIPE_SHIFT;
+    return (int8_t)(v > 127 ? 127 : v < -128 ? -128 : v);
+}
+
+// Host forwarding: int32 hidden activations to int8 layer 2 input
+static int pipe_forward(uint8_t stage, uint8_t slot, void* ctx) {
+    const gemm_pipeline_t* pipe = ctx;
+    const int32_t* c = gemm_model_phys_ptr(model, pipe->stages[stage].out_addr[slot], PIPE_M * PIPE_H * 4);
+    int8_t* a = gemm_model_phys_ptr(model, pipe->stages[stage + 1].in_addr[slot], PIPE_M * PIPE_H);
+    if (c == NULL || a == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < PIPE_M * PIPE_H; i++) {
+        a[i] = requantize(c[i]);
+    }
+    return 0;
+}
+
+static int test_pipeline(void) {
+    const int in_page = DATA_PAGE, w1_page = DATA_PAGE + 1, w2_page = DATA_PAGE + 2;
+    const int hid_page = DATA_PAGE + 3, out_page = DATA_PAGE + 4;
+    int8_t w1[PIPE_K * PIPE_H], w2[PIPE_H * PIPE_N];
+    uint32_t inputs[PIPE_COUNT], outputs[PIPE_COUNT];
+    int errors = 0;
+
+    for (int i = 0; i < PIPE_K * PIPE_H; i++) w1[i] = (int8_t)(rand() % 256 - 128);
+    for (int i = 0; i < PIPE_H * PIPE_N; i++) w2[i] = (int8_t)(rand() % 256 - 128);
+    memcpy(page_ptr(w1_page), w1, sizeof(w1));
+    memcpy(page_ptr(w2_page), w2, sizeof(w2));
+    for (int i = 0; i < PIPE_COUNT; i++) {
+        inputs[i] = page_phys(in_page) + i * 256;
+        outputs[i] = page_phys(out_page) + i * 256;
+        int8_t* x = page_ptr(in_page) + i * 256;
+        for (int j = 0; j < PIPE_M * PIPE_K; j++) x[j] = (int8_t)(rand() % 256 - 128);
+    }
+
+    for (uint8_t instance = 1; instance <= 2; instance++) {
+        gemm_model_init(gemm_model_instance(instance), mem, MEM_BASE, MEM_SIZE);
+    }
+
+    gemm_pipeline_t pipe;
+    gemm_pipeline_init(&pipe, pipe_forward, &pipe);
+    gemm_pipeline_stage_t layer1 = {
+        .layer = { .matrix_b_addr = page_phys(w1_page), .m_dim = PIPE_M, .k_dim = PIPE_K,
+                   .n_dim = PIPE_H, .data_type = GEMM_DATA_TYPE_INT8,
+                   .stride_a = PIPE_K, .stride_b = PIPE_H, .stride_c = PIPE_H },
+        .instance = 1,
+        .out_addr = { page_phys(hid_page), page_phys(hid_page) + 1024 }
+    };
+    gemm_pipeline_stage_t layer2 = {
+        .layer = { .matrix_b_addr = page_phys(w2_page), .m_dim = PIPE_M, .k_dim = PIPE_H,
+                   .n_dim = PIPE_N, .data_type = GEMM_DATA_TYPE_INT8,
+                   .stride_a = PIPE_H, .stride_b = PIPE_N, .stride_c = PIPE_N },
+        .instance = 2,
+        .in_addr = { page_phys(hid_page) + 2048, page_phys(hid_page) + 3072 }
+    };
+    if (gemm_pipeline_add_stage(&pipe, &layer1) != 0 || gemm_pipeline_add_stage(&pipe, &layer2) != 0 ||
+        gemm_pipeline_run(&pipe, inputs, outputs, PIPE_COUNT) != 0) {
+        return 1;
+    }
+
+    for (int i = 0; i < PIPE_COUNT; i++) {
+        const int8_t* x = page_ptr(in_page) + i * 256;
+        const int32_t* y = (const int32_t*)((uint8_t*)page_ptr(out_page) + i * 256);
+        for (int m = 0; m < PIPE_M; m++) {
+            int8_t h[PIPE_H];
+            for (int n = 0; n < PIPE_H; n++) {
+                int32_t sum = 0;
+                for (int k = 0; k < PIPE_K; k++) sum += x[m * PIPE_K + k] * w1[k * PIPE_H + n];
+                h[n] = requantize(sum);
+            }
+            for (int n = 0; n < PIPE_N; n++) {
+                int32_t sum = 0;
+                for (int k = 0; k < PIPE_H; k++) sum += h[k] * w2[k * PIPE_N + n];
+                if (y[m * PIPE_N + n] != sum) {
+                    if (errors < 10) printf("Error at inference %d (%d,%d): HW=%d, REF=%d\n",
+                                            i, m, n, y[m * PIPE_N + n], sum);
+                    errors++;
+                }
+            }
+        }
+    }
+
+    // Each layer ran once per inference on its own instance
+    if (gemm_model_instance(1)->jobs != PIPE_COUNT || gemm_model_instance(2)->jobs != PIPE_COUNT) {
+        printf("ERROR: Stage job counts %llu/%llu\n",
+               (unsigned long long)gemm_model_instance(1)->jobs,
+               (unsigned long long)gemm_model_instance(2)->jobs);
+        errors++;
+    }
+
+    // A layer whose input does not match the previous output is rejected
+    layer2.layer.k_dim = PIPE_H + 1;
+    if (gemm_pipeline_add_stage(&pipe, &layer2) == 0) {
+        printf("ERROR: Mismatched stage accepted\n");
+        errors++;
+    }
+    return errors;
+}
+
+// Test 9: Job classes program the DMA regulator and QoS at start
+static int test_job_classes(void) {
+    const int M = 4, K = 8, N = 4;
+    int errors = 0;
+
+    memset(page_ptr(DATA_PAGE), 1, M * K);
+    memset(page_ptr(DATA_PAGE + 1), 2, K * N);
+
+    gemm_bw_class_t background = { .window_cycles = 1000, .read_bytes = 2048,
+                                   .write_bytes = 1024, .qos = 1 };
+    if (gemm_accel_set_job_class(1, &background) != 0) {
+        return 1;
+    }
+
+    gemm_config_t config = {
+        .matrix_a_addr = page_phys(DATA_PAGE), .matrix_b_addr = page_phys(DATA_PAGE + 1),
+        .matrix_c_addr = page_phys(DATA_PAGE + 2),
+        .m_dim = M, .k_dim = K, .n_dim = N, .data_type = GEMM_DATA_TYPE_INT8,
+        .stride_a = K, .stride_b = N, .stride_c = N, .job_class = 1
+    };
+    for (int pass = 0; pass < 2; pass++) {
+        if (gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+            return errors + 1;
+        }
+        uint32_t ctrl = gemm_model_reg_read(model, GEMM_BW_CTRL_REG - GEMM_ACCEL_BASE_ADDR);
+        uint32_t budget = gemm_model_reg_read(model, GEMM_BW_BUDGET_REG - GEMM_ACCEL_BASE_ADDR);
+        uint32_t want_ctrl = pass == 0 ? (1000 | 1 << GEMM_BW_QOS_POS) : 0;
+        uint32_t want_budget = pass == 0 ? (2048 | 1024 << GEMM_BW_WR_BYTES_POS) : 0;
+        if (ctrl != want_ctrl || budget != want_budget) {
+            printf("ERROR: Class %d programmed BW_CTRL=0x%08x BW_BUDGET=0x%08x\n",
+                   config.job_class, ctrl, budget);
+            errors++;
+        }
+        // Second pass: the default class is unregulated
+        config.job_class = GEMM_JOB_CLASS_DEFAULT;
+    }
+
+    // A regulated class without a write budget would hang the DMA
+    background.write_bytes = 0;
+    if (gemm_accel_set_job_class(2, &background) == 0) {
+        printf("ERROR: Zero budget accepted\n");
+        errors++;
+    }
+    return errors;
+}
+
+// Test 10: Output checksums catch a corrupted result
+static int test_abft(void) {
+    const int M = 8, K = 64, N = 32;
+    int errors = 0;
+
+    for (int i = 0; i < M * K; i++) ((int8_t*)page_ptr(DATA_PAGE))[i] = (int8_t)(rand() % 256 - 128);
+    for (int i = 0; i < K * N; i++) ((int8_t*)page_ptr(DATA_PAGE + 1))[i] = (int8_t)(rand() % 256 - 128);
+
+    gemm_config_t config = {
+        .matrix_a_addr = page_phys(DATA_PAGE), .matrix_b_addr = page_phys(DATA_PAGE + 1),
+        .matrix_c_addr = page_phys(DATA_PAGE + 2),
+        .m_dim = M, .k_dim = K, .n_dim = N, .data_type = GEMM_DATA_TYPE_INT8,
+        .stride_a = K, .stride_b = N, .stride_c = N
+    };
+    gemm_accel_set_abft(true);
+
+    // Clean run is verified
+    if (gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+        errors++;
+    }
+    if (!gemm_accel_abft_checked() || gemm_accel_error_code() != GEMM_ERR_NONE) {
+        printf("ERROR: Clean job not verified\n");
+        errors++;
+    }
+
+    // A flipped bit in one C element is reported as a checksum error
+    model->c_fault_xor = 1u << 20;
+    if (gemm_accel_start(&config) != 0 || gemm_accel_wait() == 0) {
+        printf("ERROR: Corrupted result not detected\n");
+        errors++;
+    }
+    if (gemm_accel_error_code() != GEMM_ERR_ABFT) {
+        printf("ERROR: Error code %d, expected %d\n", gemm_accel_error_code(), GEMM_ERR_ABFT);
+        errors++;
+    }
+
+    // Rows that are not whole lines are not checked
+    config.n_dim = 20;
+    config.stride_c = 20;
+    if (gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0 || gemm_accel_abft_checked()) {
+        printf("ERROR: Unaligned job checked\n");
+        errors++;
+    }
+
+    gemm_accel_set_abft(false);
+    return errors;
+}
+
+// Test 11: Temporal delta updates of C as A changes between frames
+static int test_delta(void) {
+    enum { M = 16, K = 32, N = 24 };
+    static int8_t frame[M * K];
+    static int8_t prev_a[M * K];
+    int8_t* b = page_ptr(DATA_PAGE + 1);
+    int32_t* c = page_ptr(DATA_PAGE + 2);
+    int errors = 0;
+
+    for (int i = 0; i < M * K; i++) frame[i] = (int8_t)(rand() % 256 - 128);
+    for (int i = 0; i < K * N; i++) b[i] = (int8_t)(rand() % 256 - 128);
+
+    gemm_config_t base = {
+        .matrix_b_addr = page_phys(DATA_PAGE + 1), .matrix_c_addr = page_phys(DATA_PAGE + 2),
+        .m_dim = M, .k_dim = K, .n_dim = N, .data_type = GEMM_DATA_TYPE_INT8,
+        .stride_a = K, .stride_b = N, .stride_c = N
+    };
+    gemm_delta_t delta;
+    if (gemm_delta_init(&delta, &base, prev_a, page_ptr(DATA_PAGE + 3), page_phys(DATA_PAGE + 3),
+                        page_ptr(DATA_PAGE + 4), page_phys(DATA_PAGE + 4)) != 0) {
+        return 1;
+    }
+
+    // Frame 0 is computed in full; frame 1 changes two rows; frame 2 swings
+    // one element across the whole int8 range; frame 3 is unchanged
+    static const uint16_t expect_rows[] = {M, 2, 1, 0};
+    static const uint8_t expect_passes[] = {1, 1, 3, 0};
+    for (int t = 0; t < 4; t++) {
+        if (t == 1) {
+            frame[3 * K + 5] += 7;
+            frame[3 * K + 9] = -frame[3 * K + 9] / 2;
+            frame[11 * K + 31] ^= 0x40;
+        } else if (t == 2) {
+            frame[2 * K] = -128;
+            if (gemm_delta_update(&delta, frame) != 0) {
+                errors++;
+            }
+            frame[2 * K] = 127;
+        }
+
+        uint64_t jobs = model->jobs;
+        if (gemm_delta_update(&delta, frame) != 0) {
+            errors++;
+            continue;
+        }
+        if (delta.changed_rows != expect_rows[t] || delta.passes != expect_passes[t] ||
+            model->jobs - jobs != expect_passes[t]) {
+            printf("ERROR: Frame %d updated %d rows in %d passes\n", t, delta.changed_rows, delta.passes);
+            errors++;
+        }
+
+        for (int m = 0; m < M; m++) {
+            for (int n = 0; n < N; n++) {
+                int32_t expected = 0;
+                for (int k = 0; k < K; k++) {
+                    expected += frame[m * K + k] * b[k * N + n];
+                }
+                if (c[m * N + n] != expected) {
+                    if (errors < 10) {
+                        printf("ERROR: Frame %d C[%d][%d] = %d, expected %d\n", t, m, n,
+                               c[m * N + n], expected);
+                    }
+                    errors++;
+                }
+            }
+        }
+    }
+
+    // A first frame with a zero row, then an all-zero first frame: every row
+    // of a stale C must be rewritten
+    for (int t = 0; t < 2; t++) {
+        memset(frame, 0, sizeof(frame));
+        for (int i = 0; t == 0 && i < M * K; i++) {
+            frame[i] = i / K == 1 ? 0 : (int8_t)(rand() % 256 - 128);
+        }
+        memset(c, 0x5A, M * N * sizeof(int32_t));
+        if (gemm_delta_init(&delta, &base, prev_a, page_ptr(DATA_PAGE + 3), page_phys(DATA_PAGE + 3),
+                            page_ptr(DATA_PAGE + 4), page_phys(DATA_PAGE + 4)) != 0 ||
+            gemm_delta_update(&delta, frame) != 0 || delta.passes != 1) {
+            printf("ERROR: Unprimed update %d failed\n", t);
+            errors++;
+        }
+        for (int m = 0; m < M; m++) {
+            for (int n = 0; n < N; n++) {
+                int32_t expected = 0;
+                for (int k = 0; k < K; k++) {
+                    expected += frame[m * K + k] * b[k * N + n];
+                }
+                if (c[m * N + n] != expected) {
+                    errors++;
+                }
+            }
+        }
+    }
+    return errors;
+}
+
+// Test 12: Fused attention streamed over query blocks
+static int test_attention(void) {
+    enum { SQ = 20, SKV = 256, D = 16, DV = 16, SHIFT = 6 };
+    int8_t* q = page_ptr(DATA_PAGE);
+    int8_t* kt = page_ptr(DATA_PAGE + 1);
+    int8_t* v = page_ptr(DATA_PAGE + 2);
+    int32_t* out = page_ptr(DATA_PAGE + 3);
+    static uint8_t lut[GEMM_SOFTMAX_LUT_SIZE];
+    int errors = 0;
+
+    for (int i = 0; i < SQ * D; i++) q[i] = (int8_t)(rand() % 64 - 32);
+    for (int i = 0; i < D * SKV; i++) kt[i] = (int8_t)(rand() % 64 - 32);
+    for (int i = 0; i < SKV * DV; i++) v[i] = (int8_t)(rand() % 256 - 128);
+
+    gemm_softmax_exp_lut(lut, 61565); // exp(-1/16) per LUT step
+    gemm_accel_load_softmax_lut(lut);
+
+    gemm_attention_t attn = {
+        .q_addr = page_phys(DATA_PAGE), .kt_addr = page_phys(DATA_PAGE + 1),
+        .v_addr = page_phys(DATA_PAGE + 2), .out_addr = page_phys(DATA_PAGE + 3),
+        .q_stride = D, .kt_stride = SKV, .v_stride = DV, .out_stride = DV,
+        .seq_q = SQ, .seq_kv = SKV, .head_dim = D, .v_dim = DV, .score_shift = SHIFT
+    };
+
+    // 256 keys take 32 lines per score row, so 8 query rows per job
+    uint64_t jobs = model->jobs;
+    if (gemm_attention_block_rows(&attn) != 8 || gemm_attention_run(&attn) != 0 ||
+        model->jobs - jobs != 3) {
+        printf("ERROR: Attention not run as three blocks\n");
+        errors++;
+    }
+
+    for (int m = 0; m < SQ; m++) {
+        int32_t s[SKV], max = INT32_MIN;
+        uint32_t e[SKV], sum = 0;
+        for (int l = 0; l < SKV; l++) {
+            s[l] = 0;
+            for (int k = 0; k < D; k++) {
+                s[l] += q[m * D + k] * kt[k * SKV + l];
+            }
+            max = s[l] > max ? s[l] : max;
+        }
+        for (int l = 0; l < SKV; l++) {
+            uint32_t idx = (uint32_t)(max - s[l]) >> SHIFT;
+            e[l] = lut[idx > 255 ? 255 : idx];
+            sum += e[l];
+        }
+        uint32_t recip = (GEMM_SOFTMAX_P_MAX << 16) / sum;
+        for (int n = 0; n < DV; n++) {
+            int32_t expected = 0;
+            for (int l = 0; l < SKV; l++) {
+                expected += (int32_t)((e[l] * recip) >> 16) * v[l * DV + n];
+            }
+            if (out[m * DV + n] != expected) {
+                if (errors < 10) {
+                    printf("ERROR: O[%d][%d] = %d, expected %d\n", m, n, out[m * DV + n], expected);
+                }
+                errors++;
+            }
+        }
+    }
+
+    // K and V must fit the scratchpad
+    attn.seq_kv = 4096;
+    if (gemm_attention_run(&attn) == 0) {
+        printf("ERROR: Oversized attention accepted\n");
+        errors++;
+    }
+    return errors;
+}
+
+// Test 13: Output stage. Bias and ReLU on int32 C, then bias, requantization
+// and a clamp into an int8 C with a padded row pitch
+static int test_output_stage(void) {
+    enum { M = 12, K = 40, N = 20, PITCH = 24, SHIFT = 12, ZERO = -5 };
+    const int32_t mult = 1100;
+    int8_t* a = page_ptr(DATA_PAGE);
+    int8_t* b = page_ptr(DATA_PAGE + 1);
+    int32_t* c = page_ptr(DATA_PAGE + 2);
+    int8_t* q = page_ptr(DATA_PAGE + 3);
+    int32_t* bias = page_ptr(DATA_PAGE + 4);
+    int errors = 0;
+
+    for (int i = 0; i < M * K; i++) a[i] = (int8_t)(rand() % 256 - 128);
+    for (int i = 0; i < K * N; i++) b[i] = (int8_t)(rand() % 256 - 128);
+    for (int n = 0; n < N; n++) bias[n] = rand() % 40001 - 20000;
+    memset(q, 0x55, M * PITCH);
+
+    gemm_config_t config = {
+        .matrix_a_addr = page_phys(DATA_PAGE), .matrix_b_addr = page_phys(DATA_PAGE + 1),
+        .matrix_c_addr = page_phys(DATA_PAGE + 2),
+        .m_dim = M, .k_dim = K, .n_dim = N, .data_type = GEMM_DATA_TYPE_INT8,
+        .stride_a = K, .stride_b = N, .stride_c = N,
+        .out_bias = 1, .out_bias_addr = page_phys(DATA_PAGE + 4), .out_relu = 1
+    };
+    if (gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+        errors++;
+    }
+
+    config.matrix_c_addr = page_phys(DATA_PAGE + 3);
+    config.stride_c = PITCH;
+    config.out_relu = 0;
+    config.out_requant = 1;
+    config.out_multiplier = mult;
+    config.out_shift = SHIFT;
+    config.out_zero_point = ZERO;
+    config.out_min = -100;
+    config.out_max = 90;
+    if (gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+        errors++;
+    }
+
+    for (int m = 0; m < M; m++) {
+        for (int n = 0; n < PITCH; n++) {
+            if (n >= N) {
+                // Row padding is not written
+                if (q[m * PITCH + n] != 0x55) {
+                    errors++;
+                }
+                continue;
+            }
+            int32_t x = bias[n];
+            for (int k = 0; k < K; k++) {
+                x += a[m * K + k] * b[k * N + n];
+            }
+            int64_t y = (((int64_t)x * mult + (1 << (SHIFT - 1))) >> SHIFT) + ZERO;
+            int8_t expected_q = (int8_t)(y < -100 ? -100 : y > 90 ? 90 : y);
+            int32_t expected_c = x < 0 ? 0 : x;
+            if (c[m * N + n] != expected_c || q[m * PITCH + n] != expected_q) {
+                if (errors < 10) {
+                    printf("ERROR: [%d][%d] C = %d, Q = %d, expected %d, %d\n", m, n,
+                           c[m * N + n], q[m * PITCH + n], expected_c, expected_q);
+                }
+                errors++;
+            }
+        }
+    }
+
+    // The bias row shares the scratchpad half used by accumulation
+    config.accumulate = 1;
+    if (gemm_accel_start(&config) == 0) {
+        printf("ERROR: Output stage accepted with accumulate\n");
+        errors++;
+    }
+    return errors;
+}
+
+// Weight "storage" for Test 14: reads complete when waited for, so a band is
+// only valid if the driver waited on its slot before using it
+typedef struct {
+    const int8_t* file;
+    bool busy[GEMM_STREAM_MAX_DEPTH];
+    uint64_t offset[GEMM_STREAM_MAX_DEPTH];
+    uint32_t size[GEMM_STREAM_MAX_DEPTH];
+    void* dst[GEMM_STREAM_MAX_DEPTH];
+    int in_flight;
+    int peak;
+    int misuse;
+    int waits;
+    int fail_wait;          // Wait number that reports a read error, 0 = none
+} stream_io_t;
+
+static int stream_io_submit(void* ctx, uint8_t slot, uint64_t offset, uint32_t size, void* dst) {
+    stream_io_t* io = ctx;
+    if (io->busy[slot]) {
+        io->misuse++;
+    }
+    io->busy[slot] = true;
+    io->offset[slot] = offset;
+    io->size[slot] = size;
+    io->dst[slot] = dst;
+    io->in_flight++;
+    io->peak = io->in_flight > io->peak ? io->in_flight : io->peak;
+    return 0;
+}
+
+static int stream_io_wait(void* ctx, uint8_t slot) {
+    stream_io_t* io = ctx;
+    if (!io->busy[slot]) {
+        io->misuse++;
+        return -1;
+    }
+    memcpy(io->dst[slot], io->file + io->offset[slot], io->size[slot]);
+    io->busy[slot] = false;
+    io->in_flight--;
+    return ++io->waits == io->fail_wait ? -1 : 0;
+}
+
+// Test 14: B streamed from storage in bands through a two-slot ring
+static int test_weight_stream(void) {
+    enum { M = 16, K = 200, N = 64, ROWS = 48, BLOCKS = 5 };
+    static int8_t file[K * N];
+    int8_t* a = page_ptr(DATA_PAGE);
+    int32_t* c = page_ptr(DATA_PAGE + 1);
+    int errors = 0;
+
+    for (int i = 0; i < M * K; i++) a[i] = (int8_t)(rand() % 256 - 128);
+    for (int i = 0; i < K * N; i++) file[i] = (int8_t)(rand() % 256 - 128);
+
+    stream_io_t io = {.file = file};
+    gemm_stream_t stream = {
+        .base = {
+            .matrix_a_addr = page_phys(DATA_PAGE), .matrix_c_addr = page_phys(DATA_PAGE + 1),
+            .m_dim = M, .k_dim = K, .n_dim = N, .data_type = GEMM_DATA_TYPE_INT8,
+            .stride_a = K, .stride_b = N, .stride_c = N
+        },
+        .submit = stream_io_submit, .wait = stream_io_wait, .io_ctx = &io,
+        .buffers = page_ptr(DATA_PAGE + 2), .buffers_phys = page_phys(DATA_PAGE + 2),
+        .depth = 2, .block_rows = ROWS
+    };
+
+    uint64_t jobs = model->jobs;
+    if (gemm_stream_run(&stream) != 0 || stream.blocks != BLOCKS || model->jobs - jobs != BLOCKS ||
+        io.peak != 2 || io.in_flight != 0 || io.misuse != 0) {
+        printf("ERROR: Streamed %d bands in %d jobs, %d reads in flight at most\n",
+               stream.blocks, (int)(model->jobs - jobs), io.peak);
+        errors++;
+    }
+
+    for (int m = 0; m < M; m++) {
+        for (int n = 0; n < N; n++) {
+            int32_t expected = 0;
+            for (int k = 0; k < K; k++) {
+                expected += a[m * K + k] * file[k * N + n];
+            }
+            if (c[m * N + n] != expected) {
+                if (errors < 10) {
+                    printf("ERROR: C[%d][%d] = %d, expected %d\n", m, n, c[m * N + n], expected);
+                }
+                errors++;
+            }
+        }
+    }
+
+    // A failed read stops the run after draining the read still in flight
+    io.waits = 0;
+    io.fail_wait = 2;
+    if (gemm_stream_run(&stream) == 0 || stream.blocks != 1 || io.in_flight != 0 || io.misuse != 0) {
+        printf("ERROR: Failed read left %d reads in flight\n", io.in_flight);
+        errors++;
+    }
+    io.fail_wait = 0;
+
+    // Bands are limited by the scratchpad, and the C tile must fit a half
+    stream.block_rows = gemm_stream_block_rows(&stream.base) + 1;
+    if (gemm_stream_run(&stream) == 0) {
+        printf("ERROR: Oversized weight band accepted\n");
+        errors++;
+    }
+    stream.block_rows = 0;
+    stream.base.m_dim = GEMM_SCRATCHPAD_HALF_LINES / (N * 4 / GEMM_SCRATCHPAD_LINE_BYTES) + 1;
+    if (gemm_stream_block_rows(&stream.base) != 0 || gemm_stream_run(&stream) == 0 ||
+        io.in_flight != 0) {
+        printf("ERROR: Oversized output tile accepted\n");
+        errors++;
+    }
+    return errors;
+}
+
+// Memory hook for Test 15: the model memory seen through a callback, as an
+// instruction set simulator would provide it
+static uint32_t hook_calls;
+
+static bool hook_mem(void* ctx, uint32_t phys, void* buf, uint32_t size, bool write) {
+    uint8_t* base = ctx;
+    if (phys < MEM_BASE || phys - MEM_BASE > MEM_SIZE - size) {
+        return false;
+    }
+    if (write) {
+        memcpy(base + (phys - MEM_BASE), buf, size);
+    } else {
+        memcpy(buf, base + (phys - MEM_BASE), size);
+    }
+    hook_calls++;
+    return true;
+}
+
+// Test 15: DMA through a memory hook and the cycle model estimate
+static int test_mem_hook(void) {
+    enum { M = 16, K = 32, N = 16 };
+    int8_t* a = page_ptr(DATA_PAGE);
+    int8_t* b = page_ptr(DATA_PAGE + 1);
+    int32_t* c = page_ptr(DATA_PAGE + 2);
+    int errors = 0;
+
+    for (int i = 0; i < M * K; i++) a[i] = (int8_t)(rand() % 256 - 128);
+    for (int i = 0; i < K * N; i++) b[i] = (int8_t)(rand() % 256 - 128);
+
+    gemm_config_t config = {
+        .matrix_a_addr = page_phys(DATA_PAGE), .matrix_b_addr = page_phys(DATA_PAGE + 1),
+        .matrix_c_addr = page_phys(DATA_PAGE + 2),
+        .m_dim = M, .k_dim = K, .n_dim = N, .data_type = GEMM_DATA_TYPE_INT8,
+        .stride_a = K, .stride_b = N, .stride_c = N
+    };
+    gemm_model_set_mem_fn(model, hook_mem, mem);
+    uint64_t cycles = model->cycles;
+    if (gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+        errors++;
+    }
+    gemm_model_set_mem_fn(model, NULL, NULL);
+
+    for (int m = 0; m < M; m++) {
+        for (int n = 0; n < N; n++) {
+            int32_t expected = 0;
+            for (int k = 0; k < K; k++) {
+                expected += a[m * K + k] * b[k * N + n];
+            }
+            if (c[m * N + n] != expected) {
+                errors++;
+            }
+        }
+    }
+    if (hook_calls == 0) {
+        printf("ERROR: Memory hook not used\n");
+        errors++;
+    }
+
+    // 32 overhead + 16 A lines + 16 B lines + 4 tiles * 32 + 16 rows * 2 C lines
+    if (model->last_job_cycles != 224 || model->cycles != cycles + 224) {
+        printf("ERROR: Job estimated at %llu cycles, expected 224\n",
+               (unsigned long long)model->last_job_cycles);
+        errors++;
+    }
+    return errors;
+}
+
+// Test 16: Memory footprint profile of two jobs with a DMA buffer held
+// across the second
+static int test_mem_profile(void) {
+    gemm_mem_profile_t prof;
+    gemm_mem_sample_t samples[4];
+    int errors = 0;
+
+    gemm_config_t config = {
+        .matrix_a_addr = page_phys(DATA_PAGE), .matrix_b_addr = page_phys(DATA_PAGE + 1),
+        .matrix_c_addr = page_phys(DATA_PAGE + 2),
+        .m_dim = 16, .k_dim = 32, .n_dim = 16, .data_type = GEMM_DATA_TYPE_INT8,
+        .stride_a = 32, .stride_b = 16, .stride_c = 16
+    };
+    gemm_mem_profile_start(&prof, "test", samples, 4);
+    prof.limit[GEMM_MEM_DMA] = 16384;
+    if (gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+        errors++;
+    }
+    gemm_mem_profile_alloc(GEMM_MEM_DMA, 4096);
+    config.m_dim = 4;
+    if (gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+        errors++;
+    }
+    gemm_mem_profile_free(GEMM_MEM_DMA, 4096);
+    gemm_mem_profile_stop();
+    gemm_mem_profile_alloc(GEMM_MEM_DMA, 4096); // Not recorded
+    gemm_mem_profile_report(&prof);
+
+    // A and C share the first half: max(16, 16 * 2) + 16 lines, then 8 + 16
+    if (prof.jobs != 2 || prof.peak[GEMM_MEM_SCRATCHPAD] != 48 * 32 ||
+        samples[0].bytes[GEMM_MEM_SCRATCHPAD] != 48 * 32 ||
+        samples[1].bytes[GEMM_MEM_SCRATCHPAD] != 24 * 32) {
+        printf("ERROR: Scratchpad occupancy not recorded per job\n");
+        errors++;
+    }
+    if (samples[0].bytes[GEMM_MEM_DMA] != 0 || samples[1].bytes[GEMM_MEM_DMA] != 4096 ||
+        prof.peak[GEMM_MEM_DMA] != 4096 || prof.current[GEMM_MEM_DMA] != 0) {
+        printf("ERROR: DMA buffer use not recorded\n");
+        errors++;
+    }
+    return errors;
+}
+
+// Test 17: Latency histograms of known per-line latencies. A 16x32x16 job
+// reads 16 + 16 lines and writes 16 rows of 2 lines
+static int test_latency_hist(void) {
+    gemm_config_t config = {
+        .matrix_a_addr = page_phys(DATA_PAGE), .matrix_b_addr = page_phys(DATA_PAGE + 1),
+        .matrix_c_addr = page_phys(DATA_PAGE + 2),
+        .m_dim = 16, .k_dim = 32, .n_dim = 16, .data_type = GEMM_DATA_TYPE_INT8,
+        .stride_a = 32, .stride_b = 16, .stride_c = 16
+    };
+    // Reads at 40 cycles land in bin 6 ([32, 64)), writes at 40000 in the
+    // last bin; with a shift of 2 they move to bins 4 and 14. A disabled
+    // monitor records nothing
+    static const bool enables[4] = {true, true, true, false};
+    static const uint8_t shifts[4] = {0, 0, 2, 0};
+    int errors = 0;
+
+    model->mem_latency[GEMM_LAT_CHANNEL_READ] = 40;
+    model->mem_latency[GEMM_LAT_CHANNEL_WRITE] = 40000;
+    gemm_accel_latency_monitor_clear();
+    for (int t = 0; t < 4; t++) {
+        gemm_accel_latency_monitor_config(enables[t], shifts[t]);
+        if (gemm_accel_start(&config) != 0 || gemm_accel_wait() != 0) {
+            errors++;
+        }
+    }
+
+    gemm_latency_hist_t rd, wr;
+    gemm_accel_read_latency_histogram(GEMM_LAT_CHANNEL_READ, &rd);
+    gemm_accel_read_latency_histogram(GEMM_LAT_CHANNEL_WRITE, &wr);
+    for (int bin = 0; bin < GEMM_LAT_NUM_BINS; bin++) {
+        uint32_t expect_rd = bin == 6 ? 64 : bin == 4 ? 32 : 0;
+        uint32_t expect_wr = bin == GEMM_LAT_NUM_BINS - 1 ? 64 : bin == 14 ? 32 : 0;
+        if (rd.bins[bin] != expect_rd || wr.bins[bin] != expect_wr) {
+            printf("ERROR: Bin %d holds %u reads and %u writes, expected %u and %u\n",
+                   bin, rd.bins[bin], wr.bins[bin], expect_rd, expect_wr);
+            errors++;
+        }
+    }
+    if (rd.max_latency != 40 || wr.max_latency != 40000) {
+        printf("ERROR: Maximum latencies %u and %u\n", rd.max_latency, wr.max_latency);
+        errors++;
+    }
+    gemm_accel_print_latency_summary();
+
+    gemm_accel_latency_monitor_clear();
+    gemm_accel_read_latency_histogram(GEMM_LAT_CHANNEL_WRITE, &wr);
+    if (wr.bins[GEMM_LAT_NUM_BINS - 1] != 0 || wr.max_latency != 0) {
+        printf("ERROR: Clear left the write histogram\n");
+        errors++;
+    }
+    model->mem_latency[GEMM_LAT_CHANNEL_READ] = 0;
+    model->mem_latency[GEMM_LAT_CHANNEL_WRITE] = 0;
+    gemm_accel_latency_monitor_config(false, 0);
+    return errors;
+}
+
+int main() {
+    printf("GEMM Accelerator Device Model Tests\n");
+    printf("===================================\n");
+
+    mem = calloc(MEM_SIZE, 1);
+    if (mem == NULL) {
+        printf("ERROR: Memory allocation failed\n");
+        return 1;
+    }
+    model = gemm_model_default();
+    gemm_model_init(model, mem, MEM_BASE, MEM_SIZE);
+    srand(1);
+
+    if (gemm_accel_init() != 0) {
+        return 1;
+    }
+
+    gemm_page_table_t pt;
+    gemm_accel_mmu_init_table(&pt, page_ptr(L1_PAGE), page_phys(L1_PAGE),
+                              page_ptr(L0_POOL_PAGE), page_phys(L0_POOL_PAGE), L0_POOL_PAGES);
+
+    int total_errors = 0;
+    int errors;
+
+    printf("\nTest 1: Scattered buffers through the DMA MMU\n");
+    errors = test_scattered_gemm(&pt);
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 2: Translation faults\n");
+    errors = test_faults(&pt);
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 3: DMA zero-padding\n");
+    errors = test_padding();
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 4: Output views for concatenation\n");
+    errors = test_concat_views();
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 5: Indexed gather\n");
+    errors = test_gather();
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 6: Bit-serial 3-bit weights\n");
+    errors = test_bit_serial();
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 7: Binary and ternary modes\n");
+    errors = test_bnn();
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 8: Layer pipeline across instances\n");
+    errors = test_pipeline();
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 9: Bandwidth job classes\n");
+    errors = test_job_classes();
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 10: Output checksums (ABFT)\n");
+    errors = test_abft();
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 11: Temporal delta GEMM\n");
+    errors = test_delta();
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 12: Fused attention\n");
+    errors = test_attention();
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 13: Output stage\n");
+    errors = test_output_stage();
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 14: Out-of-core weight streaming\n");
+    errors = test_weight_stream();
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 15: Memory hook and cycle model\n");
+    errors = test_mem_hook();
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 16: Memory footprint profile\n");
+    errors = test_mem_profile();
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\nTest 17: AXI latency histograms\n");
+    errors = test_latency_hist();
+    printf("Errors: %d\n", errors);
+    total_errors += errors;
+
+    printf("\n===================================\n");
+    printf("Total errors: %d\n", total_errors);
+    if (total_errors == 0) {
+        printf("All tests PASSED!\n");
+    } else {
+        printf("Some tests FAILED!\n");
+    }
+
+    free(mem);
+    return total_errors;
+}
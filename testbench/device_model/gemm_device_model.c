@@ -0,0 +1,641 @@
+// GEMM Accelerator Device Model Implementation
+// Functional C model of the accelerator register file for host-side testing
+
+#include "gemm_device_model.h"
+#include "gemm_accel_driver.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Register offsets relative to the accelerator base
+#define OFFSET(reg)             ((reg) - GEMM_ACCEL_BASE_ADDR)
+#define REG(model, reg)         ((model)->regs[OFFSET(reg) / 4])
+
+// Instances used by the driver's register hooks
+static gemm_device_model_t models[GEMM_ACCEL_MAX_INSTANCES];
+
+gemm_device_model_t* gemm_model_default(void) {
+    return &models[0];
+}
+
+gemm_device_model_t* gemm_model_instance(uint8_t instance) {
+    return &models[instance % GEMM_ACCEL_MAX_INSTANCES];
+}
+
+// Initialize the model over a block of host memory
+void gemm_model_init(gemm_device_model_t* model, uint8_t* mem,
+                     uint32_t mem_base, uint32_t mem_size) {
+    memset(model, 0, sizeof(*model));
+    model->mem = mem;
+    model->mem_base = mem_base;
+    model->mem_size = mem_size;
+}
+
+// Host pointer for a modeled physical address
+void* gemm_model_phys_ptr(gemm_device_model_t* model, uint32_t phys, uint32_t size) {
+    if (phys < model->mem_base || (uint64_t)phys - model->mem_base + size > model->mem_size) {
+        return NULL;
+    }
+    return model->mem + (phys - model->mem_base);
+}
+
+void gemm_model_set_mem_fn(gemm_device_model_t* model, gemm_model_mem_fn fn, void* ctx) {
+    model->mem_fn = fn;
+    model->mem_ctx = ctx;
+}
+
+// Access modeled physical memory
+static bool phys_access(gemm_device_model_t* model, uint32_t phys, void* buf,
+                        uint32_t size, bool write) {
+    if (model->mem_fn != NULL) {
+        return model->mem_fn(model->mem_ctx, phys, buf, size, write);
+    }
+    uint8_t* p = gemm_model_phys_ptr(model, phys, size);
+    if (p == NULL) {
+        return false;
+    }
+    if (write) {
+        memcpy(p, buf, size);
+    } else {
+        memcpy(buf, p, size);
+    }
+    return true;
+}
+
+// Read a page table entry from modeled memory
+static bool read_pte(gemm_device_model_t* model, uint32_t phys, uint32_t* pte) {
+    uint8_t p[4];
+    if (!phys_access(model, phys, p, sizeof(p), false)) {
+        return false;
+    }
+    *pte = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    return true;
+}
+
+// Translate a DMA address, mirroring the dma_mmu TLB and walker
+static bool translate(gemm_device_model_t* model, uint32_t va, bool write, uint32_t* pa) {
+    if (!(REG(model, GEMM_MMU_CTRL_REG) & GEMM_MMU_CTRL_ENABLE)) {
+        *pa = va;
+        return true;
+    }
+
+    uint32_t vpn = va >> 12;
+    uint32_t pte = 0;
+    bool hit = false;
+
+    for (int i = 0; i < GEMM_MODEL_TLB_ENTRIES; i++) {
+        if (model->tlb_valid[i] && model->tlb_vpn[i] == vpn) {
+            pte = model->tlb_pte[i];
+            hit = true;
+            break;
+        }
+    }
+
+    if (hit) {
+        model->tlb_hits++;
+    } else {
+        uint32_t l1;
+        model->tlb_misses++;
+
+        uint32_t ptbr = REG(model, GEMM_MMU_PTBR_REG);
+        if (!read_pte(model, ptbr + (va >> 22) * 4, &l1) || !(l1 & GEMM_PTE_VALID)) {
+            goto fault;
+        }
+        if (!read_pte(model, (l1 & ~0xFFFu) + ((va >> 12) & 0x3FF) * 4, &pte) ||
+            !(pte & GEMM_PTE_VALID)) {
+            goto fault;
+        }
+
+        model->tlb_valid[model->tlb_next] = true;
+        model->tlb_vpn[model->tlb_next] = vpn;
+        model->tlb_pte[model->tlb_next] = pte;
+        model->tlb_next = (model->tlb_next + 1) % GEMM_MODEL_TLB_ENTRIES;
+    }
+
+    if (write && !(pte & GEMM_PTE_WRITABLE)) {
+        goto fault;
+    }
+
+    *pa = (pte & ~0xFFFu) | (va & 0xFFF);
+    return true;
+
+fault:
+    if (!model->mmu_fault) {
+        model->mmu_fault = true;
+        model->mmu_fault_addr = va;
+    }
+    return false;
+}
+
+// DMA access to modeled memory through the translation unit
+static bool dma_access(gemm_device_model_t* model, uint32_t va, void* buf,
+                       uint32_t size, bool write) {
+    uint8_t* bytes = buf;
+
+    while (size > 0) {
+        // Split at page boundaries like the DMA engine
+        uint32_t chunk = 0x1000 - (va & 0xFFF);
+        if (chunk > size) {
+            chunk = size;
+        }
+
+        uint32_t pa;
+        if (!translate(model, va, write, &pa)) {
+            return false;
+        }
+        if (!phys_access(model, pa, bytes, chunk, write)) {
+            return false;
+        }
+        va += chunk;
+        bytes += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+// Load one signed operand element
+static bool load_element(gemm_device_model_t* model, uint32_t addr, uint32_t index,
+                         bool int16, int32_t* value) {
+    if (int16) {
+        int16_t v;
+        if (!dma_access(model, addr + index * 2, &v, sizeof(v), false)) {
+            return false;
+        }
+        *value = v;
+    } else {
+        int8_t v;
+        if (!dma_access(model, addr + index, &v, sizeof(v), false)) {
+            return false;
+        }
+        *value = v;
+    }
+    return true;
+}
+
+// Load one weight of bit-serial B: plane i of group g is the row of bytes
+// at b_addr + (g * bits + i) * stride_b, bit k % 8 of column n's byte
+static bool load_packed_weight(gemm_device_model_t* model, uint32_t b_addr, uint32_t stride_b,
+                               uint32_t bits, uint32_t k, uint32_t n, int32_t* value) {
+    int32_t w = 0;
+    for (uint32_t i = 0; i < bits; i++) {
+        uint8_t plane;
+        uint32_t row = (k / GEMM_WEIGHT_GROUP) * bits + i;
+        if (!dma_access(model, b_addr + row * stride_b + n, &plane, sizeof(plane), false)) {
+            return false;
+        }
+        if ((plane >> (k % GEMM_WEIGHT_GROUP)) & 1) {
+            w += (i == bits - 1) ? -(1 << i) : (1 << i); // Top plane is the sign
+        }
+    }
+    *value = w;
+    return true;
+}
+
+// Binary/ternary dot product of packed rows, mirroring the XNOR-popcount
+// cells: one 64-bit word of each operand per step
+static bool bnn_dot(gemm_device_model_t* model, uint32_t a_row, uint32_t b_row,
+                    uint32_t k_dim, bool ternary, int32_t* sum) {
+    uint32_t per_word = ternary ? GEMM_BNN_TERNARY_PER_WORD : GEMM_BNN_BINARY_PER_WORD;
+    *sum = 0;
+    for (uint32_t k0 = 0; k0 < k_dim; k0 += per_word) {
+        uint64_t a, b;
+        if (!dma_access(model, a_row + k0 / per_word * 8, &a, sizeof(a), false) ||
+            !dma_access(model, b_row + k0 / per_word * 8, &b, sizeof(b), false)) {
+            return false;
+        }
+        uint32_t count = k_dim - k0 < per_word ? k_dim - k0 : per_word;
+        for (uint32_t i = 0; i < count; i++) {
+            bool agree = ((a ^ b) >> i & 1) == 0;
+            if (ternary && !((a & b) >> (32 + i) & 1)) {
+                continue; // Zero operand
+            }
+            *sum += agree ? 1 : -1;
+        }
+    }
+    return true;
+}
+
+// Output checksum check, mirroring abft_checker: sum(C) must equal
+// sum_k colsum_A[k] * rowsum_B[k] modulo 2^32
+static bool abft_check(gemm_device_model_t* model, uint32_t a_addr, uint32_t b_addr,
+                       uint32_t c_addr, uint32_t m_dim, uint32_t k_dim, uint32_t n_dim,
+                       uint32_t stride_a, uint32_t stride_b, uint32_t stride_c) {
+    uint32_t expected = 0, observed = 0;
+
+    for (uint32_t k = 0; k < k_dim; k++) {
+        uint32_t col_a = 0, row_b = 0;
+        int32_t v;
+        for (uint32_t m = 0; m < m_dim; m++) {
+            if (!load_element(model, a_addr, m * stride_a + k, false, &v)) {
+                return false;
+            }
+            col_a += (uint32_t)v;
+        }
+        for (uint32_t n = 0; n < n_dim; n++) {
+            if (!load_element(model, b_addr, k * stride_b + n, false, &v)) {
+                return false;
+            }
+            row_b += (uint32_t)v;
+        }
+        expected += col_a * row_b;
+    }
+
+    for (uint32_t m = 0; m < m_dim; m++) {
+        for (uint32_t n = 0; n < n_dim; n++) {
+            uint32_t c;
+            if (!dma_access(model, c_addr + (m * stride_c + n) * 4, &c, sizeof(c), false)) {
+                return false;
+            }
+            observed += c;
+        }
+    }
+
+    model->abft_checked = true;
+    model->abft_error = expected != observed;
+    return true;
+}
+
+// Fused attention, mirroring softmax_unit: S = A * B (m_dim x seq_len),
+// P = LUT softmax of each row of S in int8, C = P * V
+static bool run_attention(gemm_device_model_t* model, uint32_t a_addr, uint32_t b_addr,
+                          uint32_t c_addr, uint32_t m_dim, uint32_t k_dim, uint32_t n_dim,
+                          uint32_t stride_a, uint32_t stride_b, uint32_t stride_c) {
+    uint32_t ctrl = REG(model, GEMM_ATTN_CTRL_REG);
+    uint32_t seq_len = ctrl >> GEMM_ATTN_SEQ_POS;
+    uint32_t shift = (ctrl >> GEMM_ATTN_SHIFT_POS) & 0xF;
+    uint32_t v_addr = REG(model, GEMM_ATTN_V_ADDR_REG);
+    uint32_t v_stride = REG(model, GEMM_ATTN_V_STRIDE_REG) & 0xFFFF;
+    int32_t* scores = malloc(seq_len * sizeof(int32_t));
+    bool ok = scores != NULL;
+
+    for (uint32_t m = 0; ok && m < m_dim; m++) {
+        int32_t max = INT32_MIN;
+        for (uint32_t l = 0; ok && l < seq_len; l++) {
+            int32_t sum = 0;
+            for (uint32_t k = 0; k < k_dim; k++) {
+                int32_t a, b;
+                if (!load_element(model, a_addr, m * stride_a + k, false, &a) ||
+                    !load_element(model, b_addr, k * stride_b + l, false, &b)) {
+                    ok = false;
+                    break;
+                }
+                sum += a * b;
+            }
+            scores[l] = sum;
+            max = sum > max ? sum : max;
+        }
+
+        uint32_t row_sum = 0;
+        for (uint32_t l = 0; ok && l < seq_len; l++) {
+            uint32_t idx = ((uint32_t)max - (uint32_t)scores[l]) >> shift;
+            scores[l] = model->softmax_lut[idx > 255 ? 255 : idx];
+            row_sum += scores[l];
+        }
+        uint32_t recip = row_sum != 0 ? ((uint32_t)GEMM_SOFTMAX_P_MAX << 16) / row_sum : 0;
+
+        for (uint32_t n = 0; ok && n < n_dim; n++) {
+            int32_t sum = 0;
+            for (uint32_t l = 0; l < seq_len; l++) {
+                int32_t v;
+                if (!load_element(model, v_addr, l * v_stride + n, false, &v)) {
+                    ok = false;
+                    break;
+                }
+                sum += (int32_t)(((uint32_t)scores[l] * recip) >> 16) * v;
+            }
+            if (ok && !dma_access(model, c_addr + (m * stride_c + n) * 4, &sum, sizeof(sum), true)) {
+                ok = false;
+            }
+        }
+    }
+
+    free(scores);
+    return ok;
+}
+
+// Output stage, mirroring dma_output_stage: bias, ReLU, then int8
+// requantization; elem indexes C, whose elements are int8 when requantized
+static bool store_output(gemm_device_model_t* model, uint32_t ctrl, uint32_t c_addr,
+                         uint32_t elem, uint32_t n, int32_t x) {
+    if (ctrl & GEMM_OUTPUT_CTRL_BIAS) {
+        int32_t bias;
+        if (!dma_access(model, REG(model, GEMM_OUTPUT_BIAS_ADDR_REG) + n * 4, &bias, sizeof(bias), false)) {
+            return false;
+        }
+        x = (int32_t)((uint32_t)x + (uint32_t)bias);
+    }
+    if ((ctrl & GEMM_OUTPUT_CTRL_RELU) && x < 0) {
+        x = 0;
+    }
+    if (!(ctrl & GEMM_OUTPUT_CTRL_REQUANT)) {
+        return dma_access(model, c_addr + elem * 4, &x, sizeof(x), true);
+    }
+
+    uint32_t shift = (ctrl >> GEMM_OUTPUT_SHIFT_POS) & 0x3F;
+    int8_t zero_point = (int8_t)(ctrl >> GEMM_OUTPUT_ZERO_POS);
+    uint32_t clamp = REG(model, GEMM_OUTPUT_CLAMP_REG);
+    int8_t min = (int8_t)clamp, max = (int8_t)(clamp >> GEMM_OUTPUT_MAX_POS);
+    int64_t scaled = (int64_t)x * (int32_t)REG(model, GEMM_OUTPUT_MULT_REG);
+    if (shift != 0) {
+        scaled += (int64_t)1 << (shift - 1);
+    }
+    int64_t y = (scaled >> shift) + zero_point;
+    int8_t q = (int8_t)(y < min ? min : y > max ? max : y);
+    return dma_access(model, c_addr + elem, &q, sizeof(q), true);
+}
+
+// Execute the configured GEMM: C[m][n] = sum_k A[m][k] * B[k][n]
+static bool run_gemm(gemm_device_model_t* model) {
+    uint32_t a_addr = REG(model, GEMM_MATRIX_A_ADDR_REG);
+    uint32_t b_addr = REG(model, GEMM_MATRIX_B_ADDR_REG);
+    uint32_t c_addr = REG(model, GEMM_MATRIX_C_ADDR_REG);
+    uint32_t m_dim = REG(model, GEMM_M_DIM_REG) & 0xFFFF;
+    uint32_t k_dim = REG(model, GEMM_K_DIM_REG) & 0xFFFF;
+    uint32_t n_dim = REG(model, GEMM_N_DIM_REG) & 0xFFFF;
+    uint32_t stride_a = REG(model, GEMM_STRIDE_A_REG) & 0xFFFF;
+    uint32_t stride_b = REG(model, GEMM_STRIDE_B_REG) & 0xFFFF;
+    uint32_t stride_c = REG(model, GEMM_STRIDE_C_REG) & 0xFFFF;
+    bool int16 = (REG(model, GEMM_DATA_TYPE_REG) & 0xFF) == GEMM_DATA_TYPE_INT16;
+    uint32_t weight_bits = (REG(model, GEMM_DATA_TYPE_REG) >> GEMM_WEIGHT_BITS_POS) & 0xF;
+    uint32_t data_type = REG(model, GEMM_DATA_TYPE_REG) & 0xFF;
+    uint32_t pad = REG(model, GEMM_PAD_REG);
+    uint32_t pad_top = pad & 0xF, pad_bottom = (pad >> 4) & 0xF;
+    uint32_t pad_left = (pad >> 8) & 0xF, pad_right = (pad >> 12) & 0xF;
+    bool gather = REG(model, GEMM_GATHER_CTRL_REG) & GEMM_GATHER_CTRL_ENABLE;
+    uint32_t index_addr = REG(model, GEMM_GATHER_INDEX_ADDR_REG);
+    uint32_t table_rows = REG(model, GEMM_GATHER_NUM_ROWS_REG);
+    bool accumulate = REG(model, GEMM_ACCUM_CTRL_REG) & GEMM_ACCUM_CTRL_ENABLE;
+    uint32_t out_ctrl = REG(model, GEMM_OUTPUT_CTRL_REG);
+
+    if (REG(model, GEMM_ATTN_CTRL_REG) & GEMM_ATTN_CTRL_ENABLE) {
+        return run_attention(model, a_addr, b_addr, c_addr, m_dim, k_dim, n_dim,
+                             stride_a, stride_b, stride_c);
+    }
+
+    if (data_type == GEMM_DATA_TYPE_BINARY || data_type == GEMM_DATA_TYPE_TERNARY) {
+        // Packed A rows (pitch stride_a bytes) against packed B^T rows (stride_b)
+        for (uint32_t m = 0; m < m_dim; m++) {
+            for (uint32_t n = 0; n < n_dim; n++) {
+                int32_t sum;
+                if (!bnn_dot(model, a_addr + m * stride_a, b_addr + n * stride_b, k_dim,
+                             data_type == GEMM_DATA_TYPE_TERNARY, &sum) ||
+                    !dma_access(model, c_addr + (m * stride_c + n) * 4, &sum, sizeof(sum), true)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    for (uint32_t m = 0; m < m_dim; m++) {
+        // Source row of A: interior row, or the indexed table row when gathering
+        uint32_t a_row = m - pad_top;
+        bool zero_row = m < pad_top || m >= m_dim - pad_bottom;
+        if (!zero_row && gather) {
+            if (!dma_access(model, index_addr + a_row * 4, &a_row, sizeof(a_row), false)) {
+                return false;
+            }
+            if (a_row >= table_rows) {
+                model->index_error = true;
+                zero_row = true;
+                if (accumulate) {
+                    // Scattered store: the row is not written
+                    continue;
+                }
+            }
+        }
+        // Accumulating gathered jobs update row index[m] of C
+        uint32_t c_row = (accumulate && gather) ? a_row : m;
+        
+        for (uint32_t n = 0; n < n_dim; n++) {
+            int32_t sum = 0;
+            for (uint32_t k = 0; k < k_dim; k++) {
+                int32_t a = 0, b;
+                bool border = zero_row || k < pad_left || k >= k_dim - pad_right;
+                
+                // Border elements of A are zeros generated by the DMA
+                if (!border && !load_element(model, a_addr,
+                                             a_row * stride_a + (k - pad_left), int16, &a)) {
+                    return false;
+                }
+                if (weight_bits != 0) {
+                    if (!load_packed_weight(model, b_addr, stride_b, weight_bits, k, n, &b)) {
+                        return false;
+                    }
+                } else if (!load_element(model, b_addr, k * stride_b + n, int16, &b)) {
+                    return false;
+                }
+                sum += a * b;
+            }
+            sum ^= model->c_fault_xor;
+            model->c_fault_xor = 0;
+            uint32_t c_elem = c_addr + (c_row * stride_c + n) * 4;
+            if (accumulate) {
+                int32_t prev;
+                if (!dma_access(model, c_elem, &prev, sizeof(prev), false)) {
+                    return false;
+                }
+                sum = (int32_t)((uint32_t)prev + (uint32_t)sum);
+            }
+            if (out_ctrl != 0) {
+                if (!store_output(model, out_ctrl, c_addr, c_row * stride_c + n, n, sum)) {
+                    return false;
+                }
+            } else if (!dma_access(model, c_elem, &sum, sizeof(sum), true)) {
+                return false;
+            }
+        }
+    }
+    
+    bool abft = (REG(model, GEMM_ABFT_CTRL_REG) & GEMM_ABFT_CTRL_ENABLE) &&
+                data_type == GEMM_DATA_TYPE_INT8 && weight_bits == 0 && pad == 0 && !gather && !accumulate &&
+                out_ctrl == 0 && k_dim % GEMM_ABFT_LINE_ELEMS == 0 && n_dim % GEMM_ABFT_LINE_ELEMS == 0 &&
+                k_dim <= GEMM_ABFT_MAX_K;
+    if (abft && !abft_check(model, a_addr, b_addr, c_addr, m_dim, k_dim, n_dim,
+                            stride_a, stride_b, stride_c)) {
+        return false;
+    }
+    return true;
+}
+
+// Cycle model: the DMA moves one scratchpad line per cycle and the MAC array
+// takes k cycles per MODEL_ARRAY_DIM square tile of C, with the phases run
+// back to back as in the top FSM. Memory latency, bandwidth regulation and
+// table walks are not modeled; packed weights are costed by their bytes.
+#define MODEL_LINE_BYTES        32
+#define MODEL_ARRAY_DIM         8
+#define MODEL_JOB_OVERHEAD      32
+#define MODEL_LINES(bytes)      (((uint64_t)(bytes) + MODEL_LINE_BYTES - 1) / MODEL_LINE_BYTES)
+#define MODEL_TILES(m, n)       ((uint64_t)(((m) + MODEL_ARRAY_DIM - 1) / MODEL_ARRAY_DIM) * \
+                                 (((n) + MODEL_ARRAY_DIM - 1) / MODEL_ARRAY_DIM))
+
+// Estimated cycles of the configured job, and the lines it reads from and
+// writes to memory
+static uint64_t job_cost(gemm_device_model_t* model, uint64_t* rd_lines, uint64_t* wr_lines) {
+    uint64_t m = REG(model, GEMM_M_DIM_REG) & 0xFFFF;
+    uint64_t k = REG(model, GEMM_K_DIM_REG) & 0xFFFF;
+    uint64_t n = REG(model, GEMM_N_DIM_REG) & 0xFFFF;
+    uint32_t data_type = REG(model, GEMM_DATA_TYPE_REG) & 0xFF;
+    uint32_t weight_bits = (REG(model, GEMM_DATA_TYPE_REG) >> GEMM_WEIGHT_BITS_POS) & 0xF;
+    uint64_t elem = data_type == GEMM_DATA_TYPE_INT16 ? 2 : 1;
+    uint64_t a_bytes = m * k * elem;
+    uint64_t b_bytes = k * n * elem;
+    uint64_t steps = k;                 // Array cycles per output tile
+
+    if (data_type == GEMM_DATA_TYPE_BINARY || data_type == GEMM_DATA_TYPE_TERNARY) {
+        uint32_t per_word = data_type == GEMM_DATA_TYPE_TERNARY ? GEMM_BNN_TERNARY_PER_WORD :
+                                                                  GEMM_BNN_BINARY_PER_WORD;
+        a_bytes = m * (REG(model, GEMM_STRIDE_A_REG) & 0xFFFF);
+        b_bytes = n * (REG(model, GEMM_STRIDE_B_REG) & 0xFFFF);
+        steps = (k + per_word - 1) / per_word;
+    } else if (weight_bits != 0) {
+        b_bytes = ((k + 7) / 8) * weight_bits * n;
+    }
+
+    *rd_lines = MODEL_LINES(a_bytes) + MODEL_LINES(b_bytes);
+    *wr_lines = m * MODEL_LINES(n * 4);
+    if (REG(model, GEMM_ACCUM_CTRL_REG) & GEMM_ACCUM_CTRL_ENABLE) {
+        *rd_lines += m * MODEL_LINES(n * 4);
+    }
+    if (REG(model, GEMM_OUTPUT_CTRL_REG) & GEMM_OUTPUT_CTRL_BIAS) {
+        *rd_lines += MODEL_LINES(n * 4);
+    }
+    uint64_t cycles = MODEL_JOB_OVERHEAD + MODEL_TILES(m, n) * steps;
+
+    uint32_t attn = REG(model, GEMM_ATTN_CTRL_REG);
+    if (attn & GEMM_ATTN_CTRL_ENABLE) {
+        // Scores replace the Q*B product, then three softmax passes per
+        // row, the V load and the P*V pass
+        uint64_t seq_len = attn >> GEMM_ATTN_SEQ_POS;
+        *rd_lines += MODEL_LINES(k * seq_len) - MODEL_LINES(b_bytes) + MODEL_LINES(seq_len * n);
+        cycles += MODEL_TILES(m, seq_len) * k - MODEL_TILES(m, n) * steps +
+                  3 * m * MODEL_LINES(seq_len * 4) + MODEL_TILES(m, n) * seq_len;
+    }
+    return cycles + *rd_lines + *wr_lines;
+}
+
+uint64_t gemm_model_job_cycles(gemm_device_model_t* model) {
+    uint64_t rd_lines, wr_lines;
+    return job_cost(model, &rd_lines, &wr_lines);
+}
+
+// Latency monitor: count transactions of one channel as axi_latency_monitor
+// bins them. Bin 0 holds latencies below 1 << shift, bin b the range
+// [2^(b-1), 2^b) << shift, and the last bin everything above
+static void lat_record(gemm_device_model_t* model, int channel, uint64_t count) {
+    uint32_t ctrl = REG(model, GEMM_LAT_CTRL_REG);
+    uint32_t latency = model->mem_latency[channel] & 0xFFFF;
+    if (!(ctrl & GEMM_LAT_CTRL_ENABLE) || latency == 0 || count == 0) {
+        return;
+    }
+
+    uint32_t scaled = latency >> ((ctrl >> GEMM_LAT_CTRL_SHIFT_POS) & 0xF);
+    int bin = 0;
+    while (bin < GEMM_MODEL_LAT_BINS - 1 && (scaled >> bin) != 0) {
+        bin++;
+    }
+    uint64_t sum = model->lat_hist[channel][bin] + count;
+    model->lat_hist[channel][bin] = sum > UINT32_MAX ? UINT32_MAX : (uint32_t)sum;
+    if (latency > model->lat_max[channel]) {
+        model->lat_max[channel] = latency;
+    }
+}
+
+// Register read
+uint32_t gemm_model_reg_read(gemm_device_model_t* model, uint32_t offset) {
+    if (offset / 4 >= GEMM_MODEL_NUM_REGS) {
+        return 0;
+    }
+
+    switch (offset) {
+        case OFFSET(GEMM_STATUS_REG):
+            return (model->busy ? GEMM_STATUS_BUSY : 0) |
+                   (model->done ? GEMM_STATUS_DONE : 0) |
+                   (model->error ? GEMM_STATUS_ERROR : 0) |
+                   (model->mmu_fault ? GEMM_STATUS_MMU_FAULT : 0) |
+                   (model->index_error ? GEMM_STATUS_INDEX_ERROR : 0) |
+                   (model->abft_error ? GEMM_STATUS_ABFT_ERROR : 0);
+        case OFFSET(GEMM_ERROR_CODE_REG):
+            return (model->mmu_fault ? GEMM_ERR_MMU_FAULT :
+                    model->index_error ? GEMM_ERR_INDEX :
+                    model->abft_error ? GEMM_ERR_ABFT : GEMM_ERR_NONE) |
+                   (model->abft_checked ? GEMM_ERR_ABFT_CHECKED : 0);
+        case OFFSET(GEMM_MMU_FAULT_ADDR_REG):
+            return model->mmu_fault_addr;
+        case OFFSET(GEMM_LAT_BIN_REG): {
+            uint32_t sel = REG(model, GEMM_LAT_SEL_REG);
+            return model->lat_hist[(sel & GEMM_LAT_SEL_WRITE) != 0][sel % GEMM_MODEL_LAT_BINS];
+        }
+        case OFFSET(GEMM_LAT_MAX_REG):
+            return model->lat_max[(REG(model, GEMM_LAT_SEL_REG) & GEMM_LAT_SEL_WRITE) != 0];
+        default:
+            return model->regs[offset / 4];
+    }
+}
+
+// Register write
+void gemm_model_reg_write(gemm_device_model_t* model, uint32_t offset, uint32_t value) {
+    if (offset / 4 >= GEMM_MODEL_NUM_REGS) {
+        return;
+    }
+
+    switch (offset) {
+        case OFFSET(GEMM_CTRL_REG):
+            model->regs[offset / 4] = value & ~(GEMM_CTRL_START | GEMM_CTRL_RESET);
+            if (value & GEMM_CTRL_RESET) {
+                model->busy = false;
+                model->done = false;
+                model->error = false;
+                model->index_error = false;
+                model->abft_checked = false;
+                model->abft_error = false;
+            }
+            if (value & GEMM_CTRL_START) {
+                // Jobs complete synchronously
+                model->done = false;
+                model->index_error = false;
+                model->abft_checked = false;
+                model->abft_error = false;
+                model->error = !run_gemm(model) || model->mmu_fault || model->index_error ||
+                               model->abft_error;
+                model->done = true;
+                model->jobs++;
+                uint64_t rd_lines, wr_lines;
+                model->last_job_cycles = job_cost(model, &rd_lines, &wr_lines);
+                model->cycles += model->last_job_cycles;
+                lat_record(model, GEMM_LAT_CHANNEL_READ, rd_lines);
+                lat_record(model, GEMM_LAT_CHANNEL_WRITE, wr_lines);
+            }
+            break;
+        case OFFSET(GEMM_STATUS_REG):
+        case OFFSET(GEMM_MMU_FAULT_ADDR_REG):
+        case OFFSET(GEMM_ERROR_CODE_REG):
+            break; // Read-only
+        case OFFSET(GEMM_LAT_CTRL_REG):
+            model->regs[offset / 4] = value & ~GEMM_LAT_CTRL_CLEAR;
+            if (value & GEMM_LAT_CTRL_CLEAR) {
+                memset(model->lat_hist, 0, sizeof(model->lat_hist));
+                memset(model->lat_max, 0, sizeof(model->lat_max));
+            }
+            break;
+        case OFFSET(GEMM_MMU_CTRL_REG):
+            model->regs[offset / 4] = value & GEMM_MMU_CTRL_ENABLE;
+            if (value & GEMM_MMU_CTRL_TLB_FLUSH) {
+                memset(model->tlb_valid, 0, sizeof(model->tlb_valid));
+            }
+            if (value & GEMM_MMU_CTRL_FAULT_CLR) {
+                model->mmu_fault = false;
+            }
+            break;
+        case OFFSET(GEMM_MMU_PTBR_REG):
+            model->regs[offset / 4] = value & ~0xFFFu;
+            break;
+        case OFFSET(GEMM_SOFTMAX_LUT_REG):
+            // Write-only table port
+            model->softmax_lut[value & 0xFF] = (value >> GEMM_SOFTMAX_LUT_VALUE_POS) & 0xFF;
+            break;
+        default:
+            model->regs[offset / 4] = value;
+            break;
+    }
+}
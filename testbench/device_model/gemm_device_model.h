@@ -0,0 +1,84 @@
+// GEMM Accelerator Device Model
+// Functional C model of the accelerator register file for host-side testing
+
+#ifndef GEMM_DEVICE_MODEL_H
+#define GEMM_DEVICE_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GEMM_MODEL_NUM_REGS     64      // 256-byte register window
+#define GEMM_MODEL_TLB_ENTRIES  8       // Matches dma_mmu TLB_ENTRIES
+#define GEMM_MODEL_LAT_BINS     16      // Matches axi_latency_monitor NUM_BINS
+
+// Physical memory hook for hosts whose memory is not one block (e.g. an
+// instruction set simulator's guest RAM); returns false on a bus error
+typedef bool (*gemm_model_mem_fn)(void* ctx, uint32_t phys, void* buf, uint32_t size, bool write);
+
+// Model state
+typedef struct {
+    // Modeled physical memory seen by the DMA
+    uint8_t*  mem;
+    uint32_t  mem_base;
+    uint32_t  mem_size;
+    gemm_model_mem_fn mem_fn;           // Used instead of mem when set
+    void*     mem_ctx;
+
+    // Register file (indexed by offset / 4)
+    uint32_t  regs[GEMM_MODEL_NUM_REGS];
+    bool      busy;
+    bool      done;
+    bool      error;
+    bool      index_error;
+    bool      abft_checked;
+    bool      abft_error;
+
+    // DMA address translation
+    bool      tlb_valid[GEMM_MODEL_TLB_ENTRIES];
+    uint32_t  tlb_vpn[GEMM_MODEL_TLB_ENTRIES];
+    uint32_t  tlb_pte[GEMM_MODEL_TLB_ENTRIES];
+    uint32_t  tlb_next;
+    bool      mmu_fault;
+    uint32_t  mmu_fault_addr;
+
+    // Fused attention exponent table (softmax_unit LUT)
+    uint8_t   softmax_lut[256];
+
+    // AXI latency monitor. Each job is one read per line loaded and one
+    // write per C line stored, taking mem_latency[channel] cycles each
+    // (0 = no latency modeled, nothing is recorded)
+    uint32_t  mem_latency[2];
+    uint32_t  lat_hist[2][GEMM_MODEL_LAT_BINS];
+    uint32_t  lat_max[2];
+
+    // Fault injection: XORed into the first C element of the next job
+    uint32_t  c_fault_xor;
+
+    // Statistics
+    uint64_t  tlb_hits;
+    uint64_t  tlb_misses;
+    uint64_t  jobs;
+    uint64_t  last_job_cycles;          // Cycle model estimate of the last job
+    uint64_t  cycles;                   // Sum over all jobs
+} gemm_device_model_t;
+
+// Model setup
+void gemm_model_init(gemm_device_model_t* model, uint8_t* mem,
+                     uint32_t mem_base, uint32_t mem_size);
+gemm_device_model_t* gemm_model_default(void);
+gemm_device_model_t* gemm_model_instance(uint8_t instance);
+
+// Register access (offsets relative to GEMM_ACCEL_BASE_ADDR)
+uint32_t gemm_model_reg_read(gemm_device_model_t* model, uint32_t offset);
+void gemm_model_reg_write(gemm_device_model_t* model, uint32_t offset, uint32_t value);
+
+// Host pointer for a modeled physical address (NULL if out of range)
+void* gemm_model_phys_ptr(gemm_device_model_t* model, uint32_t phys, uint32_t size);
+
+// Route DMA accesses through a memory hook instead of a host block
+void gemm_model_set_mem_fn(gemm_device_model_t* model, gemm_model_mem_fn fn, void* ctx);
+
+// Cycle model: estimated duration of the configured job
+uint64_t gemm_model_job_cycles(gemm_device_model_t* model);
+
+#endif // GEMM_DEVICE_MODEL_H
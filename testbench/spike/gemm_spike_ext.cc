@@ -0,0 +1,173 @@
+// GEMM Accelerator Spike Extension
+// Runs RISC-V firmware images against the C device model under the Spike ISS
+//
+// Two parts, both loaded from libgemm_spike.so with --extlib:
+//   - The gemm_accel instruction extension decodes the custom-0 matmul
+//     instruction of riscv_interface (opcode 0001011, funct3 000, funct7 0).
+//     As in the RTL, rs1/rs2 are ignored: the instruction starts the job
+//     already programmed into instance 0 and returns MATRIX_C_ADDR in rd.
+//   - The gemm_accel MMIO device maps the register windows of up to
+//     GEMM_ACCEL_MAX_INSTANCES accelerators from its base address and
+//     forwards 32-bit accesses to the device model.
+//
+//   spike --extlib=libgemm_spike.so --extension=gemm_accel
+//         --device=gemm_accel,0x40000000[,timing] fw.elf
+//
+// The model DMA reads and writes guest memory through the hart's MMU, so
+// accelerator addresses are physical while the hart runs untranslated
+// (M-mode or satp bare). Jobs complete at the start write. With the
+// "timing" argument STATUS reports BUSY until minstret has advanced by the
+// cycle model estimate of the job, so polling loops in the firmware spin
+// for a realistic time at one instruction per accelerator cycle.
+//
+// Written against the Spike extension API of riscv-isa-sim 1.1.1
+// (get_instructions(const processor_t&), reset(processor_t&)). It is not
+// part of the default targets: build it with make spike_ext SPIKE_DIR=<install>.
+
+#include <riscv/extension.h>
+#include <riscv/mmio_plugin.h>
+#include <riscv/mmu.h>
+#include <riscv/processor.h>
+#include <riscv/trap.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "gemm_device_model.h"
+#include "gemm_accel_driver.h"
+}
+
+#define MATCH_MATMUL  0x0000000B
+#define MASK_MATMUL   0xFE00707F
+#define REG_OFFSET(reg) ((reg) - GEMM_ACCEL_BASE_ADDR)
+
+// Hart whose memory the model DMA uses, captured at reset
+static processor_t* gemm_hart = nullptr;
+
+// minstret value at which each instance's current job finishes (timing mode)
+static reg_t job_end[GEMM_ACCEL_MAX_INSTANCES];
+
+static reg_t hart_instret() {
+    return gemm_hart->get_state()->minstret->read();
+}
+
+static bool hart_mem(void* ctx, uint32_t phys, void* buf, uint32_t size, bool write) {
+    (void)ctx;
+    if (gemm_hart == nullptr) {
+        return false;
+    }
+    uint8_t* bytes = static_cast<uint8_t*>(buf);
+    try {
+        for (uint32_t i = 0; i < size; i++) {
+            if (write) {
+                gemm_hart->get_mmu()->store<uint8_t>(phys + i, bytes[i]);
+            } else {
+                bytes[i] = gemm_hart->get_mmu()->load<uint8_t>(phys + i);
+            }
+        }
+    } catch (trap_t&) {
+        return false; // Bus error
+    }
+    return true;
+}
+
+static void start_job(uint8_t instance) {
+    gemm_device_model_t* model = gemm_model_instance(instance);
+    uint32_t ctrl = gemm_model_reg_read(model, REG_OFFSET(GEMM_CTRL_REG));
+    gemm_model_reg_write(model, REG_OFFSET(GEMM_CTRL_REG), ctrl | GEMM_CTRL_START);
+    job_end[instance] = (gemm_hart ? hart_instret() : 0) + model->last_job_cycles;
+}
+
+// MMIO device
+
+class gemm_accel_device_t {
+public:
+    explicit gemm_accel_device_t(const std::string& args) : timing_(args == "timing") {
+        for (uint8_t i = 0; i < GEMM_ACCEL_MAX_INSTANCES; i++) {
+            gemm_model_init(gemm_model_instance(i), nullptr, 0, 0);
+            gemm_model_set_mem_fn(gemm_model_instance(i), hart_mem, nullptr);
+        }
+    }
+
+    bool load(reg_t addr, size_t len, uint8_t* bytes) {
+        uint8_t instance;
+        uint32_t offset;
+        if (!decode(addr, len, &instance, &offset)) {
+            return false;
+        }
+        uint32_t value = gemm_model_reg_read(gemm_model_instance(instance), offset);
+        if (timing_ && offset == REG_OFFSET(GEMM_STATUS_REG) && gemm_hart &&
+            hart_instret() < job_end[instance]) {
+            value = (value & ~GEMM_STATUS_DONE) | GEMM_STATUS_BUSY;
+        }
+        memcpy(bytes, &value, sizeof(value));
+        return true;
+    }
+
+    bool store(reg_t addr, size_t len, const uint8_t* bytes) {
+        uint8_t instance;
+        uint32_t offset;
+        if (!decode(addr, len, &instance, &offset)) {
+            return false;
+        }
+        uint32_t value;
+        memcpy(&value, bytes, sizeof(value));
+        if (offset == REG_OFFSET(GEMM_CTRL_REG) && (value & GEMM_CTRL_START)) {
+            gemm_model_reg_write(gemm_model_instance(instance), offset, value & ~GEMM_CTRL_START);
+            start_job(instance);
+        } else {
+            gemm_model_reg_write(gemm_model_instance(instance), offset, value);
+        }
+        return true;
+    }
+
+private:
+    // Aligned 32-bit accesses inside one instance window
+    static bool decode(reg_t addr, size_t len, uint8_t* instance, uint32_t* offset) {
+        if (len != 4 || (addr & 3) != 0 ||
+            addr >= (reg_t)GEMM_ACCEL_MAX_INSTANCES * GEMM_ACCEL_INSTANCE_STRIDE) {
+            return false;
+        }
+        *instance = addr / GEMM_ACCEL_INSTANCE_STRIDE;
+        *offset = addr % GEMM_ACCEL_INSTANCE_STRIDE;
+        return true;
+    }
+
+    bool timing_;
+};
+
+static mmio_plugin_registration_t<gemm_accel_device_t> gemm_accel_mmio("gemm_accel");
+
+// matmul instruction
+
+static reg_t exec_matmul(processor_t* p, insn_t insn, reg_t pc) {
+    start_job(0);
+    if (insn.rd() != 0) {
+        uint32_t c_addr = gemm_model_reg_read(gemm_model_instance(0), REG_OFFSET(GEMM_MATRIX_C_ADDR_REG));
+        p->get_state()->XPR.write(insn.rd(), c_addr);
+    }
+    return pc + 4;
+}
+
+class gemm_accel_extension_t : public extension_t {
+public:
+    const char* name() const override { return "gemm_accel"; }
+
+    std::vector<insn_desc_t> get_instructions(const processor_t&) override {
+        return {{MATCH_MATMUL, MASK_MATMUL,
+                 exec_matmul, exec_matmul, exec_matmul, exec_matmul,
+                 exec_matmul, exec_matmul, exec_matmul, exec_matmul}};
+    }
+
+    std::vector<disasm_insn_t*> get_disasms(const processor_t*) override {
+        return {};
+    }
+
+    void reset(processor_t& proc) override {
+        gemm_hart = &proc;
+    }
+};
+
+REGISTER_EXTENSION(gemm_accel, []() { return new gemm_accel_extension_t; })
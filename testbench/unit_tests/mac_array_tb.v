@@ -19,6 +19,8 @@ module mac_array_tb;
     reg enable;
     reg data_type;
     reg clear_acc;
+    reg [MAC_WIDTH-1:0] row_mask;
+    reg [MAC_WIDTH-1:0] col_mask;
     
     // Data inputs
     reg [MAC_WIDTH*DATA_WIDTH-1:0] matrix_a_row;
@@ -29,6 +31,17 @@ module mac_array_tb;
     wire valid_out;
     wire [2:0] pipeline_stage;
     
+    // Bit-serial weights
+    reg bit_serial;
+    reg [3:0] weight_bits;
+    reg [2:0] weight_plane;
+    reg [MAC_WIDTH*8*DATA_WIDTH-1:0] a_groups;
+    
+    // Binary/ternary mode
+    reg [1:0] bnn_mode;
+    reg [6:0] bnn_count;
+    reg [MAC_WIDTH*8*DATA_WIDTH-1:0] b_groups;
+    
     // Test vectors
     reg [DATA_WIDTH-1:0] test_matrix_a [0:MAC_WIDTH-1];
     reg [DATA_WIDTH-1:0] test_matrix_b [0:MAC_WIDTH-1];
@@ -46,8 +59,17 @@ module mac_array_tb;
         .enable(enable),
         .data_type(data_type),
         .clear_acc(clear_acc),
+        .row_mask(row_mask),
+        .col_mask(col_mask),
         .matrix_a_row(matrix_a_row),
         .matrix_b_col(matrix_b_col),
+        .bit_serial(bit_serial),
+        .weight_bits(weight_bits),
+        .weight_plane(weight_plane),
+        .a_groups(a_groups),
+        .bnn_mode(bnn_mode),
+        .bnn_count(bnn_count),
+        .b_groups(b_groups),
         .accumulators(accumulators),
         .valid_out(valid_out),
         .pipeline_stage(pipeline_stage)
@@ -68,8 +90,17 @@ module mac_array_tb;
         enable = 0;
         data_type = 0; // int8
         clear_acc = 0;
+        row_mask = {MAC_WIDTH{1'b1}};
+        col_mask = {MAC_WIDTH{1'b1}};
         matrix_a_row = 0;
         matrix_b_col = 0;
+        bit_serial = 0;
+        weight_bits = 0;
+        weight_plane = 0;
+        a_groups = 0;
+        bnn_mode = 0;
+        bnn_count = 0;
+        b_groups = 0;
         
         // Reset
         #20 rst_n = 1;
@@ -95,6 +126,22 @@ module mac_array_tb;
         $display("Test 5: Saturation test");
         test_saturation();
         
+        // Test 6: Bit-serial 3-bit weights
+        $display("Test 6: Bit-serial weights");
+        test_bit_serial();
+        
+        // Test 7: XNOR-popcount binary and ternary
+        $display("Test 7: Binary and ternary modes");
+        test_bnn();
+        
+        // Test 8: Masked lanes on an edge tile
+        $display("Test 8: Edge tile lane masks");
+        test_lane_masks();
+        
+        // Test 9: Back-to-back accumulation
+        $display("Test 9: Back-to-back accumulation");
+        test_back_to_back();
+        
         $display("All tests completed");
         $finish;
     end
@@ -319,5 +366,197 @@ module mac_array_tb;
             #20;
         end
     endtask
+    
+    // Test 6: One k-group of 3-bit weights in three cycles
+    task test_bit_serial;
+        integer i, j, k, errors;
+        reg signed [3:0] w [0:7][0:MAC_WIDTH-1];
+        reg signed [31:0] expected;
+        begin
+            errors = 0;
+            data_type = 0;
+            for (i = 0; i < MAC_WIDTH; i++) begin
+                for (k = 0; k < 8; k++) begin
+                    a_groups[(i*8+k)*DATA_WIDTH +: DATA_WIDTH] = (i + 1) * (k - 3);
+                end
+            end
+            for (k = 0; k < 8; k++) begin
+                for (j = 0; j < MAC_WIDTH; j++) begin
+                    w[k][j] = ((k + j) % 8) - 4; // -4..3
+                end
+            end
+            
+            clear_acc = 1;
+            #10 clear_acc = 0;
+            bit_serial = 1;
+            weight_bits = 3;
+            enable = 1;
+            for (int p = 0; p < 3; p++) begin
+                weight_plane = p;
+                for (j = 0; j < MAC_WIDTH; j++) begin
+                    for (k = 0; k < 8; k++) begin
+                        matrix_b_col[j*DATA_WIDTH + k] = w[k][j][p];
+                    end
+                end
+                #10;
+            end
+            enable = 0;
+            bit_serial = 0;
+            #((PIPELINE_DEPTH+2)*10);
+            
+            for (i = 0; i < MAC_WIDTH; i++) begin
+                for (j = 0; j < MAC_WIDTH; j++) begin
+                    expected = 0;
+                    for (k = 0; k < 8; k++) begin
+                        expected = expected + (i + 1) * (k - 3) * w[k][j];
+                    end
+                    if ($signed(accumulators[(i*MAC_WIDTH+j)*ACC_WIDTH +: ACC_WIDTH]) != expected) begin
+                        $display("ERROR: MAC[%0d][%0d] = %0d, expected %0d", i, j,
+                                 $signed(accumulators[(i*MAC_WIDTH+j)*ACC_WIDTH +: ACC_WIDTH]), expected);
+                        errors = errors + 1;
+                    end
+                end
+            end
+            if (errors == 0) begin
+                $display("PASS: Bit-serial 3-bit weights");
+            end
+        end
+    endtask
+    
+    // Reference dot product of one packed binary/ternary lane pair
+    function integer bnn_ref;
+        input [1:0] mode;
+        input [63:0] a, b;
+        input integer count;
+        integer k;
+        begin
+            bnn_ref = 0;
+            for (k = 0; k < count; k++) begin
+                if (mode == 1) begin
+                    bnn_ref = bnn_ref + ((a[k] == b[k]) ? 1 : -1);
+                end else if (a[32+k] && b[32+k]) begin
+                    bnn_ref = bnn_ref + ((a[k] == b[k]) ? 1 : -1);
+                end
+            end
+        end
+    endfunction
+    
+    // Test 7: One step of 40 binary products, then 32 ternary products
+    task test_bnn;
+        integer i, j, errors, expected [0:MAC_WIDTH-1][0:MAC_WIDTH-1];
+        begin
+            errors = 0;
+            for (i = 0; i < MAC_WIDTH; i++) begin
+                a_groups[i*64 +: 64] = {$random, $random};
+                b_groups[i*64 +: 64] = {$random, $random};
+            end
+            for (i = 0; i < MAC_WIDTH; i++) begin
+                for (j = 0; j < MAC_WIDTH; j++) begin
+                    expected[i][j] = bnn_ref(1, a_groups[i*64 +: 64], b_groups[j*64 +: 64], 40) +
+                                     bnn_ref(2, a_groups[i*64 +: 64], b_groups[j*64 +: 64], 32);
+                end
+            end
+            
+            clear_acc = 1;
+            #10 clear_acc = 0;
+            enable = 1;
+            bnn_mode = 1;
+            bnn_count = 40;
+            #10;
+            bnn_mode = 2;
+            bnn_count = 32;
+            #10;
+            enable = 0;
+            bnn_mode = 0;
+            #((PIPELINE_DEPTH+2)*10);
+            
+            for (i = 0; i < MAC_WIDTH; i++) begin
+                for (j = 0; j < MAC_WIDTH; j++) begin
+                    if ($signed(accumulators[(i*MAC_WIDTH+j)*ACC_WIDTH +: ACC_WIDTH]) != expected[i][j]) begin
+                        $display("ERROR: MAC[%0d][%0d] = %0d, expected %0d", i, j,
+                                 $signed(accumulators[(i*MAC_WIDTH+j)*ACC_WIDTH +: ACC_WIDTH]), expected[i][j]);
+                        errors = errors + 1;
+                    end
+                end
+            end
+            if (errors == 0) begin
+                $display("PASS: XNOR-popcount binary and ternary");
+            end
+        end
+    endtask
+    
+    // Test 8: A 5x3 edge tile only updates its own cells
+    task test_lane_masks;
+        integer i, j, errors, expected;
+        begin
+            errors = 0;
+            data_type = 0;
+            clear_acc = 1;
+            #10 clear_acc = 0;
+            row_mask = 8'h1F;
+            col_mask = 8'h07;
+            for (i = 0; i < MAC_WIDTH; i++) begin
+                matrix_a_row[i*DATA_WIDTH +: DATA_WIDTH] = 8'd2;
+                matrix_b_col[i*DATA_WIDTH +: DATA_WIDTH] = 8'd3;
+            end
+            enable = 1;
+            #10;
+            enable = 0;
+            #((PIPELINE_DEPTH+2)*10);
+            
+            for (i = 0; i < MAC_WIDTH; i++) begin
+                for (j = 0; j < MAC_WIDTH; j++) begin
+                    expected = (row_mask[i] && col_mask[j]) ? 6 : 0;
+                    if ($signed(accumulators[(i*MAC_WIDTH+j)*ACC_WIDTH +: ACC_WIDTH]) != expected) begin
+                        $display("ERROR: MAC[%0d][%0d] = %0d, expected %0d", i, j,
+                                 $signed(accumulators[(i*MAC_WIDTH+j)*ACC_WIDTH +: ACC_WIDTH]), expected);
+                        errors = errors + 1;
+                    end
+                end
+            end
+            if (errors == 0) begin
+                $display("PASS: Masked lanes hold their accumulators");
+            end
+            row_mask = {MAC_WIDTH{1'b1}};
+            col_mask = {MAC_WIDTH{1'b1}};
+        end
+    endtask
+    
+    // Test 9: Four enabled cycles in a row add four products. MAC units
+    // feed back their own output; the former accum_regs copy lagged a cycle,
+    // so back-to-back steps lost every other partial sum
+    task test_back_to_back;
+        integer i, j, k, errors, expected;
+        begin
+            errors = 0;
+            data_type = 0;
+            clear_acc = 1;
+            #10 clear_acc = 0;
+            enable = 1;
+            for (k = 1; k <= 4; k++) begin
+                for (i = 0; i < MAC_WIDTH; i++) begin
+                    matrix_a_row[i*DATA_WIDTH +: DATA_WIDTH] = k;
+                    matrix_b_col[i*DATA_WIDTH +: DATA_WIDTH] = k + i;
+                end
+                #10;
+            end
+            enable = 0;
+            #((PIPELINE_DEPTH+2)*10);
+            
+            for (i = 0; i < MAC_WIDTH; i++) begin
+                for (j = 0; j < MAC_WIDTH; j++) begin
+                    expected = 30 + 10 * j; // sum of k * (k + j), k = 1..4
+                    if ($signed(accumulators[(i*MAC_WIDTH+j)*ACC_WIDTH +: ACC_WIDTH]) != expected) begin
+                        $display("ERROR: MAC[%0d][%0d] = %0d, expected %0d", i, j,
+                                 $signed(accumulators[(i*MAC_WIDTH+j)*ACC_WIDTH +: ACC_WIDTH]), expected);
+                        errors = errors + 1;
+                    end
+                end
+            end
+            if (errors == 0) begin
+                $display("PASS: Back-to-back steps accumulate every product");
+            end
+        end
+    endtask
 
 endmodule